@@ -2,14 +2,98 @@ import httpx
 from mcp.server.fastmcp import FastMCP
 import dotenv
 import os
+import collections
+import itertools
+import json
+import threading
+from concurrent.futures import Future
+from urllib.parse import urlparse
 
 dotenv.load_dotenv()
 
 PORT = int(os.getenv("PORT", "9000"))
 BASE_URL = os.getenv("UE5_REST_API_URL", "http://localhost:8080")
+WS_URL = os.getenv("UE5_WS_URL", "")
 
 mcp = FastMCP("UE5BlueprintMCP", port=PORT)
 
+
+class WebSocketResponse:
+    def __init__(self, message: dict):
+        self.status_code = message.get("code", 0)
+        body = message.get("body")
+        self.text = body if isinstance(body, str) else json.dumps(body)
+
+
+class WebSocketClient:
+    """Sends API calls over the editor's persistent WebSocket channel instead of one HTTP request each.
+
+    Exposes the same get/post calls as httpx.Client. Change events pushed by the editor are kept
+    in a bounded queue and drained by the get_events tool.
+    """
+
+    def __init__(self, url: str, max_events: int = 1000):
+        from websockets.sync.client import connect
+
+        self._socket = connect(url, max_size=None)
+        self._ids = itertools.count()
+        self._pending: dict[str, Future] = {}
+        self._lock = threading.Lock()
+        self._closed: Exception | None = None
+        self.events = collections.deque(maxlen=max_events)
+        threading.Thread(target=self._read, daemon=True).start()
+
+    def _read(self):
+        error: Exception = ConnectionError("WebSocket connection to the editor closed")
+        try:
+            for frame in self._socket:
+                message = json.loads(frame)
+                if message.get("type") == "event":
+                    self.events.append(message)
+                    continue
+                with self._lock:
+                    future = self._pending.pop(message.get("id", ""), None)
+                if future:
+                    future.set_result(WebSocketResponse(message))
+        except Exception as read_error:
+            error = read_error
+        finally:
+            # A clean close ends the loop without raising, the waiting calls must fail either way
+            with self._lock:
+                self._closed = error
+                pending, self._pending = self._pending, {}
+            for future in pending.values():
+                future.set_exception(error)
+
+    def _call(self, method: str, url: str, query=None, body=None, timeout: float = 300.0):
+        request_id = f"py-{next(self._ids)}"
+        future = Future()
+        with self._lock:
+            if self._closed:
+                raise self._closed
+            self._pending[request_id] = future
+        message = {"id": request_id, "route": urlparse(url).path, "method": method}
+        if query:
+            message["query"] = {key: str(value) for key, value in query.items()}
+        if body is not None:
+            message["body"] = body
+        self._socket.send(json.dumps(message))
+        return future.result(timeout=timeout)
+
+    def get(self, url: str, params=None):
+        return self._call("GET", url, query=params)
+
+    def post(self, url: str, json=None, params=None):
+        return self._call("POST", url, query=params, body=json)
+
+
+# Shared connection to the editor. Over HTTP, large graph and property dumps are compressed by the
+# editor when they are above UE5_MCP.CompressionThreshold, httpx decodes them transparently
+if WS_URL:
+    client = WebSocketClient(WS_URL)
+else:
+    client = httpx.Client(headers={"Accept-Encoding": "gzip, deflate"})
+
 # System instruction for all tools
 common_instruction = """
 Valid Unreal Engine class name should be:
@@ -43,7 +127,7 @@ def create_blueprint(parent_class: str, bp_path: str) -> str:
     """
     url = f"{BASE_URL}/create_bp"
     body = {"ParentClass": parent_class, "BpPath": bp_path}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -59,38 +143,45 @@ def create_function(bp_path: str, function_name: str, input_signature: str, outp
     url = f"{BASE_URL}/create_function"
     body = {"BpPath": bp_path, "FunctionName": function_name, "FunctionInputSignature": input_signature,
             "FunctionOutputSignature": output_signature}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
 @mcp.tool()
-def edit_function(bp_path: str, function_name: str, input_signature: str, output_signature: str) -> str:
+def edit_function(bp_path: str, function_name: str, input_signature: str, output_signature: str,
+                  update_call_sites: bool = False) -> str:
     """Edit an existing function in the Blueprint.
-    Caution: Changing function signatures not change existing function calls or references, may break the Blueprint.
+    Caution: Without update_call_sites, changing function signatures not change existing function calls or references,
+    may break the Blueprint.
 
     bp_path: Must be a valid Blueprint path
     function_name: Must be a valid existing function name
     input_signature: Must be a valid new input signature string
     output_signature: Must be a valid new output signature string
+    update_call_sites: Also rebuild every call of the function in this and dependent Blueprints, keeping the links
+        that still fit. Returns a report of the changed nodes and the links that were broken.
     """
     url = f"{BASE_URL}/edit_function"
     body = {"BpPath": bp_path, "FunctionName": function_name, "FunctionInputSignature": input_signature,
-            "FunctionOutputSignature": output_signature}
-    response = httpx.post(url, json=body)
+            "FunctionOutputSignature": output_signature, "bUpdateCallSites": update_call_sites}
+    response = client.post(url, json=body)
     return response.text
 
 
 @mcp.tool()
-def delete_function(bp_path: str, function_name: str) -> str:
+def delete_function(bp_path: str, function_name: str, update_call_sites: bool = False) -> str:
     """Delete a function from the Blueprint.
-    Caution: Deleting a function not remove existing function calls or references, may break the Blueprint.
+    Caution: Without update_call_sites, deleting a function not remove existing function calls or references,
+    may break the Blueprint.
 
     bp_path: Must be a valid Blueprint path
     function_name: Must be a valid existing function name.
+    update_call_sites: Also remove every call of the function in this and dependent Blueprints.
+        Returns a report of the removed nodes.
     """
     url = f"{BASE_URL}/delete_function"
-    body = {"BpPath": bp_path, "FunctionName": function_name}
-    response = httpx.post(url, json=body)
+    body = {"BpPath": bp_path, "FunctionName": function_name, "bUpdateCallSites": update_call_sites}
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -107,7 +198,7 @@ def add_function_call_to_graph(bp_path: str, graph_name: str, function_name: str
     body = {"BpPath": bp_path, "GraphName": graph_name, "FunctionName": function_name}
     if class_to_call:
         body["ClassToCall"] = class_to_call
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -129,7 +220,7 @@ def add_event_to_graph(bp_path: str, graph_name: str, event_name: str, is_custom
     body = {"BpPath": bp_path, "GraphName": graph_name, "EventName": event_name, "bIsCustomEvent": is_custom}
     if is_custom and event_signature:
         body["EventSignature"] = event_signature
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -144,7 +235,7 @@ def add_variable_to_graph(bp_path: str, graph_name: str, var_name: str, is_sette
     """
     url = f"{BASE_URL}/add_variable_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "VarName": var_name, "bIsSetter": is_setter}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -156,7 +247,7 @@ def get_blueprint_variables(bp_path: str) -> str:
     """
     url = f"{BASE_URL}/get_blueprint_variables"
     params = {"bp_path": bp_path}
-    response = httpx.get(url, params=params)
+    response = client.get(url, params=params)
     return response.text
 
 
@@ -168,7 +259,7 @@ def get_blueprint_functions(bp_path: str) -> str:
     """
     url = f"{BASE_URL}/get_blueprint_functions"
     params = {"bp_path": bp_path}
-    response = httpx.get(url, params=params)
+    response = client.get(url, params=params)
     return response.text
 
 
@@ -181,7 +272,141 @@ def get_graph(bp_path: str, graph_name: str) -> str:
     """
     url = f"{BASE_URL}/get_graph"
     params = {"bp_path": bp_path, "graph_name": graph_name}
-    response = httpx.get(url, params=params)
+    response = client.get(url, params=params)
+    return response.text
+
+
+@mcp.tool()
+def query_graph(bp_path: str, graph_name: str, query: str = "Filter", node_id: str = "", event_name: str = "",
+                pin_name: str = "", max_depth: int = 0, node_type: str = "", member_name: str = "",
+                pin_type: str = "") -> str:
+    """Get only the nodes of a graph that answer a question, in the get_graph format, instead of the whole graph.
+    Use it for "what runs after this event?" (ExecForward), "what can run before this node?" (ExecBackward),
+    "where does this pin's value come from?" (DataUpstream) or "what reads this value?" (DataDownstream).
+
+    bp_path: Must be a valid Blueprint path
+    graph_name: Event, function or macro graph name (e.g., 'EventGraph').
+    query: ExecForward, ExecBackward, DataUpstream, DataDownstream, or Filter to search every node of the graph.
+    node_id: Start node id, required by every query but Filter unless event_name is set.
+    event_name: Start from this event or custom event node instead (e.g., 'ReceiveBeginPlay').
+    pin_name: Only follow this pin of the start node.
+    max_depth: Links to follow from the start node, 0 for no limit.
+    node_type: Only return nodes of this class (e.g., 'CallFunction', 'DynamicCast').
+    member_name: Only return nodes calling this function, or using this event or variable.
+    pin_type: Only return nodes with a pin whose type contains this text (e.g., 'exec', 'real', 'Actor').
+    """
+    url = f"{BASE_URL}/query_graph"
+    body = {"BpPath": bp_path, "GraphName": graph_name, "Query": query, "NodeId": node_id, "EventName": event_name,
+            "PinName": pin_name, "MaxDepth": max_depth, "NodeType": node_type, "MemberName": member_name,
+            "PinType": pin_type}
+    response = client.post(url, json=body)
+    return response.text
+
+
+@mcp.tool()
+def get_blueprint_snapshot(bp_path: str, fields: str = "") -> str:
+    """Get variables, functions, components (with their non-default properties) and every graph of the Blueprint in one call.
+
+    Prefer this over separate get_blueprint_variables, get_blueprint_functions, get_components_of_bp and get_graph calls.
+    bp_path: Must be a valid Blueprint path
+    fields: Optional comma separated subset of 'variables,functions,components,graphs', empty for all.
+    """
+    url = f"{BASE_URL}/get_blueprint_snapshot"
+    params = {"bp_path": bp_path}
+    if fields:
+        params["fields"] = fields
+    response = client.get(url, params=params)
+    return response.text
+
+
+@mcp.tool()
+def list_blueprints(path_prefix: str = "", parent_class: str = "", interfaces: list[str] = None,
+                    tags: dict[str, str] = None, sort_by: str = "Name", descending: bool = False,
+                    offset: int = 0, limit: int = 100) -> str:
+    """List Blueprints from the asset registry without loading them. Use it to find Blueprint paths.
+    Returns the total match count and one page of Blueprints with their parent classes.
+
+    path_prefix: Content folder searched recursively (e.g., '/Game/Enemies'), empty for all.
+    parent_class: Only Blueprints deriving from this class at any depth, native (e.g., 'Actor') or a Blueprint path.
+    interfaces: Only Blueprints that implement all these interfaces themselves.
+    tags: Asset registry tag values that must match (e.g., {"BlueprintType": "BPTYPE_Normal"}).
+    sort_by: 'Name', 'Path' or 'ParentClass'.
+    descending: Sort in descending order.
+    offset: Index of the first Blueprint of the page.
+    limit: Page size, 0 for all.
+    """
+    url = f"{BASE_URL}/list_blueprints"
+    body = {"PathPrefix": path_prefix, "ParentClass": parent_class, "Interfaces": interfaces or [],
+            "Tags": tags or {}, "SortBy": sort_by, "bDescending": descending, "Offset": offset, "Limit": limit}
+    response = client.post(url, json=body)
+    return response.text
+
+
+@mcp.tool()
+def search_usages(name: str, kind: str = "", path_prefix: str = "", limit: int = 200) -> str:
+    """Find every node across the project's Blueprints that calls a function, reads or writes a variable,
+    is an event, or is of a node class, without loading the Blueprints. Results come from a background index,
+    Complete is false while it is still being built.
+
+    name: Function, variable, event or node class name (e.g., 'PrintString', 'Health', 'DynamicCast').
+    kind: 'Function', 'Variable', 'Event' or 'Node', empty for all.
+    path_prefix: Only Blueprints under this content folder (e.g., '/Game/Enemies').
+    limit: Maximum number of usages returned, 0 for all.
+    """
+    url = f"{BASE_URL}/search_usages"
+    params = {"name": name, "limit": limit}
+    if kind:
+        params["kind"] = kind
+    if path_prefix:
+        params["path_prefix"] = path_prefix
+    response = client.get(url, params=params)
+    return response.text
+
+
+@mcp.tool()
+def analyze_impact(bp_path: str, member_name: str, member_kind: str = "Function") -> str:
+    """Find the nodes in any Blueprint that use a function or variable of this Blueprint, before changing it.
+    Call it before edit_function, delete_function, rename_variable_in_bp or delete_variable_from_bp,
+    then fix the returned nodes. Only Blueprints referencing this one are loaded.
+
+    bp_path: Must be a valid Blueprint path.
+    member_name: Function or variable name declared in the Blueprint.
+    member_kind: 'Function' or 'Variable'.
+    """
+    url = f"{BASE_URL}/analyze_impact"
+    body = {"BpPath": bp_path, "MemberName": member_name, "MemberKind": member_kind}
+    response = client.post(url, json=body)
+    return response.text
+
+
+@mcp.tool()
+def lint(bp_path: str = "", path_prefix: str = "", rules: list[str] = None) -> str:
+    """Find likely bugs and slow patterns in a Blueprint or every Blueprint under a folder, without changing them.
+    Rules: UnconnectedExec (nodes nothing executes, events that run nothing), UnusedVariable, UnusedFunction,
+    ImpureCallInLoop (expensive calls on every loop iteration), CastAlwaysFails (cast between unrelated classes),
+    HeavyTick (expensive calls every frame) and OrphanedPin. Unused members may still be used by other Blueprints.
+
+    bp_path: Blueprint path, may be empty when path_prefix is set.
+    path_prefix: Content folder to lint recursively (e.g., '/Game/Enemies').
+    rules: Rule names to run, all rules when empty.
+    """
+    url = f"{BASE_URL}/lint"
+    body = {"BpPath": bp_path, "PathPrefix": path_prefix, "Rules": rules or []}
+    response = client.post(url, json=body)
+    return response.text
+
+
+@mcp.tool()
+def prefetch(paths: list[str]) -> str:
+    """Start loading Blueprints or assets in the background so later calls on them don't wait for the load.
+    Call it early with every path you expect to touch, call it again with the same paths to check readiness.
+    Returns the status of each path: Loaded, Loading, Failed or Missing.
+
+    paths: List of Blueprint or asset paths (e.g., '/Game/Test/MyBlueprint').
+    """
+    url = f"{BASE_URL}/prefetch"
+    body = {"Paths": paths}
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -193,7 +418,25 @@ def compile_blueprint(bp_path: str) -> str:
     """
     url = f"{BASE_URL}/compile_blueprint"
     params = {"bp_path": bp_path}
-    response = httpx.post(url, params=params)
+    response = client.post(url, params=params)
+    return response.text
+
+
+@mcp.tool()
+def compile_blueprints(bp_paths: list[str] = None, path_prefix: str = "", skip_garbage_collection: bool = False,
+                       skip_save: bool = False) -> str:
+    """Compile several Blueprints in one dependency-ordered pass, faster than compiling them one by one.
+    Returns the status of every Blueprint, its errors and warnings with node ids, and the time spent.
+
+    bp_paths: List of valid Blueprint paths.
+    path_prefix: Also compile every Blueprint under this content folder (e.g., '/Game/Enemies').
+    skip_garbage_collection: Don't collect garbage after the compile.
+    skip_save: Don't save the Blueprints even when the editor saves on compile.
+    """
+    url = f"{BASE_URL}/compile_blueprints"
+    body = {"BpPaths": bp_paths or [], "PathPrefix": path_prefix,
+            "bSkipGarbageCollection": skip_garbage_collection, "bSkipSave": skip_save}
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -201,7 +444,53 @@ def compile_blueprint(bp_path: str) -> str:
 def get_supported_nodes() -> str:
     """Get the list of supported nodes for the Blueprint system."""
     url = f"{BASE_URL}/get_supported_nodes"
-    response = httpx.get(url)
+    response = client.get(url)
+    return response.text
+
+
+@mcp.tool()
+def describe_node(node_type: str, class_name: str = "", member_name: str = "", type_name: str = "") -> str:
+    """Get the pins (name, type and direction, default value) a node would have, without adding it to a graph.
+    Use it to learn the pin names for connect_pins and set_pin_default_value before adding the node.
+
+    node_type: Node class from get_supported_nodes, the K2Node_ prefix may be left out (e.g., 'CallFunction').
+    class_name: For CallFunction and Event, the class declaring the function or event (e.g., 'KismetSystemLibrary').
+    member_name: For CallFunction and Event, the function or event name (e.g., 'PrintString').
+    type_name: For BreakStruct and MakeStruct the struct, for DynamicCast and ClassDynamicCast the class,
+        for CastByteToEnum the enum.
+    """
+    url = f"{BASE_URL}/describe_node"
+    params = {"node_type": node_type}
+    if class_name:
+        params["class"] = class_name
+    if member_name:
+        params["member"] = member_name
+    if type_name:
+        params["type"] = type_name
+    response = client.get(url, params=params)
+    return response.text
+
+
+@mcp.tool()
+def search_actions(query: str = "", category: str = "", class_name: str = "", pin_category: str = "",
+                   pin_sub_type: str = "", from_output: bool = True, limit: int = 20) -> str:
+    """Search every function, variable, event, macro and node the Blueprint editor can add, like its action menu.
+    Results are ranked by name, then keywords, category and class, and small typos are tolerated.
+    Function results carry the class and function name to use with add_function_call_to_graph or describe_node.
+    The first search may build the editor's action database, results are partial until Complete is true.
+
+    query: Words to look for (e.g., 'get actor location', 'print'), empty to list everything the filters match.
+    category: Only actions in this category or below (e.g., 'Math|Vector').
+    class_name: Only functions and variables declared by this class (e.g., 'KismetSystemLibrary').
+    pin_category: Only actions that can connect to a pin of this type, like dragging off a pin (e.g., 'object', 'real', 'exec').
+    pin_sub_type: Class, struct or enum of that pin (e.g., 'Actor', 'Vector').
+    from_output: True when the pin is an output, so actions need a matching input, False for the other way around.
+    limit: Maximum number of results.
+    """
+    url = f"{BASE_URL}/search_actions"
+    body = {"Query": query, "Category": category, "ClassName": class_name, "PinCategory": pin_category,
+            "PinSubType": pin_sub_type, "bFromOutput": from_output, "Limit": limit}
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -214,7 +503,27 @@ def add_variable_to_bp(bp_path: str, var_signature: str) -> str:
     """
     url = f"{BASE_URL}/add_variable_to_bp"
     body = {"BpPath": bp_path, "VarSignature": var_signature}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
+    return response.text
+
+
+@mcp.tool()
+def apply_blueprint_schema(bp_path: str, variables: list[dict] = None, functions: list[dict] = None,
+                           components: list[dict] = None, prune: bool = False) -> str:
+    """Make the Blueprint's variables, functions and components match a description, compiling once.
+    Prefer this over many add/edit calls when setting up several members. Returns the outcome of every item.
+
+    bp_path: Must be a valid Blueprint path.
+    variables: List of {"Name", "Type", "DefaultValue"}, type in c++ style (e.g., 'float', 'TArray<AActor*>').
+    functions: List of {"FunctionName", "FunctionInputSignature", "FunctionOutputSignature"},
+        signatures are comma separated 'type name' lists (e.g., 'int32 A, float B').
+    components: List of {"ComponentName", "ComponentClass", "AttachTo", "Properties": {property path: value}}.
+    prune: Remove variables, functions and components that are not listed.
+    """
+    url = f"{BASE_URL}/apply_blueprint_schema"
+    body = {"BpPath": bp_path, "Variables": variables or [], "Functions": functions or [],
+            "Components": components or [], "bPrune": prune}
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -227,7 +536,7 @@ def delete_variable_from_bp(bp_path: str, var_name: str) -> str:
     """
     url = f"{BASE_URL}/delete_variable_from_bp"
     body = {"BpPath": bp_path, "VarName": var_name}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -241,7 +550,7 @@ def rename_variable_in_bp(bp_path: str, old_var_name: str, new_var_name: str) ->
     """
     url = f"{BASE_URL}/rename_variable_in_bp"
     body = {"BpPath": bp_path, "OldVarName": old_var_name, "NewVarName": new_var_name}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -255,13 +564,13 @@ def set_variable_default_value_in_bp(bp_path: str, var_name: str, default_value:
     """
     url = f"{BASE_URL}/set_variable_default_value_in_bp"
     body = {"BpPath": bp_path, "VarName": var_name, "DefaultValue": default_value}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
 @mcp.tool()
 def connect_pins(bp_path: str, graph_name: str, output_node_id: str, output_pin_name: str, input_node_id: str,
-                 input_pin_name: str) -> str:
+                 input_pin_name: str, validate: bool = False) -> str:
     """Connect pins between nodes in the specified graph.
     Node ids and pin name can be found in the graph structure from tool: get_graph.
 
@@ -271,11 +580,32 @@ def connect_pins(bp_path: str, graph_name: str, output_node_id: str, output_pin_
     output_pin_name: Must be a valid pin name on the output node.
     input_node_id: Must be a valid node ID.
     input_pin_name: Must be a valid pin name on the input node.
+    validate: Fail if the pin types can't connect instead of linking them anyway, and add a conversion node
+        (e.g., float to string) when one is needed, like dragging the wire in the editor.
     """
     url = f"{BASE_URL}/connect_pins"
     body = {"BpPath": bp_path, "GraphName": graph_name, "OutputNodeId": output_node_id,
-            "OutputPinName": output_pin_name, "InputNodeId": input_node_id, "InputPinName": input_pin_name}
-    response = httpx.post(url, json=body)
+            "OutputPinName": output_pin_name, "InputNodeId": input_node_id, "InputPinName": input_pin_name,
+            "bValidate": validate}
+    response = client.post(url, json=body)
+    return response.text
+
+
+@mcp.tool()
+def check_pin_connections(bp_path: str, graph_name: str, pairs: list[dict]) -> str:
+    """Check whether pins can be connected, for many candidate links in one call, without changing the graph.
+    Returns one result per pair, in order: Response (Make, BreakOthersA, BreakOthersB, BreakOthersAB,
+    MakeWithConversionNode, MakeWithPromotion or Disallow), CanConnect, NeedsValidate when connect_pins must be
+    called with validate=True to break the pins' existing links or add the conversion node, and the schema's Message.
+
+    bp_path: Must be a valid Blueprint path
+    graph_name: Must be a valid graph name (e.g., 'EventGraph').
+    pairs: Links to check, e.g. [{"OutputNodeId": "...", "OutputPinName": "ReturnValue", "InputNodeId": "...",
+        "InputPinName": "InString"}].
+    """
+    url = f"{BASE_URL}/check_pin_connections"
+    body = {"BpPath": bp_path, "GraphName": graph_name, "Pairs": pairs}
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -295,7 +625,7 @@ def break_pin_connection(bp_path: str, graph_name: str, output_node_id: str, out
     url = f"{BASE_URL}/break_pin_connection"
     body = {"BpPath": bp_path, "GraphName": graph_name, "OutputNodeId": output_node_id,
             "OutputPinName": output_pin_name, "InputNodeId": input_node_id, "InputPinName": input_pin_name}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -313,7 +643,29 @@ def set_pin_default_value(bp_path: str, graph_name: str, node_id: str, pin_name:
     url = f"{BASE_URL}/set_pin_default_value"
     body = {"BpPath": bp_path, "GraphName": graph_name, "NodeId": node_id, "PinName": pin_name,
             "DefaultValue": default_value}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
+    return response.text
+
+
+@mcp.tool()
+def apply_graph(bp_path: str, graph_name: str, nodes: list[dict], links: list[dict], prune: bool = True) -> str:
+    """Make a graph match a full description of its nodes, links and pin defaults in one call.
+    Only the differences are applied, so send the whole description again after changing part of it.
+    Returns the counts of changes and the node id of every client id, for tools that take node ids.
+
+    bp_path: Must be a valid Blueprint path.
+    graph_name: Must be a valid graph name (e.g., 'EventGraph').
+    nodes: List of {"Id", "Type", "Name", "ClassToCall", "EventSignature", "Defaults": {pin name: value}}.
+        Id is your own stable name for the node, or a node id from get_graph to keep an existing node.
+        Type is FunctionCall, Math, Event, CustomEvent, GetVariable, SetVariable, MakeStruct, BreakStruct,
+        DynamicCast, ClassCast, EnumCast, Comment, or a node type from get_supported_nodes.
+        Name is the function, event, variable, struct, class or enum name, or the comment text.
+    links: List of {"From", "FromPin", "To", "ToPin"} using node Ids.
+    prune: Delete nodes that are not in nodes. Set False to leave the rest of the graph alone.
+    """
+    url = f"{BASE_URL}/apply_graph"
+    body = {"BpPath": bp_path, "GraphName": graph_name, "Nodes": nodes, "Links": links, "bPrune": prune}
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -330,7 +682,7 @@ def add_generic_node_to_graph(bp_path: str, graph_name: str, node_type_name: str
     """
     url = f"{BASE_URL}/add_generic_node_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "NodeTypeName": node_type_name}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -344,7 +696,7 @@ def add_make_struct_node_to_graph(bp_path: str, graph_name: str, extra_info: str
     """
     url = f"{BASE_URL}/add_make_struct_node_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "ExtraInfo": extra_info}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -358,7 +710,7 @@ def add_break_struct_node_to_graph(bp_path: str, graph_name: str, extra_info: st
     """
     url = f"{BASE_URL}/add_break_struct_node_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "ExtraInfo": extra_info}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -372,7 +724,7 @@ def add_dynamic_cast_node_to_graph(bp_path: str, graph_name: str, extra_info: st
     """
     url = f"{BASE_URL}/add_dynamic_cast_node_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "ExtraInfo": extra_info}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -386,7 +738,7 @@ def add_class_cast_node_to_graph(bp_path: str, graph_name: str, extra_info: str)
     """
     url = f"{BASE_URL}/add_class_cast_node_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "ExtraInfo": extra_info}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -400,7 +752,7 @@ def add_enum_cast_node_to_graph(bp_path: str, graph_name: str, extra_info: str)
     """
     url = f"{BASE_URL}/add_enum_cast_node_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "ExtraInfo": extra_info}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -415,7 +767,7 @@ def add_math_node_to_graph(bp_path: str, graph_name: str, function_name: str) ->
     """
     url = f"{BASE_URL}/add_math_node_to_graph"
     body = {"BpPath": bp_path, "GraphName": graph_name, "FunctionName": function_name}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -427,7 +779,7 @@ def get_components_of_bp(bp_path: str) -> str:
     """
     url = f"{BASE_URL}/get_components_of_bp"
     params = {"bp_path": bp_path}
-    response = httpx.get(url, params=params)
+    response = client.get(url, params=params)
     return response.text
 
 
@@ -443,7 +795,7 @@ def add_component_to_bp(bp_path: str, component_class: str, component_name: str,
     url = f"{BASE_URL}/add_component_to_bp"
     body = {"BpPath": bp_path, "ComponentClass": component_class, "ComponentName": component_name,
             "AttachTo": attach_to}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -457,7 +809,7 @@ def rename_component_in_bp(bp_path: str, component_name: str, new_component_name
     """
     url = f"{BASE_URL}/rename_component_in_bp"
     body = {"BpPath": bp_path, "ComponentName": component_name, "NewComponentName": new_component_name}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -470,7 +822,7 @@ def remove_component_from_bp(bp_path: str, component_name: str) -> str:
     """
     url = f"{BASE_URL}/remove_component_from_bp"
     body = {"BpPath": bp_path, "ComponentName": component_name}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -484,7 +836,7 @@ def reattach_component_in_bp(bp_path: str, component_name: str, attach_to: str)
     """
     url = f"{BASE_URL}/reattach_component_in_bp"
     body = {"BpPath": bp_path, "ComponentName": component_name, "AttachTo": attach_to}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
@@ -497,7 +849,7 @@ def get_component_properties(bp_path: str, component_name: str) -> str:
     """
     url = f"{BASE_URL}/get_component_properties"
     params = {"bp_path": bp_path, "component_name": component_name}
-    response = httpx.get(url, params=params)
+    response = client.get(url, params=params)
     return response.text
 
 
@@ -517,10 +869,26 @@ def set_component_property(bp_path: str, component_name: str, properties: dict)
     """
     url = f"{BASE_URL}/set_component_property"
     body = {"BpPath": bp_path, "ComponentName": component_name, "Properties": properties}
-    response = httpx.post(url, json=body)
+    response = client.post(url, json=body)
     return response.text
 
 
+@mcp.tool()
+def get_events(max_events: int = 100) -> str:
+    """Get Blueprint change events pushed by the editor since the last call, oldest first.
+
+    Events are graph_changed, property_changed and blueprint_compiled, each with the blueprint path.
+    Only available when connected over WebSocket (UE5_WS_URL).
+    max_events: Maximum number of events to return.
+    """
+    if not isinstance(client, WebSocketClient):
+        return "Error: change events require the WebSocket channel, set UE5_WS_URL"
+    events = []
+    while client.events and len(events) < max_events:
+        events.append(client.events.popleft())
+    return json.dumps(events)
+
+
 async def main():
     await mcp.run_streamable_http_async()
 
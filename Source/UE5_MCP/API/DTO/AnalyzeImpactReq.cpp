@@ -0,0 +1 @@
+﻿#include "AnalyzeImpactReq.h"
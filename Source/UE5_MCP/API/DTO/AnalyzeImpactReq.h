@@ -0,0 +1,20 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "AnalyzeImpactReq.generated.h"
+
+USTRUCT()
+struct FAnalyzeImpactReq
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString BpPath;
+
+	// Function or variable declared in the Blueprint
+	UPROPERTY()
+	FString MemberName;
+
+	UPROPERTY()
+	FString MemberKind = TEXT("Function"); // Function or Variable
+};
@@ -0,0 +1 @@
+﻿#include "ApplyBlueprintSchemaReq.h"
@@ -0,0 +1,74 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "ApplyBlueprintSchemaReq.generated.h"
+
+USTRUCT()
+struct FSchemaVariableDesc
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString Name;
+
+	UPROPERTY()
+	FString Type; // e.g. 'int32', 'TArray<FVector>'
+
+	UPROPERTY()
+	FString DefaultValue; // left as it is when empty
+};
+
+USTRUCT()
+struct FSchemaFunctionDesc
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString FunctionName;
+
+	UPROPERTY()
+	FString FunctionInputSignature;
+
+	UPROPERTY()
+	FString FunctionOutputSignature;
+};
+
+USTRUCT()
+struct FSchemaComponentDesc
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString ComponentName;
+
+	UPROPERTY()
+	FString ComponentClass;
+
+	UPROPERTY()
+	FString AttachTo; // left as it is when empty
+
+	UPROPERTY()
+	TMap<FString, FString> Properties;
+};
+
+USTRUCT()
+struct FApplyBlueprintSchemaReq
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString BpPath;
+
+	UPROPERTY()
+	TArray<FSchemaVariableDesc> Variables;
+
+	UPROPERTY()
+	TArray<FSchemaFunctionDesc> Functions;
+
+	UPROPERTY()
+	TArray<FSchemaComponentDesc> Components;
+
+	// Removes variables, functions and components that are not listed
+	// Overrides, the construction script and the default scene root are always kept
+	UPROPERTY()
+	bool bPrune = false;
+};
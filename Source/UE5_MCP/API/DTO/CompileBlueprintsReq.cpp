@@ -0,0 +1 @@
+﻿#include "CompileBlueprintsReq.h"
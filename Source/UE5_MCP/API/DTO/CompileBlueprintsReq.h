@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "CompileBlueprintsReq.generated.h"
+
+USTRUCT()
+struct FCompileBlueprintsReq
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FString> BpPaths;
+
+	// Every Blueprint under this content folder is compiled as well, e.g. /Game/Enemies
+	UPROPERTY()
+	FString PathPrefix;
+
+	UPROPERTY()
+	bool bSkipGarbageCollection = false;
+
+	// Don't save the compiled Blueprints even when the editor's Save on Compile setting asks for it
+	UPROPERTY()
+	bool bSkipSave = false;
+};
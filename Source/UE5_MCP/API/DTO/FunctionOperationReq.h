@@ -19,4 +19,8 @@ public:
 
 	UPROPERTY()
 	FString FunctionOutputSignature; // used for AddFunctionGraph and EditFunctionGraph
+
+	// EditFunctionGraph and RemoveFunctionGraph also reconstruct or remove the calls in this and dependent Blueprints
+	UPROPERTY()
+	bool bUpdateCallSites = false;
 };
@@ -0,0 +1 @@
+﻿#include "ApplyGraphReq.h"
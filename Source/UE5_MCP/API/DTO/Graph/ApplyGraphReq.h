@@ -0,0 +1,67 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "GraphOperationReq.h"
+#include "ApplyGraphReq.generated.h"
+
+USTRUCT()
+struct FGraphNodeDesc
+{
+	GENERATED_BODY()
+
+	// Client chosen id, stable across applies. A node GUID from get_graph adopts that existing node
+	UPROPERTY()
+	FString Id;
+
+	// FunctionCall, Math, Event, CustomEvent, GetVariable, SetVariable, MakeStruct, BreakStruct,
+	// DynamicCast, ClassCast, EnumCast, Comment, or a K2Node class name for any other node
+	UPROPERTY()
+	FString Type;
+
+	// Function, event, variable, struct, class or enum name, or the comment text
+	UPROPERTY()
+	FString Name;
+
+	UPROPERTY()
+	FString ClassToCall;
+
+	UPROPERTY()
+	FString EventSignature;
+
+	// Pin name to default value
+	UPROPERTY()
+	TMap<FString, FString> Defaults;
+};
+
+USTRUCT()
+struct FGraphLinkDesc
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString From;
+
+	UPROPERTY()
+	FString FromPin;
+
+	UPROPERTY()
+	FString To;
+
+	UPROPERTY()
+	FString ToPin;
+};
+
+USTRUCT()
+struct FApplyGraphReq : public FGraphOperationReq
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FGraphNodeDesc> Nodes;
+
+	UPROPERTY()
+	TArray<FGraphLinkDesc> Links;
+
+	// Removes nodes that are not in Nodes, the description is then the whole graph
+	UPROPERTY()
+	bool bPrune = true;
+};
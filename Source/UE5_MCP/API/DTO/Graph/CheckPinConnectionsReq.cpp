@@ -0,0 +1 @@
+﻿#include "CheckPinConnectionsReq.h"
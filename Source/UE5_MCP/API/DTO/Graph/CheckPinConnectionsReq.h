@@ -0,0 +1,31 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "GraphOperationReq.h"
+#include "CheckPinConnectionsReq.generated.h"
+
+USTRUCT()
+struct FPinConnectionPair
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FGuid OutputNodeId;
+
+	UPROPERTY()
+	FString OutputPinName;
+
+	UPROPERTY()
+	FGuid InputNodeId;
+
+	UPROPERTY()
+	FString InputPinName;
+};
+
+USTRUCT()
+struct FCheckPinConnectionsReq: public FGraphOperationReq
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FPinConnectionPair> Pairs;
+};
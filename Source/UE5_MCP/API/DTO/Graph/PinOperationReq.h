@@ -19,4 +19,8 @@ struct FPinOperationReq: public FGraphOperationReq
 
 	UPROPERTY()
 	FString InputPinName;
+
+	// connect_pins only: check the link with the graph's schema first and add a conversion node if one is needed
+	UPROPERTY()
+	bool bValidate = false;
 };
@@ -0,0 +1 @@
+﻿#include "SearchActionsReq.h"
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "SearchActionsReq.generated.h"
+
+USTRUCT()
+struct FSearchActionsReq
+{
+	GENERATED_BODY()
+
+	// Words of the action name, keywords, category or class, typos are tolerated
+	UPROPERTY()
+	FString Query;
+
+	// Only actions in this category or below, e.g. Math|Vector
+	UPROPERTY()
+	FString Category;
+
+	// Only functions and variables declared by this class
+	UPROPERTY()
+	FString ClassName;
+
+	// Only actions that can connect to the pin being dragged from, e.g. object and Actor
+	UPROPERTY()
+	FString PinCategory;
+
+	UPROPERTY()
+	FString PinSubType; // class, struct or enum of the pin
+
+	UPROPERTY()
+	bool bFromOutput = true; // the pin is an output, so actions need a matching input
+
+	UPROPERTY()
+	int32 Limit = 20;
+};
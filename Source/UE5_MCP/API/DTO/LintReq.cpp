@@ -0,0 +1 @@
+﻿#include "LintReq.h"
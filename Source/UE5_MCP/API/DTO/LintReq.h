@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "LintReq.generated.h"
+
+USTRUCT()
+struct FLintReq
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString BpPath;
+
+	// Every Blueprint under this content folder is linted as well, e.g. /Game/Enemies
+	UPROPERTY()
+	FString PathPrefix;
+
+	// Rules to run, e.g. UnusedVariable, HeavyTick. Empty runs all of them
+	UPROPERTY()
+	TArray<FString> Rules;
+};
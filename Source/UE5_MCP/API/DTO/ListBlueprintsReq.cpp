@@ -0,0 +1 @@
+﻿#include "ListBlueprintsReq.h"
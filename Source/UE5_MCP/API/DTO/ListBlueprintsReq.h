@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "ListBlueprintsReq.generated.h"
+
+USTRUCT()
+struct FListBlueprintsReq
+{
+	GENERATED_BODY()
+
+	// Content folder searched recursively, e.g. /Game/Enemies, empty for every folder
+	UPROPERTY()
+	FString PathPrefix;
+
+	// Native or Blueprint class, matches every Blueprint deriving from it at any depth
+	UPROPERTY()
+	FString ParentClass;
+
+	// Every listed interface must be implemented by the Blueprint itself
+	UPROPERTY()
+	TArray<FString> Interfaces;
+
+	// Asset registry tag values that must match, e.g. BlueprintType: BPTYPE_Normal
+	UPROPERTY()
+	TMap<FString, FString> Tags;
+
+	UPROPERTY()
+	FString SortBy = TEXT("Name"); // Name, Path or ParentClass
+
+	UPROPERTY()
+	bool bDescending = false;
+
+	UPROPERTY()
+	int32 Offset = 0;
+
+	UPROPERTY()
+	int32 Limit = 100;
+};
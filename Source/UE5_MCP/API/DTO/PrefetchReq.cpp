@@ -0,0 +1 @@
+﻿#include "PrefetchReq.h"
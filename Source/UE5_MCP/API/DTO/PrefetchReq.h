@@ -0,0 +1,14 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "PrefetchReq.generated.h"
+
+USTRUCT()
+struct FPrefetchReq
+{
+	GENERATED_BODY()
+
+	// Blueprint or asset paths, e.g. /Game/Test/MyBlueprint
+	UPROPERTY()
+	TArray<FString> Paths;
+};
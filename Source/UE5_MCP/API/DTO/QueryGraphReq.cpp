@@ -0,0 +1 @@
+﻿#include "QueryGraphReq.h"
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "QueryGraphReq.generated.h"
+
+USTRUCT()
+struct FQueryGraphReq
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FString BpPath;
+
+	// Event, function or macro graph name, e.g. EventGraph
+	UPROPERTY()
+	FString GraphName;
+
+	UPROPERTY()
+	FString Query = TEXT("Filter"); // ExecForward, ExecBackward, DataUpstream, DataDownstream or Filter
+
+	// Start node for every query but Filter, give its id or the name of an event in the graph
+	UPROPERTY()
+	FString NodeId;
+
+	UPROPERTY()
+	FString EventName;
+
+	// Only follow this pin of the start node
+	UPROPERTY()
+	FString PinName;
+
+	// Links followed from the start node, 0 for no limit
+	UPROPERTY()
+	int32 MaxDepth = 0;
+
+	// Filters on the returned nodes, empty ones match every node
+	UPROPERTY()
+	FString NodeType;
+
+	// Called function, event or variable name
+	UPROPERTY()
+	FString MemberName;
+
+	// Part of any pin's type, e.g. exec, real or a class name
+	UPROPERTY()
+	FString PinType;
+};
@@ -0,0 +1,534 @@
+﻿#include "JsonStructReader.h"
+
+#include "Misc/Parse.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/UnrealType.h"
+
+FCriticalSection JsonStructReader::PlansLock;
+TMap<const UScriptStruct*, TUniquePtr<JsonStructReader::FStructPlan>> JsonStructReader::Plans;
+
+// Recursive descent over the UTF-8 body. Strings without escapes are converted straight from the body,
+// escaped ones are unescaped into a scratch buffer first
+class JsonStructReader::FParser
+{
+public:
+	FParser(const uint8* Data, int32 Size)
+		: Cursor(Data)
+		, End(Data + Size)
+	{
+	}
+
+	bool ReadDocument(const UScriptStruct* Struct, void* Out)
+	{
+		if (End - Cursor >= 3 && Cursor[0] == 0xEF && Cursor[1] == 0xBB && Cursor[2] == 0xBF)
+			Cursor += 3;
+
+		if (!ReadStruct(Struct, Out))
+			return false;
+		SkipWhitespace();
+		return Cursor == End;
+	}
+
+private:
+	static constexpr int32 MaxDepth = 256;
+
+	const uint8* Cursor;
+	const uint8* End;
+	int32 Depth = 0;
+	TArray<uint8, TInlineAllocator<256>> Scratch;
+
+	void SkipWhitespace()
+	{
+		while (Cursor < End && (*Cursor == ' ' || *Cursor == '\t' || *Cursor == '\n' || *Cursor == '\r'))
+			++Cursor;
+	}
+
+	uint8 Peek()
+	{
+		SkipWhitespace();
+		return Cursor < End ? *Cursor : 0;
+	}
+
+	bool Consume(uint8 Char)
+	{
+		if (Peek() != Char)
+			return false;
+		++Cursor;
+		return true;
+	}
+
+	bool ConsumeLiteral(const ANSICHAR* Literal)
+	{
+		SkipWhitespace();
+		const int32 Length = FCStringAnsi::Strlen(Literal);
+		if (End - Cursor < Length || FMemory::Memcmp(Cursor, Literal, Length) != 0)
+			return false;
+		Cursor += Length;
+		return true;
+	}
+
+	bool ParseHex4(uint32& OutValue)
+	{
+		if (End - Cursor < 4)
+			return false;
+		OutValue = 0;
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			const uint8 Char = *Cursor++;
+			if (!FChar::IsHexDigit(static_cast<TCHAR>(Char)))
+				return false;
+			OutValue = (OutValue << 4) | FParse::HexDigit(static_cast<TCHAR>(Char));
+		}
+		return true;
+	}
+
+	void AppendUtf8(uint32 CodePoint)
+	{
+		if (CodePoint < 0x80)
+		{
+			Scratch.Add(static_cast<uint8>(CodePoint));
+		}
+		else if (CodePoint < 0x800)
+		{
+			Scratch.Add(static_cast<uint8>(0xC0 | (CodePoint >> 6)));
+			Scratch.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Scratch.Add(static_cast<uint8>(0xE0 | (CodePoint >> 12)));
+			Scratch.Add(static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Scratch.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+		else
+		{
+			Scratch.Add(static_cast<uint8>(0xF0 | (CodePoint >> 18)));
+			Scratch.Add(static_cast<uint8>(0x80 | ((CodePoint >> 12) & 0x3F)));
+			Scratch.Add(static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Scratch.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+	}
+
+	// The returned span points into the body, or into Scratch when the string has escapes
+	// It stays valid until the next string is parsed
+	bool ParseString(const uint8*& OutBegin, int32& OutLength)
+	{
+		if (!Consume('"'))
+			return false;
+
+		const uint8* Begin = Cursor;
+		while (Cursor < End && *Cursor != '"' && *Cursor != '\\')
+		{
+			if (*Cursor < 0x20)
+				return false;
+			++Cursor;
+		}
+		if (Cursor >= End)
+			return false;
+		if (*Cursor == '"')
+		{
+			OutBegin = Begin;
+			OutLength = static_cast<int32>(Cursor - Begin);
+			++Cursor;
+			return true;
+		}
+
+		Scratch.Reset();
+		Scratch.Append(Begin, static_cast<int32>(Cursor - Begin));
+		while (Cursor < End && *Cursor != '"')
+		{
+			const uint8 Char = *Cursor++;
+			if (Char < 0x20)
+				return false;
+			if (Char != '\\')
+			{
+				Scratch.Add(Char);
+				continue;
+			}
+			if (Cursor >= End)
+				return false;
+
+			switch (*Cursor++)
+			{
+			case '"':
+				Scratch.Add('"');
+				break;
+			case '\\':
+				Scratch.Add('\\');
+				break;
+			case '/':
+				Scratch.Add('/');
+				break;
+			case 'b':
+				Scratch.Add('\b');
+				break;
+			case 'f':
+				Scratch.Add('\f');
+				break;
+			case 'n':
+				Scratch.Add('\n');
+				break;
+			case 'r':
+				Scratch.Add('\r');
+				break;
+			case 't':
+				Scratch.Add('\t');
+				break;
+			case 'u':
+			{
+				uint32 CodePoint;
+				if (!ParseHex4(CodePoint))
+					return false;
+				// Surrogate pairs are written as two escapes
+				if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF && End - Cursor >= 6 && Cursor[0] == '\\' && Cursor[1] == 'u')
+				{
+					Cursor += 2;
+					uint32 LowSurrogate;
+					if (!ParseHex4(LowSurrogate))
+						return false;
+					if (LowSurrogate >= 0xDC00 && LowSurrogate <= 0xDFFF)
+					{
+						CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (LowSurrogate - 0xDC00);
+					}
+					else
+					{
+						AppendUtf8(CodePoint);
+						CodePoint = LowSurrogate;
+					}
+				}
+				AppendUtf8(CodePoint);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+		if (Cursor >= End)
+			return false;
+		++Cursor;
+
+		OutBegin = Scratch.GetData();
+		OutLength = Scratch.Num();
+		return true;
+	}
+
+	bool ParseString(FString& OutString)
+	{
+		const uint8* Begin;
+		int32 Length;
+		if (!ParseString(Begin, Length))
+			return false;
+		OutString = FString(Length, reinterpret_cast<const UTF8CHAR*>(Begin));
+		return true;
+	}
+
+	static bool IsDigit(uint8 Char)
+	{
+		return Char >= '0' && Char <= '9';
+	}
+
+	// Follows the JSON number grammar, so the token can be handed to the C string conversions as is
+	bool ParseNumber(double& OutDouble, int64& OutInteger, bool& bOutIsInteger)
+	{
+		SkipWhitespace();
+		const uint8* Begin = Cursor;
+		bOutIsInteger = true;
+
+		if (Cursor < End && *Cursor == '-')
+			++Cursor;
+		if (Cursor >= End || !IsDigit(*Cursor))
+			return false;
+		if (*Cursor == '0')
+			++Cursor;
+		else
+			while (Cursor < End && IsDigit(*Cursor))
+				++Cursor;
+
+		if (Cursor < End && *Cursor == '.')
+		{
+			bOutIsInteger = false;
+			++Cursor;
+			if (Cursor >= End || !IsDigit(*Cursor))
+				return false;
+			while (Cursor < End && IsDigit(*Cursor))
+				++Cursor;
+		}
+		if (Cursor < End && (*Cursor == 'e' || *Cursor == 'E'))
+		{
+			bOutIsInteger = false;
+			++Cursor;
+			if (Cursor < End && (*Cursor == '+' || *Cursor == '-'))
+				++Cursor;
+			if (Cursor >= End || !IsDigit(*Cursor))
+				return false;
+			while (Cursor < End && IsDigit(*Cursor))
+				++Cursor;
+		}
+
+		ANSICHAR Token[64];
+		const int32 Length = static_cast<int32>(Cursor - Begin);
+		if (Length >= UE_ARRAY_COUNT(Token))
+			return false;
+		FMemory::Memcpy(Token, Begin, Length);
+		Token[Length] = '\0';
+
+		OutDouble = FCStringAnsi::Atod(Token);
+		OutInteger = bOutIsInteger ? FCStringAnsi::Atoi64(Token) : static_cast<int64>(OutDouble);
+		return true;
+	}
+
+	bool SkipValue()
+	{
+		if (++Depth > MaxDepth)
+			return false;
+		ON_SCOPE_EXIT { --Depth; };
+
+		switch (Peek())
+		{
+		case '"':
+		{
+			const uint8* Begin;
+			int32 Length;
+			return ParseString(Begin, Length);
+		}
+		case '{':
+		{
+			++Cursor;
+			if (Consume('}'))
+				return true;
+			do
+			{
+				const uint8* Begin;
+				int32 Length;
+				if (!ParseString(Begin, Length) || !Consume(':') || !SkipValue())
+					return false;
+			} while (Consume(','));
+			return Consume('}');
+		}
+		case '[':
+		{
+			++Cursor;
+			if (Consume(']'))
+				return true;
+			do
+			{
+				if (!SkipValue())
+					return false;
+			} while (Consume(','));
+			return Consume(']');
+		}
+		case 't':
+			return ConsumeLiteral("true");
+		case 'f':
+			return ConsumeLiteral("false");
+		case 'n':
+			return ConsumeLiteral("null");
+		default:
+		{
+			double Double;
+			int64 Integer;
+			bool bIsInteger;
+			return ParseNumber(Double, Integer, bIsInteger);
+		}
+		}
+	}
+
+	bool ReadStruct(const UScriptStruct* Struct, void* Out)
+	{
+		if (++Depth > MaxDepth)
+			return false;
+		ON_SCOPE_EXIT { --Depth; };
+
+		const FStructPlan& Plan = GetPlan(Struct);
+		if (!Consume('{'))
+			return false;
+		if (Consume('}'))
+			return true;
+		do
+		{
+			const uint8* Key;
+			int32 KeyLength;
+			if (!ParseString(Key, KeyLength) || !Consume(':'))
+				return false;
+
+			const FField* Field = Plan.Find(Key, KeyLength);
+			if (!Field)
+			{
+				if (!SkipValue())
+					return false;
+				continue;
+			}
+			if (!ReadValue(Field->Property, Field->Kind, Field->Property->ContainerPtrToValuePtr<void>(Out)))
+				return false;
+		} while (Consume(','));
+		return Consume('}');
+	}
+
+	// Only JSON types that map directly on the property are accepted, anything looser is left to FJsonObjectConverter
+	bool ReadValue(FProperty* Property, EFieldKind Kind, void* ValuePtr)
+	{
+		switch (Kind)
+		{
+		case EFieldKind::String:
+			return Peek() == '"' && ParseString(*static_cast<FString*>(ValuePtr));
+
+		case EFieldKind::Name:
+		{
+			FString Value;
+			if (Peek() != '"' || !ParseString(Value))
+				return false;
+			*static_cast<FName*>(ValuePtr) = FName(*Value);
+			return true;
+		}
+
+		case EFieldKind::Bool:
+		{
+			bool bValue;
+			if (Peek() == 't' && ConsumeLiteral("true"))
+				bValue = true;
+			else if (Peek() == 'f' && ConsumeLiteral("false"))
+				bValue = false;
+			else
+				return false;
+			CastFieldChecked<FBoolProperty>(Property)->SetPropertyValue(ValuePtr, bValue);
+			return true;
+		}
+
+		case EFieldKind::Numeric:
+		{
+			const uint8 Next = Peek();
+			if (Next != '-' && !IsDigit(Next))
+				return false;
+			double Double;
+			int64 Integer;
+			bool bIsInteger;
+			if (!ParseNumber(Double, Integer, bIsInteger))
+				return false;
+			FNumericProperty* NumericProperty = CastFieldChecked<FNumericProperty>(Property);
+			if (NumericProperty->IsFloatingPoint())
+				NumericProperty->SetFloatingPointPropertyValue(ValuePtr, Double);
+			else
+				NumericProperty->SetIntPropertyValue(ValuePtr, Integer);
+			return true;
+		}
+
+		case EFieldKind::Guid:
+		{
+			if (Peek() == '{')
+				return ReadStruct(TBaseStructure<FGuid>::Get(), ValuePtr);
+			FString Value;
+			return Peek() == '"' && ParseString(Value) && FGuid::Parse(Value, *static_cast<FGuid*>(ValuePtr));
+		}
+
+		case EFieldKind::Struct:
+			return Peek() == '{' && ReadStruct(CastFieldChecked<FStructProperty>(Property)->Struct, ValuePtr);
+
+		case EFieldKind::Array:
+		{
+			FArrayProperty* ArrayProperty = CastFieldChecked<FArrayProperty>(Property);
+			const EFieldKind InnerKind = GetFieldKind(ArrayProperty->Inner);
+			FScriptArrayHelper Helper(ArrayProperty, ValuePtr);
+			Helper.EmptyValues();
+
+			if (!Consume('['))
+				return false;
+			if (Consume(']'))
+				return true;
+			do
+			{
+				const int32 Index = Helper.AddValue();
+				if (!ReadValue(ArrayProperty->Inner, InnerKind, Helper.GetRawPtr(Index)))
+					return false;
+			} while (Consume(','));
+			return Consume(']');
+		}
+
+		case EFieldKind::Map:
+		{
+			FScriptMapHelper Helper(CastFieldChecked<FMapProperty>(Property), ValuePtr);
+			Helper.EmptyValues();
+
+			if (!Consume('{'))
+				return false;
+			if (Consume('}'))
+				return true;
+			do
+			{
+				FString Key;
+				FString Value;
+				if (!ParseString(Key) || !Consume(':') || Peek() != '"' || !ParseString(Value))
+					return false;
+				// Replaces the value of a repeated key, like the JSON DOM does
+				Helper.AddPair(&Key, &Value);
+			} while (Consume(','));
+			return Consume('}');
+		}
+
+		default:
+			return false;
+		}
+	}
+};
+
+const JsonStructReader::FField* JsonStructReader::FStructPlan::Find(const uint8* Key, int32 Length) const
+{
+	for (const FField& Field : Fields)
+	{
+		if (Field.Name.Len() != Length)
+			continue;
+
+		int32 Index = 0;
+		while (Index < Length && FChar::ToLower(static_cast<TCHAR>(Key[Index])) == FChar::ToLower(Field.Name[Index]))
+			++Index;
+		if (Index == Length)
+			return &Field;
+	}
+	return nullptr;
+}
+
+JsonStructReader::EFieldKind JsonStructReader::GetFieldKind(const FProperty* Property)
+{
+	if (Property->ArrayDim != 1)
+		return EFieldKind::Unsupported;
+	if (Property->IsA<FStrProperty>())
+		return EFieldKind::String;
+	if (Property->IsA<FNameProperty>())
+		return EFieldKind::Name;
+	if (Property->IsA<FBoolProperty>())
+		return EFieldKind::Bool;
+	if (Property->IsA<FNumericProperty>())
+		return EFieldKind::Numeric;
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		return StructProperty->Struct == TBaseStructure<FGuid>::Get() ? EFieldKind::Guid : EFieldKind::Struct;
+	if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+		return GetFieldKind(ArrayProperty->Inner) == EFieldKind::Unsupported ? EFieldKind::Unsupported : EFieldKind::Array;
+	if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+	{
+		if (MapProperty->KeyProp->IsA<FStrProperty>() && MapProperty->ValueProp->IsA<FStrProperty>())
+			return EFieldKind::Map;
+	}
+	return EFieldKind::Unsupported;
+}
+
+const JsonStructReader::FStructPlan& JsonStructReader::GetPlan(const UScriptStruct* Struct)
+{
+	FScopeLock Lock(&PlansLock);
+	if (const TUniquePtr<FStructPlan>* Existing = Plans.Find(Struct))
+		return **Existing;
+
+	TUniquePtr<FStructPlan> Plan = MakeUnique<FStructPlan>();
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		// Same name FJsonObjectConverter looks the property up with
+		Plan->Fields.Add({ Struct->GetAuthoredNameForField(*It), *It, GetFieldKind(*It) });
+	}
+	return *Plans.Add(Struct, MoveTemp(Plan));
+}
+
+bool JsonStructReader::Read(const UScriptStruct* Struct, void* Out, const uint8* Data, int32 Size)
+{
+	if (!Struct || !Out || !Data)
+		return false;
+
+	FParser Parser(Data, Size);
+	return Parser.ReadDocument(Struct, Out);
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+// Streaming reader that fills a USTRUCT straight from a UTF-8 JSON body, without the FString copy and FJsonObject DOM
+// Property names are matched case-insensitively through a field plan cached per struct, unknown keys are skipped
+// Handles strings, names, bools, numbers, FGuid, nested structs, arrays and TMap<FString, FString>
+class JsonStructReader
+{
+public:
+	// Returns false when the body is malformed or uses a type the reader doesn't handle, Out may then be partially written
+	static bool Read(const UScriptStruct* Struct, void* Out, const uint8* Data, int32 Size);
+
+	template <typename T>
+	static bool Read(T& Out, const TArray<uint8>& Buffer)
+	{
+		return Read(T::StaticStruct(), &Out, Buffer.GetData(), Buffer.Num());
+	}
+
+private:
+	enum class EFieldKind : uint8
+	{
+		String,
+		Name,
+		Bool,
+		Numeric,
+		Guid,
+		Struct,
+		Array,
+		Map,
+		Unsupported
+	};
+
+	struct FField
+	{
+		FString Name;
+		FProperty* Property;
+		EFieldKind Kind;
+	};
+
+	struct FStructPlan
+	{
+		TArray<FField> Fields;
+
+		// Key is the raw UTF-8 name from the body
+		const FField* Find(const uint8* Key, int32 Length) const;
+	};
+
+	class FParser;
+
+	static EFieldKind GetFieldKind(const FProperty* Property);
+	static const FStructPlan& GetPlan(const UScriptStruct* Struct);
+
+	static FCriticalSection PlansLock;
+	static TMap<const UScriptStruct*, TUniquePtr<FStructPlan>> Plans;
+};
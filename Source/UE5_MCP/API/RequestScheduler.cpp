@@ -0,0 +1,259 @@
+﻿#include "RequestScheduler.h"
+
+#include "HttpServerResponse.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarReadMaxInFlight(
+	TEXT("UE5_MCP.Read.MaxInFlight"), 32,
+	TEXT("Read requests that may be running or waiting on a worker at once."));
+static TAutoConsoleVariable<int32> CVarReadMaxQueue(
+	TEXT("UE5_MCP.Read.MaxQueue"), 256,
+	TEXT("Read requests that may wait for a slot before new ones are answered with 429."));
+static TAutoConsoleVariable<float> CVarReadFrameBudgetMs(
+	TEXT("UE5_MCP.Read.FrameBudgetMs"), 8.f,
+	TEXT("Game thread time per frame spent starting queued read requests. At least one starts every frame."));
+
+static TAutoConsoleVariable<int32> CVarLightWriteMaxInFlight(
+	TEXT("UE5_MCP.LightWrite.MaxInFlight"), 8,
+	TEXT("Graph edit requests that may be running at once."));
+static TAutoConsoleVariable<int32> CVarLightWriteMaxQueue(
+	TEXT("UE5_MCP.LightWrite.MaxQueue"), 64,
+	TEXT("Graph edit requests that may wait for a slot before new ones are answered with 429."));
+static TAutoConsoleVariable<float> CVarLightWriteFrameBudgetMs(
+	TEXT("UE5_MCP.LightWrite.FrameBudgetMs"), 8.f,
+	TEXT("Game thread time per frame spent running queued graph edit requests. At least one runs every frame."));
+
+static TAutoConsoleVariable<int32> CVarCompileWriteMaxInFlight(
+	TEXT("UE5_MCP.CompileWrite.MaxInFlight"), 1,
+	TEXT("Compiling edit requests that may be running at once."));
+static TAutoConsoleVariable<int32> CVarCompileWriteMaxQueue(
+	TEXT("UE5_MCP.CompileWrite.MaxQueue"), 16,
+	TEXT("Compiling edit requests that may wait for a slot before new ones are answered with 429."));
+static TAutoConsoleVariable<float> CVarCompileWriteFrameBudgetMs(
+	TEXT("UE5_MCP.CompileWrite.FrameBudgetMs"), 16.f,
+	TEXT("Game thread time per frame spent running queued compiling edit requests. At least one runs every frame."));
+
+RequestScheduler::FLane RequestScheduler::Lanes[static_cast<int32>(ERequestLane::Num)];
+FTSTicker::FDelegateHandle RequestScheduler::TickerHandle;
+
+void RequestScheduler::Initialize()
+{
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&RequestScheduler::Tick));
+}
+
+void RequestScheduler::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	for (FLane& Lane : Lanes)
+	{
+		Lane.Queue.Empty();
+	}
+}
+
+const TCHAR* RequestScheduler::GetLaneName(ERequestLane Lane)
+{
+	switch (Lane)
+	{
+	case ERequestLane::Read:
+		return TEXT("read");
+	case ERequestLane::LightWrite:
+		return TEXT("light_write");
+	case ERequestLane::CompileWrite:
+		return TEXT("compile_write");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+RequestScheduler::FLaneStats RequestScheduler::GetStats(ERequestLane Lane)
+{
+	const FLane& State = Lanes[static_cast<int32>(Lane)];
+	FLaneStats Stats = State.Stats;
+	Stats.Depth = State.Queue.Num();
+	Stats.InFlight = State.InFlight;
+	return Stats;
+}
+
+FString RequestScheduler::ToPrometheusText()
+{
+	TStringBuilder<2048> Out;
+	auto WriteLaneValues = [&Out](const TCHAR* Name, const TCHAR* Type, const TCHAR* Help, TFunctionRef<FString(const FLaneStats&)> Value)
+	{
+		Out.Appendf(TEXT("# HELP ue5_mcp_%s %s\n# TYPE ue5_mcp_%s %s\n"), Name, Help, Name, Type);
+		for (int32 LaneIndex = 0; LaneIndex < static_cast<int32>(ERequestLane::Num); ++LaneIndex)
+		{
+			const ERequestLane Lane = static_cast<ERequestLane>(LaneIndex);
+			Out.Appendf(TEXT("ue5_mcp_%s{lane=\"%s\"} %s\n"), Name, GetLaneName(Lane), *Value(GetStats(Lane)));
+		}
+	};
+
+	WriteLaneValues(TEXT("queue_depth"), TEXT("gauge"), TEXT("Requests waiting for admission, by lane."),
+		[](const FLaneStats& Stats) { return FString::FromInt(Stats.Depth); });
+	WriteLaneValues(TEXT("queue_in_flight"), TEXT("gauge"), TEXT("Admitted requests not answered yet, by lane."),
+		[](const FLaneStats& Stats) { return FString::FromInt(Stats.InFlight); });
+	WriteLaneValues(TEXT("queue_admitted_total"), TEXT("counter"), TEXT("Requests admitted, by lane."),
+		[](const FLaneStats& Stats) { return LexToString(Stats.Admitted); });
+	WriteLaneValues(TEXT("queue_queued_total"), TEXT("counter"), TEXT("Requests that had to wait for admission, by lane."),
+		[](const FLaneStats& Stats) { return LexToString(Stats.Queued); });
+	WriteLaneValues(TEXT("queue_rejected_total"), TEXT("counter"), TEXT("Requests answered with 429 because the lane queue was full."),
+		[](const FLaneStats& Stats) { return LexToString(Stats.Rejected); });
+	WriteLaneValues(TEXT("queue_wait_seconds_total"), TEXT("counter"), TEXT("Time admitted requests spent waiting, by lane."),
+		[](const FLaneStats& Stats) { return FString::Printf(TEXT("%f"), Stats.WaitSeconds); });
+	return FString(Out.ToView());
+}
+
+void RequestScheduler::WriteJson(TJsonWriter<>& Writer)
+{
+	Writer.WriteObjectStart(TEXT("Lanes"));
+	for (int32 LaneIndex = 0; LaneIndex < static_cast<int32>(ERequestLane::Num); ++LaneIndex)
+	{
+		const ERequestLane Lane = static_cast<ERequestLane>(LaneIndex);
+		const FLaneStats Stats = GetStats(Lane);
+		Writer.WriteObjectStart(GetLaneName(Lane));
+		Writer.WriteValue(TEXT("Depth"), Stats.Depth);
+		Writer.WriteValue(TEXT("InFlight"), Stats.InFlight);
+		Writer.WriteValue(TEXT("MaxInFlight"), GetMaxInFlight(Lane));
+		Writer.WriteValue(TEXT("MaxQueue"), GetMaxQueue(Lane));
+		Writer.WriteValue(TEXT("Admitted"), static_cast<int64>(Stats.Admitted));
+		Writer.WriteValue(TEXT("Queued"), static_cast<int64>(Stats.Queued));
+		Writer.WriteValue(TEXT("Rejected"), static_cast<int64>(Stats.Rejected));
+		Writer.WriteValue(TEXT("MeanWaitMs"), Stats.Admitted > 0 ? Stats.WaitSeconds / Stats.Admitted * 1000.0 : 0.0);
+		Writer.WriteValue(TEXT("MaxWaitMs"), Stats.MaxWaitSeconds * 1000.0);
+		Writer.WriteObjectEnd();
+	}
+	Writer.WriteObjectEnd();
+}
+
+int32 RequestScheduler::GetMaxInFlight(ERequestLane Lane)
+{
+	switch (Lane)
+	{
+	case ERequestLane::Read:
+		return FMath::Max(1, CVarReadMaxInFlight.GetValueOnGameThread());
+	case ERequestLane::LightWrite:
+		return FMath::Max(1, CVarLightWriteMaxInFlight.GetValueOnGameThread());
+	default:
+		return FMath::Max(1, CVarCompileWriteMaxInFlight.GetValueOnGameThread());
+	}
+}
+
+int32 RequestScheduler::GetMaxQueue(ERequestLane Lane)
+{
+	switch (Lane)
+	{
+	case ERequestLane::Read:
+		return FMath::Max(0, CVarReadMaxQueue.GetValueOnGameThread());
+	case ERequestLane::LightWrite:
+		return FMath::Max(0, CVarLightWriteMaxQueue.GetValueOnGameThread());
+	default:
+		return FMath::Max(0, CVarCompileWriteMaxQueue.GetValueOnGameThread());
+	}
+}
+
+double RequestScheduler::GetFrameBudgetSeconds(ERequestLane Lane)
+{
+	switch (Lane)
+	{
+	case ERequestLane::Read:
+		return CVarReadFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+	case ERequestLane::LightWrite:
+		return CVarLightWriteFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+	default:
+		return CVarCompileWriteFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+	}
+}
+
+bool RequestScheduler::HasCapacity(ERequestLane Lane)
+{
+	const FLane& State = Lanes[static_cast<int32>(Lane)];
+	return State.InFlight < GetMaxInFlight(Lane) && State.SpentThisFrame < GetFrameBudgetSeconds(Lane);
+}
+
+void RequestScheduler::Submit(ERequestLane Lane, const FHttpServerRequest& Req, const TSharedRef<Metrics::FRequest>& Request,
+	const FHttpResultCallback& OnComplete, FRun&& Run)
+{
+	check(IsInGameThread());
+	FLane& State = Lanes[static_cast<int32>(Lane)];
+
+	// Requests already waiting go first, a new one only skips the queue when it is empty
+	if (State.Queue.Num() == 0 && HasCapacity(Lane))
+	{
+		Start(Lane, Req, Request, OnComplete, Run, 0.0, 0);
+		return;
+	}
+
+	const int32 Depth = State.Queue.Num();
+	if (Depth >= GetMaxQueue(Lane))
+	{
+		++State.Stats.Rejected;
+		// Roughly how long the queue ahead takes to drain
+		const int32 RetryAfter = FMath::Max(1, FMath::CeilToInt(
+			Depth * State.AverageServiceSeconds / GetMaxInFlight(Lane)));
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: Too many %s requests queued (%d), retry after %d s"), GetLaneName(Lane), Depth, RetryAfter),
+			TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::TooManyRequests;
+		Resp->Headers.Add(TEXT("Retry-After"), { FString::FromInt(RetryAfter) });
+		Resp->Headers.Add(TEXT("X-MCP-Queue-Lane"), { GetLaneName(Lane) });
+		Resp->Headers.Add(TEXT("X-MCP-Queue-Depth"), { FString::FromInt(Depth) });
+		OnComplete(MoveTemp(Resp));
+		return;
+	}
+
+	// The server's request only lives for the handler call, a queued one needs its own copy
+	++State.Stats.Queued;
+	State.Queue.Add({ MakeShared<FHttpServerRequest>(Req), Request, OnComplete, MoveTemp(Run), FPlatformTime::Seconds(), Depth + 1 });
+}
+
+void RequestScheduler::Start(ERequestLane Lane, const FHttpServerRequest& Req, const TSharedRef<Metrics::FRequest>& Request,
+	const FHttpResultCallback& OnComplete, FRun& Run, double WaitSeconds, int32 Depth)
+{
+	FLane& State = Lanes[static_cast<int32>(Lane)];
+	++State.InFlight;
+	++State.Stats.Admitted;
+	State.Stats.WaitSeconds += WaitSeconds;
+	State.Stats.MaxWaitSeconds = FMath::Max(State.Stats.MaxWaitSeconds, WaitSeconds);
+	if (WaitSeconds > 0.0)
+		Metrics::AddPhaseTime(Request, EMetricPhase::Queue, WaitSeconds);
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	// The slot is held until the response is handed back, which may be after the handler returns
+	Run(Req, [Lane, OnComplete, WaitSeconds, Depth, StartSeconds](TUniquePtr<FHttpServerResponse>&& Resp)
+	{
+		FLane& State = Lanes[static_cast<int32>(Lane)];
+		State.InFlight = FMath::Max(0, State.InFlight - 1);
+		const double ServiceSeconds = FPlatformTime::Seconds() - StartSeconds;
+		State.AverageServiceSeconds = State.AverageServiceSeconds == 0.0
+			? ServiceSeconds
+			: State.AverageServiceSeconds * 0.9 + ServiceSeconds * 0.1;
+
+		Resp->Headers.Add(TEXT("X-MCP-Queue-Lane"), { GetLaneName(Lane) });
+		Resp->Headers.Add(TEXT("X-MCP-Queue-Depth"), { FString::FromInt(Depth) });
+		Resp->Headers.Add(TEXT("X-MCP-Queue-Wait-Ms"), { FString::Printf(TEXT("%.1f"), WaitSeconds * 1000.0) });
+		OnComplete(MoveTemp(Resp));
+	});
+	State.SpentThisFrame += FPlatformTime::Seconds() - StartSeconds;
+}
+
+bool RequestScheduler::Tick(float DeltaTime)
+{
+	// Cheapest lane first, a compile that overruns its budget delays the next frame, not the reads in this one
+	for (int32 LaneIndex = 0; LaneIndex < static_cast<int32>(ERequestLane::Num); ++LaneIndex)
+	{
+		const ERequestLane Lane = static_cast<ERequestLane>(LaneIndex);
+		FLane& State = Lanes[LaneIndex];
+		State.SpentThisFrame = 0.0;
+
+		bool bStartedAny = false;
+		while (State.Queue.Num() > 0 && State.InFlight < GetMaxInFlight(Lane)
+			&& (!bStartedAny || State.SpentThisFrame < GetFrameBudgetSeconds(Lane)))
+		{
+			FPending Pending = MoveTemp(State.Queue[0]);
+			State.Queue.RemoveAt(0);
+			Start(Lane, *Pending.Req, Pending.Request, Pending.OnComplete, Pending.Run,
+				FPlatformTime::Seconds() - Pending.EnqueuedSeconds, Pending.DepthAtAdmission);
+			bStartedAny = true;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,80 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "HttpResultCallback.h"
+#include "HttpServerRequest.h"
+#include "UE5_MCP/Core/Metrics.h"
+
+enum class ERequestLane : uint8
+{
+	Read,
+	LightWrite, // graph edits that don't compile
+	CompileWrite, // edits that compile the Blueprint before answering
+	Num
+};
+
+// Admission control in front of the route handlers
+// Each lane has its own queue, in-flight limit and per-frame time budget, set with the UE5_MCP.<Lane>.* console variables
+// A request runs at once while its lane has room, waits in the lane queue otherwise, and gets 429 with Retry-After
+// when the queue is full. Queues drain once per tick, reads first, so compiles can't starve them
+class RequestScheduler
+{
+public:
+	using FRun = TUniqueFunction<void(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)>;
+
+	struct FLaneStats
+	{
+		int32 Depth = 0;
+		int32 InFlight = 0;
+		uint64 Admitted = 0;
+		uint64 Queued = 0;
+		uint64 Rejected = 0;
+		double WaitSeconds = 0.0; // total time admitted requests spent queued
+		double MaxWaitSeconds = 0.0;
+	};
+
+	static void Initialize();
+	static void Shutdown();
+
+	static void Submit(ERequestLane Lane, const FHttpServerRequest& Req, const TSharedRef<Metrics::FRequest>& Request,
+	                   const FHttpResultCallback& OnComplete, FRun&& Run);
+
+	static const TCHAR* GetLaneName(ERequestLane Lane);
+
+	static FLaneStats GetStats(ERequestLane Lane);
+
+	static FString ToPrometheusText();
+	static void WriteJson(TJsonWriter<>& Writer);
+
+private:
+	struct FPending
+	{
+		TSharedRef<FHttpServerRequest> Req;
+		TSharedRef<Metrics::FRequest> Request;
+		FHttpResultCallback OnComplete;
+		FRun Run;
+		double EnqueuedSeconds;
+		int32 DepthAtAdmission;
+	};
+
+	struct FLane
+	{
+		TArray<FPending> Queue; // FIFO, drained from the front
+		int32 InFlight = 0;
+		double SpentThisFrame = 0.0;
+		double AverageServiceSeconds = 0.0;
+		FLaneStats Stats;
+	};
+
+	static bool Tick(float DeltaTime);
+	static bool HasCapacity(ERequestLane Lane);
+	static void Start(ERequestLane Lane, const FHttpServerRequest& Req, const TSharedRef<Metrics::FRequest>& Request,
+	                  const FHttpResultCallback& OnComplete, FRun& Run, double WaitSeconds, int32 Depth);
+
+	static int32 GetMaxInFlight(ERequestLane Lane);
+	static int32 GetMaxQueue(ERequestLane Lane);
+	static double GetFrameBudgetSeconds(ERequestLane Lane);
+
+	static FLane Lanes[static_cast<int32>(ERequestLane::Num)];
+	static FTSTicker::FDelegateHandle TickerHandle;
+};
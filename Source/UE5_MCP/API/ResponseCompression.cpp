@@ -0,0 +1,90 @@
+﻿#include "ResponseCompression.h"
+
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
+#include "UE5_MCP/Core/JsonBuffer.h"
+
+static TAutoConsoleVariable<int32> CVarCompressionThreshold(
+	TEXT("UE5_MCP.CompressionThreshold"),
+	64 * 1024,
+	TEXT("Response bodies of at least this many bytes are compressed when the client accepts gzip or deflate. 0 disables compression."));
+
+FName ResponseCompression::NegotiateFormat(const FHttpServerRequest& Request)
+{
+	const TArray<FString>* AcceptEncoding = Request.Headers.Find(TEXT("Accept-Encoding"));
+	if (!AcceptEncoding)
+		return NAME_None;
+
+	bool bAcceptsGzip = false;
+	bool bAcceptsDeflate = false;
+	for (const FString& HeaderValue : *AcceptEncoding)
+	{
+		TArray<FString> Codings;
+		HeaderValue.ParseIntoArray(Codings, TEXT(","));
+		for (const FString& Coding : Codings)
+		{
+			// "gzip;q=0" explicitly refuses the coding
+			FString Name = Coding;
+			FString Params;
+			Coding.Split(TEXT(";"), &Name, &Params);
+			Name.TrimStartAndEndInline();
+			Params.ReplaceInline(TEXT(" "), TEXT(""));
+			if (Params.StartsWith(TEXT("q=")) && FCString::Atof(*Params.Mid(2)) <= 0.f)
+				continue;
+
+			if (Name.Equals(TEXT("gzip")))
+				bAcceptsGzip = true;
+			else if (Name.Equals(TEXT("deflate")))
+				bAcceptsDeflate = true;
+		}
+	}
+
+	if (bAcceptsGzip)
+		return NAME_Gzip;
+	if (bAcceptsDeflate)
+		return NAME_Zlib;
+	return NAME_None;
+}
+
+bool ResponseCompression::ShouldCompress(const FHttpServerResponse& Response, FName Format)
+{
+	const int32 Threshold = CVarCompressionThreshold.GetValueOnAnyThread();
+	return !Format.IsNone()
+		&& Threshold > 0
+		&& Response.Body.Num() >= Threshold
+		&& !Response.Headers.Contains(TEXT("Content-Encoding"));
+}
+
+void ResponseCompression::CompressAsync(TUniquePtr<FHttpServerResponse>&& Response, FName Format, FOnCompressed&& OnCompressed)
+{
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask,
+		[Response = MoveTemp(Response), Format, OnCompressed = MoveTemp(OnCompressed)]() mutable
+		{
+			const double StartSeconds = FPlatformTime::Seconds();
+
+			const int32 UncompressedSize = Response->Body.Num();
+			int32 CompressedSize = FCompression::CompressMemoryBound(Format, UncompressedSize);
+			TArray<uint8> Compressed = JsonBuffer::Acquire();
+			Compressed.SetNumUninitialized(CompressedSize);
+
+			if (FCompression::CompressMemory(Format, Compressed.GetData(), CompressedSize, Response->Body.GetData(), UncompressedSize)
+				&& CompressedSize < UncompressedSize)
+			{
+				Compressed.SetNumUninitialized(CompressedSize);
+				Swap(Response->Body, Compressed);
+				Response->Headers.Add(TEXT("Content-Encoding"), { Format == NAME_Gzip ? TEXT("gzip") : TEXT("deflate") });
+			}
+			// Whichever buffer lost is scratch now
+			JsonBuffer::Recycle(MoveTemp(Compressed));
+
+			Response->Headers.Add(TEXT("Vary"), { TEXT("Accept-Encoding") });
+			const double CompressSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+			AsyncTask(ENamedThreads::GameThread,
+				[Response = MoveTemp(Response), OnCompressed = MoveTemp(OnCompressed), CompressSeconds]() mutable
+				{
+					OnCompressed(MoveTemp(Response), CompressSeconds);
+				});
+		});
+}
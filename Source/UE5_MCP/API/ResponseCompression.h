@@ -0,0 +1,21 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+
+// gzip / deflate encoding of large response bodies, negotiated from Accept-Encoding
+// Bodies below the UE5_MCP.CompressionThreshold console variable are sent as is
+class ResponseCompression
+{
+public:
+	using FOnCompressed = TUniqueFunction<void(TUniquePtr<FHttpServerResponse>&& Response, double CompressSeconds)>;
+
+	// Returns NAME_Gzip or NAME_Zlib when the client accepts one of them, NAME_None otherwise
+	static FName NegotiateFormat(const FHttpServerRequest& Request);
+
+	static bool ShouldCompress(const FHttpServerResponse& Response, FName Format);
+
+	// Compresses the body on a worker thread, OnCompressed is called back on the game thread
+	// The body is sent uncompressed if compression fails or doesn't make it smaller
+	static void CompressAsync(TUniquePtr<FHttpServerResponse>&& Response, FName Format, FOnCompressed&& OnCompressed);
+};
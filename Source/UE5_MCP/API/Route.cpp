@@ -5,153 +5,334 @@
 #include "Route/BP.h"
 #include "Route/Function.h"
 #include "Route/Graph.h"
+#include "RequestScheduler.h"
+#include "ResponseCompression.h"
+#include "Route/Server.h"
+#include "UE5_MCP/Core/GraphUtils.h"
+#include "UE5_MCP/Core/MCPTrace.h"
+#include "UE5_MCP/Core/Metrics.h"
 
 
+TMap<FString, Router::FRoute> Router::Routes;
+
+void Router::BindRoute(TSharedPtr<IHttpRouter> Router, const FString& Path, EHttpServerRequestVerbs Verbs,
+	ERequestLane Lane, FRouteHandler Handler)
+{
+	Routes.Add(Path, { Verbs, Lane, Handler });
+	Router->BindRoute(FHttpPath(Path), Verbs,
+		FHttpRequestHandler::CreateLambda([Path, Lane, Handler](const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+		{
+			return HandleRequest(Path, Lane, Handler, Req, OnComplete);
+		}));
+}
+
+bool Router::HandleRequest(const FString& Path, ERequestLane Lane, FRouteHandler Handler,
+	const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	// Clients can pass their own X-Request-Id to find the request in Unreal Insights
+	const TArray<FString>* RequestIdHeader = Req.Headers.Find(TEXT("X-Request-Id"));
+	TSharedRef<Metrics::FRequest> Request = Metrics::BeginRequest(Path,
+		RequestIdHeader && RequestIdHeader->Num() > 0 ? (*RequestIdHeader)[0] : FString());
+	const FName CompressionFormat = ResponseCompression::NegotiateFormat(Req);
+
+	FHttpResultCallback Complete = [Request, OnComplete, CompressionFormat](TUniquePtr<FHttpServerResponse>&& Resp)
+	{
+		Resp->Headers.Add(TEXT("X-Request-Id"), { Request->Id });
+		if (ResponseCompression::ShouldCompress(*Resp, CompressionFormat))
+		{
+			ResponseCompression::CompressAsync(MoveTemp(Resp), CompressionFormat,
+				[Request, OnComplete](TUniquePtr<FHttpServerResponse>&& Compressed, double CompressSeconds)
+				{
+					Metrics::AddPhaseTime(Request, EMetricPhase::Compress, CompressSeconds);
+					Metrics::EndRequest(Request, static_cast<int32>(Compressed->Code));
+					OnComplete(MoveTemp(Compressed));
+				});
+			return;
+		}
+		Metrics::EndRequest(Request, static_cast<int32>(Resp->Code));
+		OnComplete(MoveTemp(Resp));
+	};
+
+	// The handler may run now or on a later tick, once its lane admits it
+	RequestScheduler::Submit(Lane, Req, Request, Complete,
+		[Path, Handler, Request](const FHttpServerRequest& AdmittedReq, const FHttpResultCallback& OnAdmittedComplete)
+		{
+			Metrics::FScopedCurrentRequest CurrentRequest(Request);
+			TRACE_BOOKMARK(TEXT("MCP %s [%s]"), *Path, *Request->Id);
+			TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(*Path, UE5_MCPChannel);
+			// Graph edits made by the handler notify the editor once, when it returns
+			GraphUtils::FScopedBatchEdit GraphBatch;
+			Handler(AdmittedReq, OnAdmittedComplete);
+		});
+	return true;
+}
+
+void Router::Dispatch(const FString& Path, const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	const FRoute* Route = Routes.Find(Path);
+	if (!Route || !EnumHasAnyFlags(Route->Verbs, Req.Verb))
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s %s"), Route ? TEXT("Method not allowed on") : TEXT("No route for"), *Path),
+			TEXT("text/plain"));
+		Resp->Code = Route ? EHttpServerResponseCodes::BadMethod : EHttpServerResponseCodes::NotFound;
+		OnComplete(MoveTemp(Resp));
+		return;
+	}
+
+	HandleRequest(Path, Route->Lane, Route->Handler, Req, OnComplete);
+}
+
 void Router::Bind(TSharedPtr<IHttpRouter> Router)
 {
-	Router->BindRoute(FHttpPath("/create_bp"),
+	BindRoute(Router, TEXT("/create_bp"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::CompileWrite,
+		CreateBPHandler);
+
+	BindRoute(Router, TEXT("/create_function"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::CompileWrite,
+		CreateFunctionHandler);
+
+	BindRoute(Router, TEXT("/edit_function"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(CreateBPHandler));
+		ERequestLane::CompileWrite,
+		EditFunctionHandler);
 
-	Router->BindRoute(FHttpPath("/create_function"),
+	BindRoute(Router, TEXT("/delete_function"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(CreateFunctionHandler));
+		ERequestLane::CompileWrite,
+		DeleteFunctionHandler);
 
-	Router->BindRoute(FHttpPath("/edit_function"),
+	BindRoute(Router, TEXT("/add_function_call_to_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(EditFunctionHandler));
+		ERequestLane::LightWrite,
+		AddFunctionCallToGraphHandler);
+
+	BindRoute(Router, TEXT("/add_event_to_graph"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::LightWrite,
+		AddEventToGraphHandler);
+
+	BindRoute(Router, TEXT("/add_variable_to_graph"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::LightWrite,
+		AddVariableToGraphHandler);
+
+	BindRoute(Router, TEXT("/get_blueprint_variables"),
+		EHttpServerRequestVerbs::VERB_GET,
+		ERequestLane::Read,
+		GetBPVariablesHandler);
+
+	BindRoute(Router, TEXT("/get_blueprint_functions"),
+		EHttpServerRequestVerbs::VERB_GET,
+		ERequestLane::Read,
+		GetBPFunctionHandler);
 
-	Router->BindRoute(FHttpPath("/delete_function"),
+	BindRoute(Router, TEXT("/get_graph"),
+		EHttpServerRequestVerbs::VERB_GET,
+		ERequestLane::Read,
+		GetGraphHandler);
+
+	BindRoute(Router, TEXT("/get_blueprint_snapshot"),
+		EHttpServerRequestVerbs::VERB_GET,
+		ERequestLane::Read,
+		GetBlueprintSnapshotHandler);
+
+	BindRoute(Router, TEXT("/query_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(DeleteFunctionHandler));
+		ERequestLane::Read,
+		QueryGraphHandler);
 
-	Router->BindRoute(FHttpPath("/add_function_call_to_graph"),
-        EHttpServerRequestVerbs::VERB_POST,
-        FHttpRequestHandler::CreateStatic(AddFunctionCallToGraphHandler));
+	BindRoute(Router, TEXT("/prefetch"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::Read,
+		PrefetchHandler);
 
-	Router->BindRoute(FHttpPath("/add_event_to_graph"),
-        EHttpServerRequestVerbs::VERB_POST,
-        FHttpRequestHandler::CreateStatic(AddEventToGraphHandler));
+	BindRoute(Router, TEXT("/list_blueprints"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::Read,
+		ListBlueprintsHandler);
 
-	Router->BindRoute(FHttpPath("/add_variable_to_graph"),
-        EHttpServerRequestVerbs::VERB_POST,
-        FHttpRequestHandler::CreateStatic(AddVariableToGraphHandler));
+	BindRoute(Router, TEXT("/search_usages"),
+		EHttpServerRequestVerbs::VERB_GET,
+		ERequestLane::Read,
+		SearchUsagesHandler);
 
-	Router->BindRoute(FHttpPath("/get_blueprint_variables"),
-        EHttpServerRequestVerbs::VERB_GET,
-        FHttpRequestHandler::CreateStatic(GetBPVariablesHandler));
+	BindRoute(Router, TEXT("/analyze_impact"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::Read,
+		AnalyzeImpactHandler);
 
-	Router->BindRoute(FHttpPath("/get_blueprint_functions"),
-        EHttpServerRequestVerbs::VERB_GET,
-        FHttpRequestHandler::CreateStatic(GetBPFunctionHandler));
+	BindRoute(Router, TEXT("/lint"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::Read,
+		LintHandler);
 
-	Router->BindRoute(FHttpPath("/get_graph"),
-        EHttpServerRequestVerbs::VERB_GET,
-        FHttpRequestHandler::CreateStatic(GetGraphHandler));
+	BindRoute(Router, TEXT("/compile_blueprint"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::CompileWrite,
+		CompileBPHandler);
 
-	Router->BindRoute(FHttpPath("/compile_blueprint"),
+	BindRoute(Router, TEXT("/compile_blueprints"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(CompileBPHandler));
+		ERequestLane::CompileWrite,
+		CompileBlueprintsHandler);
+
+	BindRoute(Router, TEXT("/get_supported_nodes"),
+		EHttpServerRequestVerbs::VERB_GET,
+		ERequestLane::Read,
+		GetSupportedNodesHandler);
 
-	Router->BindRoute(FHttpPath("/get_supported_nodes"),
+	BindRoute(Router, TEXT("/describe_node"),
 		EHttpServerRequestVerbs::VERB_GET,
-		FHttpRequestHandler::CreateStatic(GetSupportedNodesHandler));
+		ERequestLane::Read,
+		DescribeNodeHandler);
+
+	BindRoute(Router, TEXT("/search_actions"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::Read,
+		SearchActionsHandler);
 
-	Router->BindRoute(FHttpPath("/add_variable_to_bp"),
+	BindRoute(Router, TEXT("/add_variable_to_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddVariableToBPHandler));
+		ERequestLane::CompileWrite,
+		AddVariableToBPHandler);
 
-	Router->BindRoute(FHttpPath("/rename_variable_in_bp"),
+	BindRoute(Router, TEXT("/rename_variable_in_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(RenameVariableInBPHandler));
+		ERequestLane::CompileWrite,
+		RenameVariableInBPHandler);
 
-	Router->BindRoute(FHttpPath("/delete_variable_from_bp"),
+	BindRoute(Router, TEXT("/delete_variable_from_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(DeleteVariableFromBPHandler));
+		ERequestLane::CompileWrite,
+		DeleteVariableFromBPHandler);
 
-	Router->BindRoute(FHttpPath("/set_variable_default_value_in_bp"),
+	BindRoute(Router, TEXT("/set_variable_default_value_in_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(SetVariableDefaultValueInBPHandler));
+		ERequestLane::CompileWrite,
+		SetVariableDefaultValueInBPHandler);
 
-	Router->BindRoute(FHttpPath("/connect_pins"),
+	BindRoute(Router, TEXT("/apply_blueprint_schema"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(ConnectPinsHandler));
+		ERequestLane::CompileWrite,
+		ApplyBlueprintSchemaHandler);
 
-	Router->BindRoute(FHttpPath("/break_pin_connection"),
+	BindRoute(Router, TEXT("/connect_pins"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(BreakPinConnectionHandler));
+		ERequestLane::LightWrite,
+		ConnectPinsHandler);
 
-	Router->BindRoute(FHttpPath("/set_pin_default_value"),
+	BindRoute(Router, TEXT("/check_pin_connections"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(SetPinDefaultValueHandler));
+		ERequestLane::Read,
+		CheckPinConnectionsHandler);
 
-	Router->BindRoute(FHttpPath("/add_generic_node_to_graph"),
+	BindRoute(Router, TEXT("/break_pin_connection"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddGenericNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		BreakPinConnectionHandler);
 
-	Router->BindRoute(FHttpPath("/add_make_struct_node_to_graph"),
+	BindRoute(Router, TEXT("/set_pin_default_value"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddMakeStructNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		SetPinDefaultValueHandler);
 
-	Router->BindRoute(FHttpPath("/add_break_struct_node_to_graph"),
+	BindRoute(Router, TEXT("/apply_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddBreakStructNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		ApplyGraphHandler);
+
+	BindRoute(Router, TEXT("/add_generic_node_to_graph"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::LightWrite,
+		AddGenericNodeToGraphHandler);
+
+	BindRoute(Router, TEXT("/add_make_struct_node_to_graph"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::LightWrite,
+		AddMakeStructNodeToGraphHandler);
+
+	BindRoute(Router, TEXT("/add_break_struct_node_to_graph"),
+		EHttpServerRequestVerbs::VERB_POST,
+		ERequestLane::LightWrite,
+		AddBreakStructNodeToGraphHandler);
 
 	/*
-	Router->BindRoute(FHttpPath("/add_switch_enum_node_to_graph"),
+	BindRoute(Router, TEXT("/add_switch_enum_node_to_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddSwitchEnumNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		AddSwitchEnumNodeToGraphHandler);
 		*/
 
-	Router->BindRoute(FHttpPath("/add_dynamic_cast_node_to_graph"),
+	BindRoute(Router, TEXT("/add_dynamic_cast_node_to_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddDynamicCastNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		AddDynamicCastNodeToGraphHandler);
 
-	Router->BindRoute(FHttpPath("/add_class_cast_node_to_graph"),
+	BindRoute(Router, TEXT("/add_class_cast_node_to_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddClassCastNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		AddClassCastNodeToGraphHandler);
 
-	Router->BindRoute(FHttpPath("/add_enum_cast_node_to_graph"),
+	BindRoute(Router, TEXT("/add_enum_cast_node_to_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddEnumCastNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		AddEnumCastNodeToGraphHandler);
 
 	
-	Router->BindRoute(FHttpPath("/add_math_node_to_graph"),
+	BindRoute(Router, TEXT("/add_math_node_to_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddMathNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		AddMathNodeToGraphHandler);
 
 	/*
-	Router->BindRoute(FHttpPath("/add_comment_node_to_graph"),
+	BindRoute(Router, TEXT("/add_comment_node_to_graph"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddCommentNodeToGraphHandler));
+		ERequestLane::LightWrite,
+		AddCommentNodeToGraphHandler);
 		*/
 
-	Router->BindRoute(FHttpPath("/add_component_to_bp"),
+	BindRoute(Router, TEXT("/add_component_to_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(AddComponentToBPHandler));
+		ERequestLane::CompileWrite,
+		AddComponentToBPHandler);
 
-	Router->BindRoute(FHttpPath("/get_components_of_bp"),
+	BindRoute(Router, TEXT("/get_components_of_bp"),
 		EHttpServerRequestVerbs::VERB_GET,
-		FHttpRequestHandler::CreateStatic(GetComponentsOfBPHandler));
+		ERequestLane::Read,
+		GetComponentsOfBPHandler);
 
-	Router->BindRoute(FHttpPath("/remove_component_from_bp"),
+	BindRoute(Router, TEXT("/remove_component_from_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(RemoveComponentFromBPHandler));
+		ERequestLane::CompileWrite,
+		RemoveComponentFromBPHandler);
 
-	Router->BindRoute(FHttpPath("/rename_component_in_bp"),
+	BindRoute(Router, TEXT("/rename_component_in_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(RenameComponentInBPHandler));
+		ERequestLane::CompileWrite,
+		RenameComponentInBPHandler);
 
-	Router->BindRoute(FHttpPath("/reattach_component_in_bp"),
+	BindRoute(Router, TEXT("/reattach_component_in_bp"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(ReattachComponentInBPHandler));
+		ERequestLane::CompileWrite,
+		ReattachComponentInBPHandler);
 
-	Router->BindRoute(FHttpPath("/get_component_properties"),
+	BindRoute(Router, TEXT("/get_component_properties"),
 		EHttpServerRequestVerbs::VERB_GET,
-		FHttpRequestHandler::CreateStatic(GetComponentPropertiesHandler));
+		ERequestLane::Read,
+		GetComponentPropertiesHandler);
 
-	Router->BindRoute(FHttpPath("/set_component_property"),
+	BindRoute(Router, TEXT("/set_component_property"),
 		EHttpServerRequestVerbs::VERB_POST,
-		FHttpRequestHandler::CreateStatic(SetComponentPropertyHandler));
+		ERequestLane::CompileWrite,
+		SetComponentPropertyHandler);
+
+	BindRoute(Router, TEXT("/metrics"),
+		EHttpServerRequestVerbs::VERB_GET,
+		ERequestLane::Read,
+		GetMetricsHandler);
 
 }
@@ -1,9 +1,36 @@
 ﻿#pragma once
+#include "HttpResultCallback.h"
+#include "HttpServerRequest.h"
+#include "RequestScheduler.h"
 
 class IHttpRouter;
 
 class Router
 {
+	using FRouteHandler = bool (*)(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+	struct FRoute
+	{
+		EHttpServerRequestVerbs Verbs;
+		ERequestLane Lane;
+		FRouteHandler Handler;
+	};
+
+	// Every bound route by path, so requests that don't come through the HTTP router reach the same handlers
+	static TMap<FString, FRoute> Routes;
+
+	// Binds a handler to a path, recording per-route metrics around it
+	// Lane is the scheduler queue the route waits in: reads, graph edits, or edits that compile
+	static void BindRoute(TSharedPtr<IHttpRouter> Router, const FString& Path, EHttpServerRequestVerbs Verbs,
+	                      ERequestLane Lane, FRouteHandler Handler);
+
+	// Runs a handler with admission control, metrics, tracing and response compression around it
+	static bool HandleRequest(const FString& Path, ERequestLane Lane, FRouteHandler Handler,
+	                          const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
 public:
 	static void Bind(TSharedPtr<IHttpRouter> Router);
+
+	// Dispatches a request to the handler bound to Path, completing with 404 or 405 when there is none
+	static void Dispatch(const FString& Path, const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 };
@@ -1,12 +1,28 @@
 ﻿#include "BP.h"
 
 #include "UE5_MCP/API/Utils.h"
+#include "UE5_MCP/API/DTO/AnalyzeImpactReq.h"
+#include "UE5_MCP/API/DTO/ApplyBlueprintSchemaReq.h"
 #include "UE5_MCP/API/DTO/BPComponentOperationReq.h"
 #include "UE5_MCP/API/DTO/BPComponentPropertySetReq.h"
 #include "UE5_MCP/API/DTO/BPVarOperationReq.h"
+#include "UE5_MCP/API/DTO/CompileBlueprintsReq.h"
 #include "UE5_MCP/API/DTO/CreateBPReq.h"
+#include "UE5_MCP/API/DTO/LintReq.h"
+#include "UE5_MCP/API/DTO/ListBlueprintsReq.h"
+#include "UE5_MCP/API/DTO/PrefetchReq.h"
+#include "UE5_MCP/API/DTO/QueryGraphReq.h"
+#include "UE5_MCP/Core/AssetLoadUtils.h"
+#include "UE5_MCP/Core/AssetQueryUtils.h"
 #include "UE5_MCP/Core/BPUtils.h"
 #include "UE5_MCP/Core/ClassUtils.h"
+#include "UE5_MCP/Core/CompileUtils.h"
+#include "UE5_MCP/Core/GraphQueryUtils.h"
+#include "UE5_MCP/Core/ImpactUtils.h"
+#include "UE5_MCP/Core/LintUtils.h"
+#include "UE5_MCP/Core/SchemaApplyUtils.h"
+#include "UE5_MCP/Core/SnapshotCache.h"
+#include "UE5_MCP/Core/UsageIndex.h"
 
 bool CreateBPHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
 {
@@ -37,18 +53,11 @@ bool GetBPFunctionHandler(const FHttpServerRequest& Req, const FHttpResultCallba
 		if (!BpPath)
 			throw std::runtime_error("Missing bp_path parameter");
 		
-		auto Blueprint = BPUtils::LoadBlueprint(*BpPath);
-
-		if (!Blueprint)
-			throw std::runtime_error("Failed to load Blueprint from path");
-		
-		auto Funcs = BPUtils::GetBlueprintFunctions(Blueprint);
+		FBlueprintSnapshotPtr Snapshot = SnapshotCache::Acquire(*BpPath);
+		if (!Snapshot->bCompiled)
+			throw std::runtime_error("Blueprint's GeneratedClass is null, please compile the Blueprint first");
 
-		FString Json = Utils::ToJsonString(Funcs);
-		
-		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(Json, TEXT("application/json"));
-		Resp->Code = EHttpServerResponseCodes::Ok;
-		OnComplete(MoveTemp(Resp));
+		Utils::JsonResponseAsync([Snapshot]() { return Utils::ToJson(Snapshot->Functions); }, OnComplete);
 		return true;
 	} catch (std::runtime_error& e)
 	{
@@ -69,6 +78,14 @@ bool GetBPVariablesHandler(const FHttpServerRequest& Req, const FHttpResultCallb
 		
 		if (!BpPath)
 			throw std::runtime_error("Missing bp_path parameter");
+
+		// Inherited variables come from the live generated class, the snapshot only has the Blueprint's own
+		if (!bIncludeAll)
+		{
+			FBlueprintSnapshotPtr Snapshot = SnapshotCache::Acquire(*BpPath);
+			Utils::JsonResponseAsync([Snapshot]() { return Utils::ToJson(Snapshot->Variables); }, OnComplete);
+			return true;
+		}
 		
 		auto Blueprint = BPUtils::LoadBlueprint(*BpPath);
 		if (!Blueprint)
@@ -76,9 +93,9 @@ bool GetBPVariablesHandler(const FHttpServerRequest& Req, const FHttpResultCallb
 		
 		auto Vars = BPUtils::GetBlueprintVariables(Blueprint, bIncludeAll);
 
-		FString Json = Utils::ToJsonString(Vars);
+		TArray<uint8> Json = Utils::ToJson(Vars);
 		
-		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(Json, TEXT("application/json"));
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(MoveTemp(Json));
 		Resp->Code = EHttpServerResponseCodes::Ok;
 		OnComplete(MoveTemp(Resp));
 		return true;
@@ -99,22 +116,37 @@ bool GetGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& O
 		auto graphName = Req.QueryParams.Find("graph_name");
 		if (!bpPath || !graphName)
 			throw std::runtime_error("Missing bp_path or graph_name parameter");
-		auto Blueprint = BPUtils::LoadBlueprint(*bpPath);
 
-		if (!Blueprint)
-			throw std::runtime_error("Failed to load Blueprint from path");
-		
-		auto Graph = BPUtils::GetEventGraph(Blueprint, *graphName);
-		
+		FBlueprintSnapshotPtr Snapshot = SnapshotCache::Acquire(*bpPath);
+		const FGraphSnapshot* Graph = SnapshotUtils::FindGraph(*Snapshot, *graphName, TEXT("Event"));
 		if (!Graph)
 			throw std::runtime_error("Graph not found");
-		
-		auto Json = BPUtils::GetBlueprintGraphJson(Graph);
-		
-		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(Json, TEXT("application/json"));
-		Resp->Code = EHttpServerResponseCodes::Ok;
+
+		Utils::JsonResponseAsync([Snapshot, Graph]() { return SnapshotUtils::EncodeGraph(*Graph); }, OnComplete);
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
 		OnComplete(MoveTemp(Resp));
 		return true;
+	}
+}
+
+bool GetBlueprintSnapshotHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try {
+		auto BpPath = Req.QueryParams.Find("bp_path");
+		if (!BpPath)
+			throw std::runtime_error("Missing bp_path parameter");
+
+		auto FieldList = Req.QueryParams.Find("fields");
+		ESnapshotFields Fields = SnapshotUtils::ParseFields(FieldList ? *FieldList : FString());
+
+		FBlueprintSnapshotPtr Snapshot = SnapshotCache::Acquire(*BpPath);
+		Utils::JsonResponseAsync([Snapshot, Fields]() { return SnapshotUtils::EncodeBlueprint(*Snapshot, Fields); }, OnComplete);
+		return true;
 	} catch (std::runtime_error& e)
 	{
 		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
@@ -152,6 +184,40 @@ bool CompileBPHandler(const FHttpServerRequest& Req, const FHttpResultCallback&
 	return true;
 }
 
+bool CompileBlueprintsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try
+	{
+		FCompileBlueprintsReq body = Utils::BufferToJson<FCompileBlueprintsReq>(Req.Body);
+		TArray<FString> Paths = body.BpPaths;
+		if (!body.PathPrefix.IsEmpty())
+		{
+			for (const FString& Path : CompileUtils::FindBlueprintsUnderPath(body.PathPrefix))
+			{
+				Paths.AddUnique(Path);
+			}
+		}
+		if (Paths.IsEmpty())
+			throw std::runtime_error("No Blueprints to compile");
+
+		CompileUtils::FOptions Options;
+		Options.bSkipGarbageCollection = body.bSkipGarbageCollection;
+		Options.bSkipSave = body.bSkipSave;
+		FBatchCompileReport Report = CompileUtils::CompileBlueprints(Paths, Options);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(CompileUtils::EncodeReport(Report));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
 bool AddVariableToBPHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
 {
 	try {
@@ -256,15 +322,12 @@ bool GetComponentsOfBPHandler(const FHttpServerRequest& Req, const FHttpResultCa
 		auto BpPath = Req.QueryParams.Find("bp_path");
 		if (!BpPath)
 			throw std::runtime_error("Missing bp_path parameter");
-		
-		auto Blueprint = BPUtils::LoadBlueprint(*BpPath);
-		if (!Blueprint)
-			throw std::runtime_error("Failed to load Blueprint from path");
-		
-		auto Json = BPUtils::GetBlueprintComponentsJson(Blueprint);
-		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(Json, TEXT("application/json"));
-		Resp->Code = EHttpServerResponseCodes::Ok;
-		OnComplete(MoveTemp(Resp));
+
+		FBlueprintSnapshotPtr Snapshot = SnapshotCache::Acquire(*BpPath);
+		if (!Snapshot->bCompiled)
+			throw std::runtime_error("Blueprint's GeneratedClass is null, please compile the Blueprint first");
+
+		Utils::JsonResponseAsync([Snapshot]() { return SnapshotUtils::EncodeComponentList(*Snapshot); }, OnComplete);
 		return true;
 	} catch (std::runtime_error& e)
 	{
@@ -350,7 +413,7 @@ bool GetComponentPropertiesHandler(const FHttpServerRequest& Req, const FHttpRes
 		
 		auto Json = BPUtils::GetComponentsPropertiesJson(Blueprint, *ComponentName);
 		
-		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(Json, TEXT("application/json"));
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(MoveTemp(Json));
 		Resp->Code = EHttpServerResponseCodes::Ok;
 		OnComplete(MoveTemp(Resp));
 		return true;
@@ -385,6 +448,198 @@ bool SetComponentPropertyHandler(const FHttpServerRequest& Req, const FHttpResul
 	return true;
 }
 
+bool ApplyBlueprintSchemaHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try
+	{
+		FApplyBlueprintSchemaReq body = Utils::BufferToJson<FApplyBlueprintSchemaReq>(Req.Body);
+		UBlueprint* Blueprint = BPUtils::LoadBlueprint(body.BpPath);
+		if (!Blueprint)
+			throw std::runtime_error("Failed to load Blueprint from path");
+
+		FSchemaApplyResult Result = SchemaApplyUtils::ApplyBlueprintSchema(Blueprint, body);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(SchemaApplyUtils::EncodeResult(Result));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
+bool PrefetchHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try
+	{
+		FPrefetchReq body = Utils::BufferToJson<FPrefetchReq>(Req.Body);
+		if (body.Paths.IsEmpty())
+			throw std::runtime_error("No paths to prefetch");
+
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(
+			AssetLoadUtils::EncodePrefetch(AssetLoadUtils::Prefetch(body.Paths)));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
+bool ListBlueprintsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try
+	{
+		FListBlueprintsReq body = Utils::BufferToJson<FListBlueprintsReq>(Req.Body);
+		FBlueprintListResult Result = AssetQueryUtils::ListBlueprints(body);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(AssetQueryUtils::EncodeList(Result, body.Offset));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
 
+bool SearchUsagesHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try {
+		auto Name = Req.QueryParams.Find("name");
+		if (!Name)
+			throw std::runtime_error("Missing name parameter");
+
+		auto Kind = Req.QueryParams.Find("kind");
+		auto PathPrefix = Req.QueryParams.Find("path_prefix");
+		auto Limit = Req.QueryParams.Find("limit");
+		FUsageQueryResult Result = UsageIndex::Search(*Name, Kind ? *Kind : FString(),
+			PathPrefix ? *PathPrefix : FString(), Limit ? FCString::Atoi(**Limit) : 200);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(UsageIndex::EncodeResult(Result));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
 
+bool AnalyzeImpactHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try
+	{
+		FAnalyzeImpactReq body = Utils::BufferToJson<FAnalyzeImpactReq>(Req.Body);
+		UBlueprint* Blueprint = BPUtils::LoadBlueprint(body.BpPath);
+		if (!Blueprint)
+			throw std::runtime_error("Failed to load Blueprint from path");
 
+		FImpactReport Report = ImpactUtils::AnalyzeMemberImpact(Blueprint, body.MemberName, body.MemberKind);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(ImpactUtils::EncodeReport(Report));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
+bool LintHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try
+	{
+		FLintReq body = Utils::BufferToJson<FLintReq>(Req.Body);
+		TArray<FString> Paths;
+		if (!body.BpPath.IsEmpty())
+			Paths.Add(body.BpPath);
+		if (!body.PathPrefix.IsEmpty())
+		{
+			for (const FString& Path : CompileUtils::FindBlueprintsUnderPath(body.PathPrefix))
+			{
+				Paths.AddUnique(Path);
+			}
+		}
+		if (Paths.IsEmpty())
+			throw std::runtime_error("Missing BpPath or PathPrefix");
+
+		const ELintRule Rules = LintUtils::ParseRules(body.Rules);
+		FLintReport Report;
+		TArray<FBlueprintSnapshotPtr> Snapshots = LintUtils::CaptureSnapshots(Paths, Report);
+		if (Snapshots.IsEmpty())
+			throw std::runtime_error("Failed to load Blueprint from path");
+		FLintClassHierarchy Hierarchy = LintUtils::CaptureClassHierarchy(Snapshots);
+
+		// The rules only read the snapshots, so the game thread is free while they run
+		Utils::JsonResponseAsync([Snapshots = MoveTemp(Snapshots), Hierarchy = MoveTemp(Hierarchy), Rules, Report = MoveTemp(Report)]()
+		{
+			FLintReport Result = Report;
+			LintUtils::Lint(Snapshots, Hierarchy, Rules, Result);
+			return LintUtils::EncodeReport(Result);
+		}, OnComplete);
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
+bool QueryGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try
+	{
+		FQueryGraphReq body = Utils::BufferToJson<FQueryGraphReq>(Req.Body);
+		FGraphQuery Query;
+		Query.Kind = GraphQueryUtils::ParseQueryKind(body.Query);
+		Query.NodeId = body.NodeId;
+		Query.EventName = body.EventName;
+		Query.PinName = body.PinName;
+		Query.MaxDepth = body.MaxDepth;
+		Query.NodeType = body.NodeType;
+		Query.MemberName = body.MemberName;
+		Query.PinType = body.PinType;
+
+		FBlueprintSnapshotPtr Snapshot = SnapshotCache::Acquire(body.BpPath);
+		const FGraphSnapshot* Graph = Snapshot->Graphs.FindByPredicate(
+			[&body](const FGraphSnapshot& Candidate) { return Candidate.Name == body.GraphName; });
+		if (!Graph)
+			throw std::runtime_error("Graph not found");
+
+		Utils::JsonResponseAsync([Snapshot, Graph, Query = MoveTemp(Query)]()
+		{
+			return GraphQueryUtils::EncodeNodes(*Graph, GraphQueryUtils::Run(*Snapshot, *Graph, Query));
+		}, OnComplete);
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
@@ -10,8 +10,12 @@ bool GetBPVariablesHandler(const FHttpServerRequest& Req, const FHttpResultCallb
 
 bool GetGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
+bool GetBlueprintSnapshotHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
 bool CompileBPHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
+bool CompileBlueprintsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
 bool AddVariableToBPHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
 bool DeleteVariableFromBPHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
@@ -32,4 +36,18 @@ bool ReattachComponentInBPHandler(const FHttpServerRequest& Req, const FHttpResu
 
 bool GetComponentPropertiesHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
-bool SetComponentPropertyHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
\ No newline at end of file
+bool SetComponentPropertyHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool ApplyBlueprintSchemaHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool PrefetchHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool ListBlueprintsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool SearchUsagesHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool AnalyzeImpactHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool LintHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool QueryGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
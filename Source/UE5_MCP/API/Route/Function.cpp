@@ -3,6 +3,7 @@
 #include "UE5_MCP/API/Utils.h"
 #include "UE5_MCP/API/DTO/FunctionOperationReq.h"
 #include "UE5_MCP/Core/BPUtils.h"
+#include "UE5_MCP/Core/CallSiteUtils.h"
 
 bool CreateFunctionHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
 {
@@ -30,6 +31,16 @@ bool EditFunctionHandler(const FHttpServerRequest& Req, const FHttpResultCallbac
 	try
 	{
 		FFunctionOperationReq body = Utils::BufferToJson<FFunctionOperationReq>(Req.Body);
+		if (body.bUpdateCallSites)
+		{
+			FCallSiteReport Report;
+			BPUtils::EditFunctionGraph(BPUtils::LoadBlueprint(body.BpPath), body.FunctionName, body.FunctionInputSignature,
+				body.FunctionOutputSignature, &Report);
+			TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(CallSiteUtils::EncodeReport(Report));
+			Resp->Code = EHttpServerResponseCodes::Ok;
+			OnComplete(MoveTemp(Resp));
+			return true;
+		}
 		BPUtils::EditFunctionGraph(BPUtils::LoadBlueprint(body.BpPath), body.FunctionName, body.FunctionInputSignature, body.FunctionOutputSignature);
 	} catch (std::runtime_error& e)
 	{
@@ -51,6 +62,15 @@ bool DeleteFunctionHandler(const FHttpServerRequest& Req, const FHttpResultCallb
 	try
 	{
 		FFunctionOperationReq body = Utils::BufferToJson<FFunctionOperationReq>(Req.Body);
+		if (body.bUpdateCallSites)
+		{
+			FCallSiteReport Report;
+			BPUtils::RemoveFunctionGraph(BPUtils::LoadBlueprint(body.BpPath), body.FunctionName, &Report);
+			TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(CallSiteUtils::EncodeReport(Report));
+			Resp->Code = EHttpServerResponseCodes::Ok;
+			OnComplete(MoveTemp(Resp));
+			return true;
+		}
 		BPUtils::RemoveFunctionGraph(BPUtils::LoadBlueprint(body.BpPath), body.FunctionName);
 	} catch (std::runtime_error& e)
 	{
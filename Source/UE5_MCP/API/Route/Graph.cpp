@@ -4,11 +4,17 @@
 #include "UE5_MCP/API/DTO/Graph/AddEventToGraphReq.h"
 #include "UE5_MCP/API/DTO/Graph/AddFunctionCallToGraphReq.h"
 #include "UE5_MCP/API/DTO/Graph/AddVariableToGraphReq.h"
+#include "UE5_MCP/API/DTO/Graph/ApplyGraphReq.h"
+#include "UE5_MCP/API/DTO/Graph/CheckPinConnectionsReq.h"
 #include "UE5_MCP/API/DTO/Graph/GenericAddNodeToGraphReq.h"
 #include "UE5_MCP/API/DTO/Graph/PinOperationReq.h"
+#include "UE5_MCP/API/DTO/Graph/SearchActionsReq.h"
 #include "UE5_MCP/API/DTO/Graph/SetPinDefaultValueReq.h"
+#include "UE5_MCP/Core/ActionIndex.h"
 #include "UE5_MCP/Core/BPUtils.h"
+#include "UE5_MCP/Core/GraphApplyUtils.h"
 #include "UE5_MCP/Core/GraphUtils.h"
+#include "UE5_MCP/Core/NodeCatalog.h"
 
 
 bool AddEventToGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
@@ -114,7 +120,8 @@ bool ConnectPinsHandler(const FHttpServerRequest& Req, const FHttpResultCallback
 			body.OutputNodeId,
 			body.OutputPinName,
 			body.InputNodeId,
-			body.InputPinName);
+			body.InputPinName,
+			body.bValidate);
 	} catch (std::runtime_error& e)
 	{
 		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
@@ -130,6 +137,34 @@ bool ConnectPinsHandler(const FHttpServerRequest& Req, const FHttpResultCallback
 	return true;
 }
 
+bool CheckPinConnectionsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try {
+		FCheckPinConnectionsReq body = Utils::BufferToJson<FCheckPinConnectionsReq>(Req.Body);
+		TArray<FPinConnectionCandidate> Candidates;
+		Candidates.Reserve(body.Pairs.Num());
+		for (const FPinConnectionPair& Pair : body.Pairs)
+		{
+			Candidates.Add({ Pair.OutputNodeId, Pair.OutputPinName, Pair.InputNodeId, Pair.InputPinName });
+		}
+
+		TArray<FPinConnectionCheck> Checks = GraphUtils::CheckPinConnections(
+			BPUtils::GetEventGraph(BPUtils::LoadBlueprint(body.BpPath), body.GraphName),
+			Candidates);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(GraphUtils::EncodePinConnectionChecks(Checks));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
 bool BreakPinConnectionHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
 {
 	try {
@@ -185,8 +220,8 @@ bool GetSupportedNodesHandler(const FHttpServerRequest& Req, const FHttpResultCa
 {
 	try {
 		TArray<FString> Nodes = GraphUtils::GetSupportedNode();
-		FString Json = Utils::ToJsonString(Nodes);
-		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(Json, TEXT("application/json"));
+		TArray<uint8> Json = Utils::ToJson(Nodes);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(MoveTemp(Json));
 		Resp->Code = EHttpServerResponseCodes::Ok;
 		OnComplete(MoveTemp(Resp));
 		return true;
@@ -201,6 +236,64 @@ bool GetSupportedNodesHandler(const FHttpServerRequest& Req, const FHttpResultCa
 	
 }
 
+bool DescribeNodeHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try {
+		auto NodeType = Req.QueryParams.Find("node_type");
+		if (!NodeType)
+			throw std::runtime_error("Missing node_type parameter");
+
+		FNodeKey Key;
+		Key.NodeType = *NodeType;
+		if (auto ClassName = Req.QueryParams.Find("class"))
+			Key.ClassName = *ClassName;
+		if (auto MemberName = Req.QueryParams.Find("member"))
+			Key.MemberName = *MemberName;
+		if (auto TypeName = Req.QueryParams.Find("type"))
+			Key.TypeName = *TypeName;
+
+		FNodeLayoutPtr Layout = NodeCatalog::Describe(Key);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(NodeCatalog::EncodeLayout(*Layout));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
+bool SearchActionsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try {
+		FSearchActionsReq body = Utils::BufferToJson<FSearchActionsReq>(Req.Body);
+		FActionSearchQuery Query;
+		Query.Text = body.Query;
+		Query.Category = body.Category;
+		Query.ClassName = body.ClassName;
+		Query.PinCategory = body.PinCategory;
+		Query.PinSubType = body.PinSubType;
+		Query.bFromOutput = body.bFromOutput;
+		Query.Limit = body.Limit;
+
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(ActionIndex::EncodeResult(ActionIndex::Search(Query)));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
+
 bool AddGenericNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
 {
 	try {
@@ -410,3 +503,28 @@ bool AddCommentNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpResu
 	OnComplete(MoveTemp(Resp));
 	return true;
 }
+
+bool ApplyGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	try {
+		FApplyGraphReq body = Utils::BufferToJson<FApplyGraphReq>(Req.Body);
+		UBlueprint* Blueprint = BPUtils::LoadBlueprint(body.BpPath);
+		FGraphApplyResult Result = GraphApplyUtils::ApplyGraph(
+			Blueprint,
+			BPUtils::GetEventGraph(Blueprint, body.GraphName),
+			body.Nodes,
+			body.Links,
+			body.bPrune);
+		TUniquePtr<FHttpServerResponse> Resp = Utils::JsonResponse(GraphApplyUtils::EncodeResult(Result));
+		Resp->Code = EHttpServerResponseCodes::Ok;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	} catch (std::runtime_error& e)
+	{
+		TUniquePtr<FHttpServerResponse> Resp = FHttpServerResponse::Create(
+			FString::Printf(TEXT("Error: %s"), UTF8_TO_TCHAR(e.what())), TEXT("text/plain"));
+		Resp->Code = EHttpServerResponseCodes::ServerError;
+		OnComplete(MoveTemp(Resp));
+		return true;
+	}
+}
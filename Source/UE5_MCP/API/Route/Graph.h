@@ -10,12 +10,18 @@ bool AddFunctionCallToGraphHandler(const FHttpServerRequest& Req, const FHttpRes
 
 bool ConnectPinsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
+bool CheckPinConnectionsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
 bool BreakPinConnectionHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
 bool SetPinDefaultValueHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
 bool GetSupportedNodesHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
+bool DescribeNodeHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool SearchActionsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
 bool AddGenericNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
 bool AddMakeStructNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
@@ -32,4 +38,6 @@ bool AddEnumCastNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpRes
 
 bool AddMathNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
 
-bool AddCommentNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
\ No newline at end of file
+bool AddCommentNodeToGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
+
+bool ApplyGraphHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
\ No newline at end of file
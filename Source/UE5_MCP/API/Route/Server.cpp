@@ -0,0 +1,21 @@
+﻿#include "Server.h"
+
+#include "UE5_MCP/API/RequestScheduler.h"
+#include "UE5_MCP/Core/Metrics.h"
+
+bool GetMetricsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete)
+{
+	auto Format = Req.QueryParams.Find("format");
+	const TArray<FString>* Accept = Req.Headers.Find(TEXT("Accept"));
+	bool bJson = (Format && *Format == "json")
+		|| (Accept && Accept->ContainsByPredicate([](const FString& Value) { return Value.Contains(TEXT("application/json")); }));
+
+	TUniquePtr<FHttpServerResponse> Resp = bJson
+		? FHttpServerResponse::Create(Metrics::ToJson([](TJsonWriter<>& Writer) { RequestScheduler::WriteJson(Writer); }),
+			TEXT("application/json"))
+		: FHttpServerResponse::Create(Metrics::ToPrometheusText() + RequestScheduler::ToPrometheusText(),
+			TEXT("text/plain; version=0.0.4"));
+	Resp->Code = EHttpServerResponseCodes::Ok;
+	OnComplete(MoveTemp(Resp));
+	return true;
+}
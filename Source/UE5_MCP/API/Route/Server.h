@@ -0,0 +1,6 @@
+﻿#pragma once
+#include "HttpResultCallback.h"
+#include "HttpServerRequest.h"
+
+
+bool GetMetricsHandler(const FHttpServerRequest& Req, const FHttpResultCallback& OnComplete);
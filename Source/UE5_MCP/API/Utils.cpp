@@ -1,18 +1,69 @@
 ﻿#include "Utils.h"
 
-FString Utils::ToJsonString(const TArray<FString> array)
+#include "Async/Async.h"
+#include "UE5_MCP/Core/JsonBuffer.h"
+
+TArray<uint8> Utils::ToJson(const TArray<FString>& Array)
 {
-	FString OutputString;
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
 		
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputString);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
 
 	Writer->WriteArrayStart();
-	for (const FString& Item : array)
+	for (const FString& Item : Array)
 	{
 		Writer->WriteValue(Item);
 	}
 	Writer->WriteArrayEnd();
 	Writer->Close();
 		
-	return OutputString;
+	return Output;
+}
+
+TUniquePtr<FHttpServerResponse> Utils::JsonResponse(TArray<uint8>&& Body)
+{
+	JsonBuffer::RecordMovedToResponse(Body.Num());
+	return FHttpServerResponse::Create(MoveTemp(Body), TEXT("application/json"));
+}
+
+void Utils::JsonResponseAsync(TUniqueFunction<TArray<uint8>()>&& Encode, const FHttpResultCallback& OnComplete)
+{
+	TSharedPtr<Metrics::FRequest> Request = Metrics::GetCurrentRequest();
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask,
+		[Encode = MoveTemp(Encode), OnComplete, Request]() mutable
+		{
+			const double StartSeconds = FPlatformTime::Seconds();
+			TArray<uint8> Body;
+			FString Error;
+			try
+			{
+				Body = Encode();
+			} catch (std::runtime_error& e)
+			{
+				Error = UTF8_TO_TCHAR(e.what());
+			}
+			const double EncodeSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+			AsyncTask(ENamedThreads::GameThread,
+				[Body = MoveTemp(Body), Error = MoveTemp(Error), OnComplete, Request, EncodeSeconds]() mutable
+				{
+					if (Request)
+						Metrics::AddPhaseTime(Request.ToSharedRef(), EMetricPhase::Serialize, EncodeSeconds);
+
+					TUniquePtr<FHttpServerResponse> Resp;
+					if (Error.IsEmpty())
+					{
+						Resp = JsonResponse(MoveTemp(Body));
+						Resp->Code = EHttpServerResponseCodes::Ok;
+					}
+					else
+					{
+						Resp = FHttpServerResponse::Create(FString::Printf(TEXT("Error: %s"), *Error), TEXT("text/plain"));
+						Resp->Code = EHttpServerResponseCodes::ServerError;
+					}
+					OnComplete(MoveTemp(Resp));
+				});
+		});
 }
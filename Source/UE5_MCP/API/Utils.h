@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include <stdexcept>
 #include "JsonObjectConverter.h"
+#include "HttpServerResponse.h"
+#include "JsonStructReader.h"
+#include "UE5_MCP/Core/Metrics.h"
 
 class Utils
 {
@@ -8,15 +11,28 @@ public:
 	template <typename T>
 	static T BufferToJson(const TArray<uint8>& Buffer);
 
-	static FString ToJsonString(const TArray<FString> array);
+	static TArray<uint8> ToJson(const TArray<FString>& Array);
+
+	// Moves a UTF-8 JSON body into the response without re-encoding it
+	static TUniquePtr<FHttpServerResponse> JsonResponse(TArray<uint8>&& Body);
+
+	// Runs Encode on a worker thread and completes the request with its JSON back on the game thread
+	// Encode must only read data it owns, such as a snapshot, never live UObjects
+	static void JsonResponseAsync(TUniqueFunction<TArray<uint8>()>&& Encode, const FHttpResultCallback& OnComplete);
 };
 
 template <typename T>
 T Utils::BufferToJson(const TArray<uint8>& Buffer)
 {
+	Metrics::FScopedPhase Phase(EMetricPhase::Parse);
+	T Obj;
+	if (JsonStructReader::Read(Obj, Buffer))
+		return Obj;
+
+	// Bodies the streaming reader doesn't handle go through the JSON DOM
+	Obj = T();
 	FUTF8ToTCHAR Converter(reinterpret_cast<const char*>(Buffer.GetData()), Buffer.Num());
 	FString JsonStr(Converter.Length(), Converter.Get());
-	T Obj; 
 	if (FJsonObjectConverter::JsonObjectStringToUStruct(JsonStr, &Obj, 0, 0))
 	{
 		return Obj;
@@ -0,0 +1,300 @@
+﻿#include "WebSocketChannel.h"
+
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "INetworkingWebSocket.h"
+#include "IWebSocketNetworkingModule.h"
+#include "IWebSocketServer.h"
+#include "Route.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "UE5_MCP/Core/ChangeEvents.h"
+#include "UE5_MCP/Core/JsonBuffer.h"
+
+// Upper bound on a single unterminated message, a client exceeding it is disconnected
+static constexpr int32 MaxPendingBytes = 64 * 1024 * 1024;
+
+TUniquePtr<IWebSocketServer> WebSocketChannel::Server;
+TMap<int32, TUniquePtr<WebSocketChannel::FClient>> WebSocketChannel::Clients;
+int32 WebSocketChannel::NextClientId = 0;
+FTSTicker::FDelegateHandle WebSocketChannel::TickerHandle;
+FDelegateHandle WebSocketChannel::ChangeHandle;
+
+bool WebSocketChannel::Start(uint32 Port)
+{
+	Stop();
+
+	Server = FModuleManager::LoadModuleChecked<IWebSocketNetworkingModule>(TEXT("WebSocketNetworking")).CreateServer();
+	if (!Server || !Server->Init(Port, FWebSocketClientConnectedCallBack::CreateStatic(&WebSocketChannel::HandleClientConnected)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to start the WebSocket channel on port %u"), Port);
+		Server.Reset();
+		return false;
+	}
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&WebSocketChannel::Tick));
+	ChangeHandle = ChangeEvents::OnChange().AddStatic(&WebSocketChannel::HandleChange);
+	UE_LOG(LogTemp, Log, TEXT("WebSocket channel listening on port %u"), Port);
+	return true;
+}
+
+void WebSocketChannel::Stop()
+{
+	if (!Server)
+		return;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	ChangeEvents::OnChange().Remove(ChangeHandle);
+	// Sockets belong to the server's context, close them before it goes away
+	Clients.Empty();
+	Server.Reset();
+}
+
+bool WebSocketChannel::IsRunning()
+{
+	return Server.IsValid();
+}
+
+bool WebSocketChannel::Tick(float DeltaTime)
+{
+	if (Server)
+		Server->Tick();
+
+	for (auto It = Clients.CreateIterator(); It; ++It)
+	{
+		if (It->Value->bClosed)
+			It.RemoveCurrent();
+	}
+	return true;
+}
+
+void WebSocketChannel::HandleClientConnected(INetworkingWebSocket* Socket)
+{
+	const int32 ClientId = NextClientId++;
+	TUniquePtr<FClient> Client = MakeUnique<FClient>();
+	Client->Socket.Reset(Socket);
+
+	Socket->SetReceiveCallBack(FWebSocketPacketReceivedCallBack::CreateLambda([ClientId](void* Data, int32 Size)
+	{
+		HandleReceive(ClientId, static_cast<const uint8*>(Data), Size);
+	}));
+	// Removed on the next tick, the socket is still inside its own callback here
+	Socket->SetSocketClosedCallBack(FWebSocketInfoCallBack::CreateLambda([ClientId]()
+	{
+		if (TUniquePtr<FClient>* Found = Clients.Find(ClientId))
+			(*Found)->bClosed = true;
+	}));
+
+	Clients.Add(ClientId, MoveTemp(Client));
+}
+
+void WebSocketChannel::HandleReceive(int32 ClientId, const uint8* Data, int32 Size)
+{
+	TUniquePtr<FClient>* Found = Clients.Find(ClientId);
+	if (!Found || (*Found)->bClosed)
+		return;
+
+	// Messages may arrive split across frames or several in one, only whole JSON values are dispatched
+	TArray<uint8>& Pending = (*Found)->Pending;
+	Pending.Append(Data, Size);
+	while (int32 End = FindMessageEnd(Pending))
+	{
+		if (End < 0)
+		{
+			Pending.RemoveAt(0, -End);
+			SendError(ClientId, FString(), TEXT("Malformed message, expected a JSON object"));
+			continue;
+		}
+		TArray<uint8> Message(Pending.GetData(), End);
+		Pending.RemoveAt(0, End);
+		HandleMessage(ClientId, Message);
+	}
+
+	if (Pending.Num() > MaxPendingBytes)
+	{
+		SendError(ClientId, FString(), TEXT("Message too large"));
+		(*Found)->bClosed = true;
+	}
+}
+
+void WebSocketChannel::HandleMessage(int32 ClientId, const TArray<uint8>& Message)
+{
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Message.GetData()), Message.Num());
+	const FString Text(Converted.Length(), Converted.Get());
+	TSharedPtr<FJsonObject> Json;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Json) || !Json.IsValid())
+	{
+		SendError(ClientId, FString(), TEXT("Invalid JSON message"));
+		return;
+	}
+
+	// Missing or non-string fields are left empty rather than logged as errors
+	FString Id;
+	Json->TryGetStringField(TEXT("id"), Id);
+	FString Route;
+	Json->TryGetStringField(TEXT("route"), Route);
+	if (Route.IsEmpty())
+	{
+		SendError(ClientId, Id, TEXT("Missing route"));
+		return;
+	}
+	if (!Route.StartsWith(TEXT("/")))
+		Route = TEXT("/") + Route;
+
+	FString Method;
+	Json->TryGetStringField(TEXT("method"), Method);
+	TSharedRef<FHttpServerRequest> Request = MakeShared<FHttpServerRequest>();
+	Request->Verb = Method.Equals(TEXT("GET"), ESearchCase::IgnoreCase)
+		? EHttpServerRequestVerbs::VERB_GET
+		: EHttpServerRequestVerbs::VERB_POST;
+	Request->RelativePath.SetPath(Route);
+	if (!Id.IsEmpty())
+		Request->Headers.Add(TEXT("X-Request-Id"), { Id });
+
+	const TSharedPtr<FJsonObject>* Query = nullptr;
+	if (Json->TryGetObjectField(TEXT("query"), Query))
+	{
+		for (const auto& Pair : (*Query)->Values)
+		{
+			FString Value;
+			if (Pair.Value.IsValid() && Pair.Value->TryGetString(Value))
+				Request->QueryParams.Add(Pair.Key, Value);
+		}
+	}
+
+	// Route handlers read the body as UTF-8 JSON, exactly as it would arrive over HTTP
+	const TSharedPtr<FJsonObject>* Body = nullptr;
+	if (Json->TryGetObjectField(TEXT("body"), Body))
+	{
+		FString BodyText;
+		FJsonSerializer::Serialize(Body->ToSharedRef(), TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&BodyText));
+		FTCHARToUTF8 Utf8(*BodyText);
+		Request->Body.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	Router::Dispatch(Route, *Request, [ClientId, Id](TUniquePtr<FHttpServerResponse>&& Resp)
+	{
+		TArray<uint8> Frame;
+		Frame.Reserve(Resp->Body.Num() + 128);
+		JsonBuffer::AppendRaw(Frame, "{\"type\":\"response\",\"id\":");
+		JsonBuffer::AppendString(Frame, Id);
+		JsonBuffer::AppendRaw(Frame, ",\"code\":");
+		JsonBuffer::AppendRaw(Frame, TCHAR_TO_UTF8(*FString::FromInt(static_cast<int32>(Resp->Code))));
+
+		const TArray<FString>* ContentType = Resp->Headers.Find(TEXT("content-type"));
+		const FString Type = ContentType && ContentType->Num() > 0 ? (*ContentType)[0] : FString();
+		JsonBuffer::AppendRaw(Frame, ",\"contentType\":");
+		JsonBuffer::AppendString(Frame, Type);
+		JsonBuffer::AppendRaw(Frame, ",\"body\":");
+		// JSON bodies are embedded as they are, anything else as a string
+		if (Type.StartsWith(TEXT("application/json")) && Resp->Body.Num() > 0)
+		{
+			Frame.Append(Resp->Body);
+		}
+		else
+		{
+			const FUTF8ToTCHAR BodyText(reinterpret_cast<const ANSICHAR*>(Resp->Body.GetData()), Resp->Body.Num());
+			JsonBuffer::AppendString(Frame, FString(BodyText.Length(), BodyText.Get()));
+		}
+		JsonBuffer::AppendRaw(Frame, "}");
+		Send(ClientId, Frame);
+	});
+}
+
+void WebSocketChannel::HandleChange(const FChangeEvent& Event)
+{
+	if (Clients.Num() == 0)
+		return;
+
+	TArray<uint8> Frame;
+	JsonBuffer::AppendRaw(Frame, "{\"type\":\"event\",\"event\":");
+	JsonBuffer::AppendString(Frame, ChangeEvents::GetTypeName(Event.Type));
+	JsonBuffer::AppendRaw(Frame, ",\"blueprint\":");
+	JsonBuffer::AppendString(Frame, Event.BlueprintPath);
+	if (!Event.GraphName.IsEmpty())
+	{
+		JsonBuffer::AppendRaw(Frame, ",\"graph\":");
+		JsonBuffer::AppendString(Frame, Event.GraphName);
+	}
+	if (!Event.ObjectName.IsEmpty())
+	{
+		JsonBuffer::AppendRaw(Frame, ",\"object\":");
+		JsonBuffer::AppendString(Frame, Event.ObjectName);
+	}
+	if (!Event.PropertyName.IsEmpty())
+	{
+		JsonBuffer::AppendRaw(Frame, ",\"property\":");
+		JsonBuffer::AppendString(Frame, Event.PropertyName);
+	}
+	if (!Event.Status.IsEmpty())
+	{
+		JsonBuffer::AppendRaw(Frame, ",\"status\":");
+		JsonBuffer::AppendString(Frame, Event.Status);
+	}
+	JsonBuffer::AppendRaw(Frame, "}");
+
+	for (const auto& Pair : Clients)
+		Send(Pair.Key, Frame);
+}
+
+void WebSocketChannel::Send(int32 ClientId, const TArray<uint8>& Frame)
+{
+	// The client may have disconnected while its request was being handled
+	TUniquePtr<FClient>* Found = Clients.Find(ClientId);
+	if (!Found || (*Found)->bClosed || !(*Found)->Socket)
+		return;
+	(*Found)->Socket->Send(Frame.GetData(), Frame.Num(), false);
+}
+
+void WebSocketChannel::SendError(int32 ClientId, const FString& Id, const FString& Error)
+{
+	TArray<uint8> Frame;
+	JsonBuffer::AppendRaw(Frame, "{\"type\":\"response\",\"id\":");
+	JsonBuffer::AppendString(Frame, Id);
+	JsonBuffer::AppendRaw(Frame, ",\"code\":400,\"contentType\":\"text/plain\",\"body\":");
+	JsonBuffer::AppendString(Frame, FString::Printf(TEXT("Error: %s"), *Error));
+	JsonBuffer::AppendRaw(Frame, "}");
+	Send(ClientId, Frame);
+}
+
+int32 WebSocketChannel::FindMessageEnd(const TArray<uint8>& Data)
+{
+	int32 Depth = 0;
+	bool bInString = false;
+	bool bEscaped = false;
+	for (int32 i = 0; i < Data.Num(); ++i)
+	{
+		const uint8 C = Data[i];
+		if (Depth == 0)
+		{
+			if (C == ' ' || C == '\t' || C == '\r' || C == '\n')
+				continue;
+			// Only whitespace precedes it, so a stray closing bracket or any other garbage is dropped up to the next object
+			if (C != '{')
+			{
+				const int32 Next = Data.Find('{');
+				return -(Next != INDEX_NONE ? Next : Data.Num());
+			}
+		}
+
+		if (bInString)
+		{
+			if (bEscaped)
+				bEscaped = false;
+			else if (C == '\\')
+				bEscaped = true;
+			else if (C == '"')
+				bInString = false;
+			continue;
+		}
+
+		if (C == '"')
+			bInString = true;
+		else if (C == '{' || C == '[')
+			++Depth;
+		else if ((C == '}' || C == ']') && --Depth == 0)
+			return i + 1;
+	}
+	return 0;
+}
@@ -0,0 +1,48 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class INetworkingWebSocket;
+class IWebSocketServer;
+struct FChangeEvent;
+
+// Persistent WebSocket transport next to the HTTP listener
+// Clients send {"id", "route", "method", "query", "body"} messages which are dispatched to the same route handlers,
+// and receive {"type": "response", "id", ...} replies plus {"type": "event", ...} pushes from ChangeEvents
+class WebSocketChannel
+{
+public:
+	static bool Start(uint32 Port);
+	static void Stop();
+	static bool IsRunning();
+
+private:
+	struct FClient
+	{
+		TUniquePtr<INetworkingWebSocket> Socket;
+		// Bytes received but not yet forming a complete message
+		TArray<uint8> Pending;
+		bool bClosed = false;
+	};
+
+	static bool Tick(float DeltaTime);
+
+	static void HandleClientConnected(INetworkingWebSocket* Socket);
+	static void HandleReceive(int32 ClientId, const uint8* Data, int32 Size);
+	static void HandleMessage(int32 ClientId, const TArray<uint8>& Message);
+	static void HandleChange(const FChangeEvent& Event);
+
+	static void Send(int32 ClientId, const TArray<uint8>& Frame);
+	static void SendError(int32 ClientId, const FString& Id, const FString& Error);
+
+	// Length of the first complete top-level JSON object in Data, 0 if it isn't complete yet
+	// Negative when Data doesn't start with an object, e.g. after a stray closing bracket, minus the bytes to discard
+	static int32 FindMessageEnd(const TArray<uint8>& Data);
+
+	static TUniquePtr<IWebSocketServer> Server;
+	static TMap<int32, TUniquePtr<FClient>> Clients;
+	static int32 NextClientId;
+
+	static FTSTicker::FDelegateHandle TickerHandle;
+	static FDelegateHandle ChangeHandle;
+};
@@ -0,0 +1,503 @@
+﻿#include "ActionIndex.h"
+#include "MCPTrace.h"
+
+#include "ClassUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "BlueprintActionDatabase.h"
+#include "BlueprintFunctionNodeSpawner.h"
+#include "BlueprintNodeSpawner.h"
+#include "BlueprintVariableNodeSpawner.h"
+#include "EdGraphSchema_K2.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "HAL/IConsoleManager.h"
+#include "K2Node_VariableSet.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<float> CVarActionIndexFrameBudgetMs(
+	TEXT("UE5_MCP.ActionIndex.FrameBudgetMs"), 4.f,
+	TEXT("Game thread time per frame spent indexing Blueprint actions. At least one database entry is indexed every frame, 0 pauses indexing."));
+
+TArray<ActionIndex::FActionEntry> ActionIndex::Entries;
+TMap<uint32, TArray<int32>> ActionIndex::Postings;
+TMap<FObjectKey, TArray<int32>> ActionIndex::OwnerEntries;
+TArray<FObjectKey> ActionIndex::Pending;
+TSet<FObjectKey> ActionIndex::PendingSet;
+int32 ActionIndex::RemovedCount = 0;
+bool ActionIndex::bFilesLoaded = false;
+bool ActionIndex::bSeeded = false;
+FTSTicker::FDelegateHandle ActionIndex::TickerHandle;
+FDelegateHandle ActionIndex::FilesLoadedHandle;
+FDelegateHandle ActionIndex::EntryUpdatedHandle;
+FDelegateHandle ActionIndex::EntryRemovedHandle;
+
+namespace
+{
+	FString GetClassName(const UClass* Class)
+	{
+		// Blueprint classes by path, the way ClassUtils::FindClassByName loads them
+		return Cast<UBlueprintGeneratedClass>(Class) ? Class->GetPathName() : Class->GetName();
+	}
+
+	bool IsObjectCategory(FName Category)
+	{
+		return Category == UEdGraphSchema_K2::PC_Object || Category == UEdGraphSchema_K2::PC_Interface
+			|| Category == UEdGraphSchema_K2::PC_SoftObject;
+	}
+}
+
+void ActionIndex::Initialize()
+{
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&ActionIndex::Tick));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	if (AssetRegistry.IsLoadingAssets())
+		FilesLoadedHandle = AssetRegistry.OnFilesLoaded().AddStatic(&ActionIndex::HandleFilesLoaded);
+	else
+		bFilesLoaded = true;
+}
+
+void ActionIndex::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(TEXT("AssetRegistry")))
+		AssetRegistryModule->Get().OnFilesLoaded().Remove(FilesLoadedHandle);
+	if (FBlueprintActionDatabase* Database = FBlueprintActionDatabase::TryGet())
+	{
+		Database->OnEntryUpdated().Remove(EntryUpdatedHandle);
+		Database->OnEntryRemoved().Remove(EntryRemovedHandle);
+	}
+
+	Entries.Empty();
+	Postings.Empty();
+	OwnerEntries.Empty();
+	Pending.Empty();
+	PendingSet.Empty();
+	RemovedCount = 0;
+	bFilesLoaded = false;
+	bSeeded = false;
+}
+
+void ActionIndex::Seed()
+{
+	MCP_TRACE_SCOPE("ActionIndex::Seed");
+	FBlueprintActionDatabase& Database = FBlueprintActionDatabase::Get();
+	EntryUpdatedHandle = Database.OnEntryUpdated().AddStatic(&ActionIndex::HandleEntryUpdated);
+	EntryRemovedHandle = Database.OnEntryRemoved().AddStatic(&ActionIndex::HandleEntryRemoved);
+
+	for (const TPair<FObjectKey, FBlueprintActionDatabase::FActionList>& Pair : Database.GetAllActions())
+	{
+		if (!PendingSet.Contains(Pair.Key))
+		{
+			PendingSet.Add(Pair.Key);
+			Pending.Add(Pair.Key);
+		}
+	}
+	bSeeded = true;
+}
+
+bool ActionIndex::Tick(float DeltaTime)
+{
+	const double BudgetSeconds = CVarActionIndexFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+	if (BudgetSeconds <= 0.0 || IsGarbageCollecting() || GIsSavingPackage)
+		return true;
+
+	// Only seeds from a database the editor already built, queuing its entries is cheap
+	if (!bSeeded && bFilesLoaded && FBlueprintActionDatabase::TryGet())
+		Seed();
+	if (Pending.IsEmpty())
+		return true;
+
+	MCP_TRACE_SCOPE("ActionIndex::Tick");
+	const double StartSeconds = FPlatformTime::Seconds();
+	bool bWorked = false;
+	// Taken from the back, so entries refreshed after a compile are indexed before the rest of the seed
+	while (Pending.Num() > 0 && (!bWorked || FPlatformTime::Seconds() - StartSeconds < BudgetSeconds))
+	{
+		const FObjectKey Owner = Pending.Pop();
+		if (!PendingSet.Remove(Owner))
+			continue;
+		bWorked = true;
+		IndexOwner(Owner);
+	}
+	Compact();
+	return true;
+}
+
+void ActionIndex::IndexOwner(const FObjectKey& Owner)
+{
+	RemoveOwner(Owner);
+	const FBlueprintActionDatabase::FActionList* Actions = FBlueprintActionDatabase::Get().GetAllActions().Find(Owner);
+	if (!Actions)
+		return;
+	for (const UBlueprintNodeSpawner* Spawner : *Actions)
+	{
+		if (Spawner)
+			AddAction(Owner, Spawner);
+	}
+}
+
+void ActionIndex::AddAction(const FObjectKey& Owner, const UBlueprintNodeSpawner* Spawner)
+{
+	const FBlueprintActionUiSpec& UiSpec = Spawner->PrimeDefaultUiSpec();
+	if (UiSpec.MenuName.IsEmpty())
+		return;
+
+	FActionEntry Entry;
+	Entry.Owner = Owner;
+	Entry.Name = UiSpec.MenuName.ToString();
+	Entry.Category = UiSpec.Category.ToString();
+	if (Spawner->NodeClass)
+		Entry.NodeType = Spawner->NodeClass->GetName();
+
+	const UEdGraphSchema_K2* Schema = GetDefault<UEdGraphSchema_K2>();
+	if (const UBlueprintFunctionNodeSpawner* FunctionSpawner = Cast<UBlueprintFunctionNodeSpawner>(Spawner))
+	{
+		const UFunction* Function = FunctionSpawner->GetFunction();
+		const UClass* OwnerClass = Function ? Function->GetOwnerClass() : nullptr;
+		if (Function && OwnerClass)
+		{
+			Entry.ClassName = GetClassName(OwnerClass);
+			Entry.FunctionName = Function->GetName();
+			Entry.bHasPins = true;
+			if (!Function->HasAnyFunctionFlags(FUNC_BlueprintPure))
+			{
+				Entry.Inputs.Add({ UEdGraphSchema_K2::PC_Exec, nullptr });
+				Entry.Outputs.Add({ UEdGraphSchema_K2::PC_Exec, nullptr });
+			}
+			if (!Function->HasAnyFunctionFlags(FUNC_Static))
+				Entry.Inputs.Add({ UEdGraphSchema_K2::PC_Object, const_cast<UClass*>(OwnerClass) });
+			for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+			{
+				FEdGraphPinType PinType;
+				if (!Schema->ConvertPropertyToPinType(*It, PinType))
+					continue;
+				const bool bOutput = It->HasAnyPropertyFlags(CPF_ReturnParm)
+					|| (It->HasAnyPropertyFlags(CPF_OutParm) && !It->HasAnyPropertyFlags(CPF_ReferenceParm));
+				(bOutput ? Entry.Outputs : Entry.Inputs).Add({ PinType.PinCategory, PinType.PinSubCategoryObject });
+			}
+		}
+	}
+	else if (const UBlueprintVariableNodeSpawner* VariableSpawner = Cast<UBlueprintVariableNodeSpawner>(Spawner))
+	{
+		const FProperty* Property = VariableSpawner->GetVarProperty();
+		FEdGraphPinType PinType;
+		if (Property && Schema->ConvertPropertyToPinType(Property, PinType))
+		{
+			Entry.bHasPins = true;
+			const bool bSetter = Spawner->NodeClass && Spawner->NodeClass->IsChildOf(UK2Node_VariableSet::StaticClass());
+			if (bSetter)
+			{
+				Entry.Inputs.Add({ UEdGraphSchema_K2::PC_Exec, nullptr });
+				Entry.Outputs.Add({ UEdGraphSchema_K2::PC_Exec, nullptr });
+				Entry.Inputs.Add({ PinType.PinCategory, PinType.PinSubCategoryObject });
+			}
+			Entry.Outputs.Add({ PinType.PinCategory, PinType.PinSubCategoryObject });
+			if (const UClass* OwnerClass = Property->GetOwnerClass())
+			{
+				Entry.ClassName = GetClassName(OwnerClass);
+				if (!VariableSpawner->IsLocalVariable())
+					Entry.Inputs.Add({ UEdGraphSchema_K2::PC_Object, const_cast<UClass*>(OwnerClass) });
+			}
+		}
+	}
+
+	Entry.SearchName = Normalize(Entry.Name);
+	Entry.SearchFunction = Normalize(Entry.FunctionName);
+	Entry.SearchKeywords = Normalize(UiSpec.Keywords.ToString());
+	Entry.SearchCategory = Normalize(Entry.Category);
+	Entry.SearchClass = Normalize(Entry.ClassName);
+	Entry.SearchText = FString::Join(TArray<FString>{ Entry.SearchName, Entry.SearchFunction, Entry.SearchKeywords,
+		Entry.SearchCategory, Entry.SearchClass }, TEXT(" "));
+	AddEntry(MoveTemp(Entry));
+}
+
+void ActionIndex::AddEntry(FActionEntry&& Entry)
+{
+	const int32 Index = Entries.Num();
+	TSet<uint32> Trigrams;
+	GetTrigrams(Entry.SearchText, Trigrams);
+	// Indices only grow, so every posting list stays sorted
+	for (uint32 Trigram : Trigrams)
+	{
+		Postings.FindOrAdd(Trigram).Add(Index);
+	}
+	OwnerEntries.FindOrAdd(Entry.Owner).Add(Index);
+	Entries.Add(MoveTemp(Entry));
+}
+
+void ActionIndex::RemoveOwner(const FObjectKey& Owner)
+{
+	TArray<int32> Indices;
+	if (!OwnerEntries.RemoveAndCopyValue(Owner, Indices))
+		return;
+	// Left in the postings until the next compaction, searches skip them
+	for (int32 Index : Indices)
+	{
+		Entries[Index].bRemoved = true;
+	}
+	RemovedCount += Indices.Num();
+}
+
+void ActionIndex::Compact()
+{
+	if (RemovedCount < 1024 || RemovedCount * 2 < Entries.Num())
+		return;
+
+	MCP_TRACE_SCOPE("ActionIndex::Compact");
+	TArray<FActionEntry> Live = MoveTemp(Entries);
+	Entries.Reset();
+	Postings.Reset();
+	OwnerEntries.Reset();
+	RemovedCount = 0;
+	for (FActionEntry& Entry : Live)
+	{
+		if (!Entry.bRemoved)
+			AddEntry(MoveTemp(Entry));
+	}
+}
+
+FString ActionIndex::Normalize(const FString& Text)
+{
+	FString Result;
+	Result.Reserve(Text.Len());
+	for (TCHAR Char : Text)
+	{
+		if (FChar::IsAlnum(Char))
+			Result.AppendChar(FChar::ToLower(Char));
+		else if (!Result.IsEmpty() && Result[Result.Len() - 1] != TEXT(' '))
+			Result.AppendChar(TEXT(' '));
+	}
+	Result.TrimEndInline();
+	return Result;
+}
+
+void ActionIndex::GetTrigrams(const FString& Text, TSet<uint32>& OutTrigrams)
+{
+	// 10 bits per character, exact for ASCII, anything else may share a trigram and is sorted out by scoring
+	for (int32 Index = 0; Index + 2 < Text.Len(); ++Index)
+	{
+		OutTrigrams.Add(((uint32)(Text[Index] & 0x3FF) << 20) | ((uint32)(Text[Index + 1] & 0x3FF) << 10)
+			| (uint32)(Text[Index + 2] & 0x3FF));
+	}
+}
+
+const UObject* ActionIndex::FindPinTypeObject(FName PinCategory, const FString& TypeName)
+{
+	if (TypeName.IsEmpty())
+		return nullptr;
+
+	const UObject* TypeObject = nullptr;
+	if (IsObjectCategory(PinCategory) || PinCategory == UEdGraphSchema_K2::PC_Class
+		|| PinCategory == UEdGraphSchema_K2::PC_SoftClass)
+		TypeObject = ClassUtils::FindClassByName(TypeName);
+	else if (PinCategory == UEdGraphSchema_K2::PC_Struct)
+		TypeObject = FindFirstObject<UScriptStruct>(*TypeName);
+	else if (PinCategory == UEdGraphSchema_K2::PC_Byte || PinCategory == UEdGraphSchema_K2::PC_Enum)
+		TypeObject = FindFirstObject<UEnum>(*TypeName);
+	if (!TypeObject)
+		throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Pin type %s not found"), *TypeName)));
+	return TypeObject;
+}
+
+bool ActionIndex::IsPinCompatible(FName FromCategory, const UObject* FromType, const FActionPin& Pin, bool bFromOutput)
+{
+	// Connections that need a conversion node don't count
+	if (FromCategory == UEdGraphSchema_K2::PC_Wildcard || Pin.Category == UEdGraphSchema_K2::PC_Wildcard)
+		return true;
+	if (FromCategory != Pin.Category && !(IsObjectCategory(FromCategory) && IsObjectCategory(Pin.Category)))
+		return false;
+
+	const UObject* PinType = Pin.TypeObject.Get();
+	if (!FromType || !PinType)
+		return true;
+	const UClass* FromClass = Cast<UClass>(FromType);
+	const UClass* PinClass = Cast<UClass>(PinType);
+	if (FromClass && PinClass)
+	{
+		// Values flow from the output's class into the input's class
+		const UClass* Source = bFromOutput ? FromClass : PinClass;
+		const UClass* Target = bFromOutput ? PinClass : FromClass;
+		return Source->IsChildOf(Target) || Source->ImplementsInterface(Target);
+	}
+	return FromType == PinType;
+}
+
+int32 ActionIndex::ScoreEntry(const FActionEntry& Entry, const FString& Text, int32 SharedTrigrams, int32 QueryTrigrams)
+{
+	if (Text.IsEmpty())
+		return 0;
+
+	int32 Score;
+	if (Entry.SearchName == Text || Entry.SearchFunction == Text)
+		Score = 1000;
+	else if (Entry.SearchName.StartsWith(Text) || Entry.SearchFunction.StartsWith(Text))
+		Score = 800;
+	else if (Entry.SearchName.Contains(TEXT(" ") + Text))
+		Score = 600;
+	else if (Entry.SearchName.Contains(Text) || Entry.SearchFunction.Contains(Text))
+		Score = 400;
+	else
+		Score = QueryTrigrams > 0 ? 300 * SharedTrigrams / QueryTrigrams : 0;
+
+	if (Entry.SearchKeywords.Contains(Text))
+		Score += 100;
+	if (Entry.SearchCategory.Contains(Text))
+		Score += 50;
+	if (Entry.SearchClass.Contains(Text))
+		Score += 50;
+	return Score;
+}
+
+FActionSearchResult ActionIndex::Search(const FActionSearchQuery& Query)
+{
+	MCP_TRACE_SCOPE("ActionIndex::Search");
+	check(IsInGameThread());
+	// The first search builds the database if no action menu has yet, its results fill in over the next frames
+	if (!bSeeded)
+		Seed();
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	const FString Text = Normalize(Query.Text);
+	const FString Category = Normalize(Query.Category);
+	const FName PinCategory = Query.PinCategory.IsEmpty() ? NAME_None : FName(*Query.PinCategory);
+	const UObject* PinType = PinCategory.IsNone() ? nullptr : FindPinTypeObject(PinCategory, Query.PinSubType);
+
+	auto Matches = [&](const FActionEntry& Entry)
+	{
+		if (Entry.bRemoved)
+			return false;
+		if (!Category.IsEmpty() && !Entry.SearchCategory.StartsWith(Category))
+			return false;
+		if (!Query.ClassName.IsEmpty() && !Entry.ClassName.Equals(Query.ClassName, ESearchCase::IgnoreCase)
+			&& !Entry.ClassName.Equals(Query.ClassName + TEXT("_C"), ESearchCase::IgnoreCase))
+			return false;
+		if (!PinCategory.IsNone())
+		{
+			// Actions without pin types, e.g. macros and flow control, can't be checked and are left out
+			if (!Entry.bHasPins)
+				return false;
+			const TArray<FActionPin>& Pins = Query.bFromOutput ? Entry.Inputs : Entry.Outputs;
+			if (!Pins.ContainsByPredicate([&](const FActionPin& Pin)
+			{
+				return IsPinCompatible(PinCategory, PinType, Pin, Query.bFromOutput);
+			}))
+				return false;
+		}
+		return true;
+	};
+
+	TArray<TPair<int32, int32>> Scored; // entry index, score
+	TSet<uint32> QueryTrigrams;
+	GetTrigrams(Text, QueryTrigrams);
+	if (QueryTrigrams.Num() > 0)
+	{
+		// Only entries sharing at least half of the query's trigrams are scored, a typo costs at most three
+		TArray<uint16> Hits;
+		Hits.SetNumZeroed(Entries.Num());
+		for (uint32 Trigram : QueryTrigrams)
+		{
+			if (const TArray<int32>* Posting = Postings.Find(Trigram))
+			{
+				for (int32 Index : *Posting)
+				{
+					++Hits[Index];
+				}
+			}
+		}
+		const int32 Threshold = FMath::Max(1, FMath::DivideAndRoundUp(QueryTrigrams.Num(), 2));
+		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		{
+			if (Hits[Index] >= Threshold && Matches(Entries[Index]))
+				Scored.Add({ Index, ScoreEntry(Entries[Index], Text, Hits[Index], QueryTrigrams.Num()) });
+		}
+	}
+	else
+	{
+		// Too short for a trigram, or no text at all and only the filters apply
+		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		{
+			const FActionEntry& Entry = Entries[Index];
+			if ((Text.IsEmpty() || Entry.SearchText.Contains(Text)) && Matches(Entry))
+				Scored.Add({ Index, ScoreEntry(Entry, Text, 0, 0) });
+		}
+	}
+
+	Scored.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+	{
+		if (A.Value != B.Value)
+			return A.Value > B.Value;
+		return Entries[A.Key].Name.Len() < Entries[B.Key].Name.Len();
+	});
+
+	FActionSearchResult Result;
+	Result.Total = Scored.Num();
+	Result.Indexed = Entries.Num() - RemovedCount;
+	Result.Pending = PendingSet.Num();
+	const int32 Limit = Query.Limit > 0 ? FMath::Min(Query.Limit, Scored.Num()) : Scored.Num();
+	Result.Matches.Reserve(Limit);
+	for (int32 Rank = 0; Rank < Limit; ++Rank)
+	{
+		const FActionEntry& Entry = Entries[Scored[Rank].Key];
+		Result.Matches.Add({ Entry.Name, Entry.Category, Entry.NodeType, Entry.ClassName, Entry.FunctionName, Scored[Rank].Value });
+	}
+	Result.SearchMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+	return Result;
+}
+
+TArray<uint8> ActionIndex::EncodeResult(const FActionSearchResult& Result)
+{
+	MCP_TRACE_SCOPE("ActionIndex::EncodeResult");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Total"), Result.Total);
+	Writer->WriteValue(TEXT("Indexed"), Result.Indexed);
+	Writer->WriteValue(TEXT("Pending"), Result.Pending);
+	Writer->WriteValue(TEXT("Complete"), bSeeded && Result.Pending == 0);
+	Writer->WriteValue(TEXT("SearchMs"), Result.SearchMs);
+	Writer->WriteArrayStart(TEXT("Results"));
+	for (const FActionMatch& Match : Result.Matches)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Name"), Match.Name);
+		Writer->WriteValue(TEXT("Category"), Match.Category);
+		Writer->WriteValue(TEXT("NodeType"), Match.NodeType);
+		if (!Match.ClassName.IsEmpty())
+			Writer->WriteValue(TEXT("Class"), Match.ClassName);
+		if (!Match.FunctionName.IsEmpty())
+			Writer->WriteValue(TEXT("Function"), Match.FunctionName);
+		Writer->WriteValue(TEXT("Score"), Match.Score);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
+
+void ActionIndex::HandleFilesLoaded()
+{
+	bFilesLoaded = true;
+}
+
+void ActionIndex::HandleEntryUpdated(UObject* Owner)
+{
+	const FObjectKey Key(Owner);
+	if (!PendingSet.Contains(Key))
+	{
+		PendingSet.Add(Key);
+		Pending.Add(Key);
+	}
+}
+
+void ActionIndex::HandleEntryRemoved(UObject* Owner)
+{
+	const FObjectKey Key(Owner);
+	RemoveOwner(Key);
+	PendingSet.Remove(Key);
+}
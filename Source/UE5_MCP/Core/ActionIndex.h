@@ -0,0 +1,117 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UObject/ObjectKey.h"
+#include <stdexcept>
+
+class UBlueprintNodeSpawner;
+
+struct FActionSearchQuery
+{
+	FString Text; // words of the name, keywords, category or class, typos are tolerated
+	FString Category; // only actions whose category starts with this, e.g. 'Math|Vector'
+	FString ClassName; // only functions declared by this class
+	// Only actions with a pin that can connect to the pin being dragged from, e.g. 'object' and 'Actor'
+	FString PinCategory;
+	FString PinSubType; // class, struct or enum name of the dragged pin
+	bool bFromOutput = true; // the dragged pin is an output, so the action needs a matching input
+	int32 Limit = 20;
+};
+
+struct FActionMatch
+{
+	FString Name;
+	FString Category;
+	FString NodeType;
+	FString ClassName; // function actions, the class to call the function from
+	FString FunctionName;
+	int32 Score = 0;
+};
+
+struct FActionSearchResult
+{
+	TArray<FActionMatch> Matches;
+	int32 Total = 0; // matches before the limit
+	int32 Indexed = 0; // actions in the index
+	int32 Pending = 0; // database entries still waiting to be indexed
+	double SearchMs = 0.0;
+};
+
+// Search index over the editor's Blueprint action database: every function, macro, event and node an agent can add
+// Building the database takes seconds, so it is left to the editor's first action menu or the first search,
+// whichever comes first. Its entries are then indexed a few milliseconds per frame, and the entries it refreshes
+// or removes, e.g. after a Blueprint compile, are indexed again. Names, keywords, category and class
+// are indexed by trigram, so a query only scores the actions sharing most of its trigrams
+class ActionIndex
+{
+public:
+	static void Initialize();
+	static void Shutdown();
+
+	// Game thread only
+	static FActionSearchResult Search(const FActionSearchQuery& Query);
+
+	static TArray<uint8> EncodeResult(const FActionSearchResult& Result);
+
+private:
+	struct FActionPin
+	{
+		FName Category;
+		TWeakObjectPtr<UObject> TypeObject;
+	};
+
+	struct FActionEntry
+	{
+		FObjectKey Owner; // database key the action was registered under
+		FString Name;
+		FString Category;
+		FString NodeType;
+		FString ClassName;
+		FString FunctionName;
+		// Lower case, word separators collapsed to single spaces
+		FString SearchName;
+		FString SearchFunction;
+		FString SearchKeywords;
+		FString SearchCategory;
+		FString SearchClass;
+		FString SearchText; // all of the above, what the trigrams come from
+		TArray<FActionPin> Inputs; // function and variable actions only, the target included
+		TArray<FActionPin> Outputs;
+		bool bHasPins = false;
+		bool bRemoved = false;
+	};
+
+	static bool Tick(float DeltaTime);
+	// Queues every database entry, building the database if the editor hasn't yet
+	static void Seed();
+	static void IndexOwner(const FObjectKey& Owner);
+	static void AddAction(const FObjectKey& Owner, const UBlueprintNodeSpawner* Spawner);
+	static void AddEntry(FActionEntry&& Entry);
+	static void RemoveOwner(const FObjectKey& Owner);
+	// Drops removed entries and rebuilds the postings once they make up half the index
+	static void Compact();
+
+	static FString Normalize(const FString& Text);
+	static void GetTrigrams(const FString& Text, TSet<uint32>& OutTrigrams);
+	static const UObject* FindPinTypeObject(FName PinCategory, const FString& TypeName);
+	static bool IsPinCompatible(FName FromCategory, const UObject* FromType, const FActionPin& Pin, bool bFromOutput);
+	static int32 ScoreEntry(const FActionEntry& Entry, const FString& Text, int32 SharedTrigrams, int32 QueryTrigrams);
+
+	static void HandleFilesLoaded();
+	static void HandleEntryUpdated(UObject* Owner);
+	static void HandleEntryRemoved(UObject* Owner);
+
+	static TArray<FActionEntry> Entries;
+	static TMap<uint32, TArray<int32>> Postings; // trigram to entry indices
+	static TMap<FObjectKey, TArray<int32>> OwnerEntries;
+	static TArray<FObjectKey> Pending;
+	static TSet<FObjectKey> PendingSet;
+	static int32 RemovedCount;
+	static bool bFilesLoaded;
+	static bool bSeeded;
+
+	static FTSTicker::FDelegateHandle TickerHandle;
+	static FDelegateHandle FilesLoadedHandle;
+	static FDelegateHandle EntryUpdatedHandle;
+	static FDelegateHandle EntryRemovedHandle;
+};
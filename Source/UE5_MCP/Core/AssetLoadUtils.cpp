@@ -0,0 +1,123 @@
+﻿#include "AssetLoadUtils.h"
+#include "MCPTrace.h"
+
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "Misc/PackageName.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/Package.h"
+
+TSet<FName> AssetLoadUtils::PendingPackages;
+TSet<FName> AssetLoadUtils::FailedPackages;
+
+FString AssetLoadUtils::ToObjectPath(const FString& Path)
+{
+	// Object property values may come in export form, Class'/Game/A.A'
+	FString ObjectPath = FPackageName::ExportTextPathToObjectPath(Path);
+	// '/Game/A' names the package, the asset in it shares its name
+	if (!ObjectPath.Contains(TEXT(".")))
+		ObjectPath += TEXT(".") + FPackageName::GetShortName(ObjectPath);
+	return ObjectPath;
+}
+
+TArray<FPrefetchStatus> AssetLoadUtils::Prefetch(const TArray<FString>& Paths)
+{
+	MCP_TRACE_SCOPE("AssetLoadUtils::Prefetch");
+	check(IsInGameThread());
+	TArray<FPrefetchStatus> Statuses;
+	Statuses.Reserve(Paths.Num());
+	for (const FString& Path : Paths)
+	{
+		FPrefetchStatus& Status = Statuses.AddDefaulted_GetRef();
+		Status.Path = Path;
+
+		const FString ObjectPath = ToObjectPath(Path);
+		const FName PackageName(FPackageName::ObjectPathToPackageName(ObjectPath));
+		if (PendingPackages.Contains(PackageName))
+		{
+			Status.Status = TEXT("Loading");
+			continue;
+		}
+		if (FindLoadedObject(UObject::StaticClass(), ObjectPath))
+		{
+			Status.Status = TEXT("Loaded");
+			continue;
+		}
+		// A failure is reported once, the next prefetch of the path tries again
+		if (FailedPackages.Remove(PackageName) > 0)
+		{
+			Status.Status = TEXT("Failed");
+			continue;
+		}
+		if (!FPackageName::DoesPackageExist(PackageName.ToString()))
+		{
+			Status.Status = TEXT("Missing");
+			continue;
+		}
+
+		PendingPackages.Add(PackageName);
+		LoadPackageAsync(PackageName.ToString(), FLoadPackageAsyncDelegate::CreateStatic(&AssetLoadUtils::HandlePackageLoaded));
+		Status.Status = TEXT("Loading");
+	}
+	return Statuses;
+}
+
+void AssetLoadUtils::HandlePackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+{
+	PendingPackages.Remove(PackageName);
+	if (Result != EAsyncLoadingResult::Succeeded || !Package)
+		FailedPackages.Add(PackageName);
+}
+
+UObject* AssetLoadUtils::FindLoadedObject(UClass* Class, const FString& Path)
+{
+	MCP_TRACE_SCOPE("AssetLoadUtils::FindLoadedObject");
+	UObject* Object = StaticFindObject(Class, nullptr, *ToObjectPath(Path));
+	// Objects of a package that is still loading exist before they are serialized
+	if (!Object || Object->HasAnyFlags(RF_NeedLoad | RF_NeedPostLoad)
+		|| Object->HasAnyInternalFlags(EInternalObjectFlags_AsyncLoadingMask))
+		return nullptr;
+	return Object;
+}
+
+UObject* AssetLoadUtils::LoadObject(UClass* Class, const FString& Path)
+{
+	MCP_TRACE_SCOPE("AssetLoadUtils::LoadObject");
+	if (UObject* Object = FindLoadedObject(Class, Path))
+		return Object;
+
+	Metrics::FScopedPhase Phase(EMetricPhase::Load);
+	return StaticLoadObject(Class, nullptr, *Path);
+}
+
+TArray<uint8> AssetLoadUtils::EncodePrefetch(const TArray<FPrefetchStatus>& Statuses)
+{
+	MCP_TRACE_SCOPE("AssetLoadUtils::EncodePrefetch");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	int32 Ready = 0;
+	for (const FPrefetchStatus& Status : Statuses)
+	{
+		if (Status.Status == TEXT("Loaded"))
+			++Ready;
+	}
+
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Ready"), Ready == Statuses.Num());
+	Writer->WriteValue(TEXT("Loaded"), Ready);
+	Writer->WriteValue(TEXT("Pending"), PendingPackages.Num());
+	Writer->WriteArrayStart(TEXT("Assets"));
+	for (const FPrefetchStatus& Status : Statuses)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Path"), Status.Path);
+		Writer->WriteValue(TEXT("Status"), Status.Status);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
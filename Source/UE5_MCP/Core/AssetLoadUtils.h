@@ -0,0 +1,37 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "UObject/UObjectGlobals.h"
+#include <stdexcept>
+
+struct FPrefetchStatus
+{
+	FString Path;
+	FString Status; // Loaded, Loading, Failed or Missing
+};
+
+// Loads assets by the paths the API takes, '/Game/BP' or '/Game/BP.BP'
+// Prefetch starts async loads so a later synchronous load finds the object already in memory
+class AssetLoadUtils
+{
+public:
+	// Starts an async load of every package that isn't loaded or loading yet, and reports where each one is
+	// Call it again with the same paths to poll for readiness
+	static TArray<FPrefetchStatus> Prefetch(const TArray<FString>& Paths);
+
+	// Returns the object when it is fully loaded, without touching the disk
+	static UObject* FindLoadedObject(UClass* Class, const FString& Path);
+
+	// FindLoadedObject first, a synchronous load only when the object isn't in memory yet
+	// A load still in flight from Prefetch is finished rather than started again
+	static UObject* LoadObject(UClass* Class, const FString& Path);
+
+	static TArray<uint8> EncodePrefetch(const TArray<FPrefetchStatus>& Statuses);
+
+private:
+	static FString ToObjectPath(const FString& Path);
+
+	static void HandlePackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result);
+
+	static TSet<FName> PendingPackages;
+	static TSet<FName> FailedPackages;
+};
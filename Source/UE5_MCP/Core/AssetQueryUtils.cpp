@@ -0,0 +1,173 @@
+﻿#include "AssetQueryUtils.h"
+#include "MCPTrace.h"
+
+#include "ClassUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Blueprint.h"
+#include "Misc/PackageName.h"
+#include "Serialization/MemoryWriter.h"
+
+FTopLevelAssetPath AssetQueryUtils::ResolveClassPath(const FString& ClassName)
+{
+	// Blueprint classes are named by their generated class so they don't have to be loaded
+	if (ClassName.StartsWith(TEXT("/")) && !ClassName.StartsWith(TEXT("/Script/")))
+	{
+		FString ObjectPath = FPackageName::ExportTextPathToObjectPath(ClassName);
+		if (!ObjectPath.Contains(TEXT(".")))
+			ObjectPath += TEXT(".") + FPackageName::GetShortName(ObjectPath);
+		if (!ObjectPath.EndsWith(TEXT("_C")))
+			ObjectPath += TEXT("_C");
+		return FTopLevelAssetPath(ObjectPath);
+	}
+
+	UClass* Class = ClassUtils::FindClassByName(ClassName);
+	if (!Class)
+		throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Class %s not found"), *ClassName)));
+	return Class->GetClassPathName();
+}
+
+FString AssetQueryUtils::GetClassTag(const FAssetData& Asset, FName Tag)
+{
+	// Class tags are stored in export form, /Script/CoreUObject.Class'/Script/Engine.Actor'
+	FString Value;
+	if (!Asset.GetTagValue(Tag, Value))
+		return FString();
+	return FPackageName::ExportTextPathToObjectPath(Value);
+}
+
+bool AssetQueryUtils::ImplementsInterfaces(const FAssetData& Asset, const TArray<FString>& Interfaces)
+{
+	if (Interfaces.IsEmpty())
+		return true;
+
+	FString Implemented;
+	if (!Asset.GetTagValue(FBlueprintTags::ImplementedInterfaces, Implemented))
+		return false;
+
+	// The tag is the exported interface list, each entry holds the interface class path
+	for (const FString& Interface : Interfaces)
+	{
+		FString Name = Interface;
+		int32 Separator;
+		if (Name.FindLastChar('.', Separator) || Name.FindLastChar('/', Separator))
+			Name = Name.Mid(Separator + 1);
+		if (!Implemented.Contains(TEXT(".") + Name + TEXT("'")) && !Implemented.Contains(TEXT(".") + Name + TEXT("_C'")))
+			return false;
+	}
+	return true;
+}
+
+bool AssetQueryUtils::MatchesTags(const FAssetData& Asset, const TMap<FString, FString>& Tags)
+{
+	for (const auto& [Tag, Expected] : Tags)
+	{
+		FString Value;
+		if (!Asset.GetTagValue(FName(*Tag), Value) || !Value.Equals(Expected, ESearchCase::IgnoreCase))
+			return false;
+	}
+	return true;
+}
+
+FBlueprintListResult AssetQueryUtils::ListBlueprints(const FListBlueprintsReq& Query)
+{
+	MCP_TRACE_SCOPE("AssetQueryUtils::ListBlueprints");
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	if (!Query.PathPrefix.IsEmpty())
+	{
+		FString PathPrefix = Query.PathPrefix;
+		PathPrefix.RemoveFromEnd(TEXT("/"));
+		Filter.PackagePaths.Add(FName(*PathPrefix));
+		Filter.bRecursivePaths = true;
+	}
+
+	// Derived classes come from the registry's class hierarchy, which covers unloaded Blueprints
+	TSet<FTopLevelAssetPath> DerivedClasses;
+	if (!Query.ParentClass.IsEmpty())
+	{
+		const FTopLevelAssetPath ParentPath = ResolveClassPath(Query.ParentClass);
+		AssetRegistry.GetDerivedClassNames({ ParentPath }, {}, DerivedClasses);
+		DerivedClasses.Remove(ParentPath);
+	}
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	FBlueprintListResult Result;
+	Result.bComplete = !AssetRegistry.IsLoadingAssets();
+	TArray<FBlueprintListing> Matches;
+	for (const FAssetData& Asset : Assets)
+	{
+		if (!Query.ParentClass.IsEmpty()
+			&& !DerivedClasses.Contains(FTopLevelAssetPath(GetClassTag(Asset, FBlueprintTags::GeneratedClassPath))))
+			continue;
+		if (!ImplementsInterfaces(Asset, Query.Interfaces) || !MatchesTags(Asset, Query.Tags))
+			continue;
+
+		FBlueprintListing& Listing = Matches.AddDefaulted_GetRef();
+		Listing.Path = Asset.PackageName.ToString();
+		Listing.Name = Asset.AssetName.ToString();
+		Listing.ParentClass = GetClassTag(Asset, FBlueprintTags::ParentClassPath);
+		Listing.NativeParentClass = GetClassTag(Asset, FBlueprintTags::NativeParentClassPath);
+		Asset.GetTagValue(FBlueprintTags::BlueprintType, Listing.BlueprintType);
+		FString DataOnly;
+		Listing.bDataOnly = Asset.GetTagValue(FBlueprintTags::IsDataOnly, DataOnly) && DataOnly.ToBool();
+	}
+
+	auto Key = [&Query](const FBlueprintListing& Listing) -> const FString&
+	{
+		if (Query.SortBy == TEXT("Path"))
+			return Listing.Path;
+		if (Query.SortBy == TEXT("ParentClass"))
+			return Listing.ParentClass;
+		return Listing.Name;
+	};
+	Matches.Sort([&](const FBlueprintListing& A, const FBlueprintListing& B)
+	{
+		const int32 Order = Key(A).Compare(Key(B), ESearchCase::IgnoreCase);
+		if (Order != 0)
+			return Query.bDescending ? Order > 0 : Order < 0;
+		return A.Path < B.Path;
+	});
+
+	Result.Total = Matches.Num();
+	const int32 Offset = FMath::Clamp(Query.Offset, 0, Matches.Num());
+	const int32 Count = Query.Limit > 0 ? FMath::Min(Query.Limit, Matches.Num() - Offset) : Matches.Num() - Offset;
+	Result.Blueprints.Append(Matches.GetData() + Offset, Count);
+	return Result;
+}
+
+TArray<uint8> AssetQueryUtils::EncodeList(const FBlueprintListResult& Result, int32 Offset)
+{
+	MCP_TRACE_SCOPE("AssetQueryUtils::EncodeList");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Total"), Result.Total);
+	Writer->WriteValue(TEXT("Offset"), FMath::Clamp(Offset, 0, Result.Total));
+	Writer->WriteValue(TEXT("Complete"), Result.bComplete);
+	Writer->WriteArrayStart(TEXT("Blueprints"));
+	for (const FBlueprintListing& Listing : Result.Blueprints)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Path"), Listing.Path);
+		Writer->WriteValue(TEXT("Name"), Listing.Name);
+		Writer->WriteValue(TEXT("ParentClass"), Listing.ParentClass);
+		Writer->WriteValue(TEXT("NativeParentClass"), Listing.NativeParentClass);
+		Writer->WriteValue(TEXT("BlueprintType"), Listing.BlueprintType);
+		Writer->WriteValue(TEXT("DataOnly"), Listing.bDataOnly);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "UE5_MCP/API/DTO/ListBlueprintsReq.h"
+#include <stdexcept>
+
+struct FAssetData;
+
+struct FBlueprintListing
+{
+	FString Path;
+	FString Name;
+	FString ParentClass;
+	FString NativeParentClass;
+	FString BlueprintType;
+	bool bDataOnly = false;
+};
+
+struct FBlueprintListResult
+{
+	TArray<FBlueprintListing> Blueprints; // the requested page
+	int32 Total = 0; // matches before paging
+	bool bComplete = true; // false while the asset registry is still scanning
+};
+
+// Answers asset queries from the asset registry's tag data, nothing is loaded
+class AssetQueryUtils
+{
+public:
+	static FBlueprintListResult ListBlueprints(const FListBlueprintsReq& Query);
+
+	static TArray<uint8> EncodeList(const FBlueprintListResult& Result, int32 Offset);
+
+private:
+	// Class path of a native class name or a Blueprint path, e.g. Actor or /Game/BP_Base
+	static FTopLevelAssetPath ResolveClassPath(const FString& ClassName);
+
+	static bool ImplementsInterfaces(const FAssetData& Asset, const TArray<FString>& Interfaces);
+	static bool MatchesTags(const FAssetData& Asset, const TMap<FString, FString>& Tags);
+
+	static FString GetClassTag(const FAssetData& Asset, FName Tag);
+};
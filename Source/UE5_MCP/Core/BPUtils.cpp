@@ -1,6 +1,11 @@
 ﻿#include "BPUtils.h"
+#include "MCPTrace.h"
 
+#include "AssetLoadUtils.h"
+#include "CallSiteUtils.h"
+#include "ChangeEvents.h"
 #include "ClassUtils.h"
+#include "Metrics.h"
 #include "Kismet2/BlueprintEditorUtils.h"
 #include "Kismet2/KismetEditorUtilities.h"
 #include "EdGraphSchema_K2.h"
@@ -22,18 +27,40 @@
 
 // TODO: use skeleton generated class or use generated class directly + compile after modification ? 
 
+int32 BPUtils::DeferCompileDepth = 0;
+TArray<TWeakObjectPtr<UBlueprint>> BPUtils::DeferredCompiles;
+
+BPUtils::FScopedDeferCompile::FScopedDeferCompile(bool* bOutCompiled)
+    : CompiledResult(bOutCompiled)
+{
+    check(IsInGameThread());
+    ++DeferCompileDepth;
+    if (CompiledResult)
+        *CompiledResult = false;
+}
+
+BPUtils::FScopedDeferCompile::~FScopedDeferCompile()
+{
+    if (--DeferCompileDepth > 0)
+        return;
+
+    TArray<TWeakObjectPtr<UBlueprint>> Blueprints = MoveTemp(DeferredCompiles);
+    for (const TWeakObjectPtr<UBlueprint>& Blueprint : Blueprints)
+    {
+        if (Blueprint.IsValid())
+        {
+            CompileBlueprint(Blueprint.Get());
+            if (CompiledResult)
+                *CompiledResult = true;
+        }
+    }
+}
+
 UEdGraph* BPUtils::CreateFunctionGraph(UBlueprint* Blueprint, const FString& FunctionName)
 {
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
     
-    UClass* BPClass = Blueprint->GeneratedClass;
-    if (!BPClass)
-        throw std::runtime_error("Blueprint's GeneratedClass is null, please compile the Blueprint first");
-    
-    UFunction* NewFunc = NewObject<UFunction>(BPClass, *FunctionName, RF_Public | RF_Transient);
-    NewFunc->SetFlags(RF_Public);
-
     UEdGraph* NewGraph = FBlueprintEditorUtils::CreateNewGraph(
         Blueprint,
         *FunctionName,
@@ -41,7 +68,8 @@ UEdGraph* BPUtils::CreateFunctionGraph(UBlueprint* Blueprint, const FString& Fun
         UEdGraphSchema_K2::StaticClass()
     );
 
-    FBlueprintEditorUtils::AddFunctionGraph<UFunction>(Blueprint, NewGraph, true, NewFunc);
+    // No signature to copy, so the Blueprint doesn't need a compiled class yet
+    FBlueprintEditorUtils::AddFunctionGraph<UFunction>(Blueprint, NewGraph, true, nullptr);
     return NewGraph;
 }
 
@@ -50,6 +78,7 @@ void BPUtils::AddFunctionGraph(UBlueprint* Blueprint,
                                      const FString& FunctionInputSignature,
                                      const FString& FunctionOutputSignature)
 {
+    MCP_TRACE_SCOPE("BPUtils::AddFunctionGraph");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
     
@@ -74,11 +103,12 @@ void BPUtils::AddFunctionGraph(UBlueprint* Blueprint,
     PinUtils::SetupFunctionPins(ReturnNode, FunctionOutputSignature, true);
     
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    CompileBlueprint(Blueprint);
 }
 
-void BPUtils::RemoveFunctionGraph(UBlueprint* Blueprint, const FString& FunctionName)
+void BPUtils::RemoveFunctionGraph(UBlueprint* Blueprint, const FString& FunctionName, FCallSiteReport* CallSiteReport)
 {
+    MCP_TRACE_SCOPE("BPUtils::RemoveFunctionGraph");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -87,17 +117,28 @@ void BPUtils::RemoveFunctionGraph(UBlueprint* Blueprint, const FString& Function
     if (!FunctionGraph)
         throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Function %s does not exist in the Blueprint"), *FunctionName)));
     
+    // Calls are found while the function still exists
+    TArray<FCallSites> CallSites;
+    if (CallSiteReport)
+        CallSites = CallSiteUtils::FindCallSites(Blueprint, FunctionName, *CallSiteReport);
+
     // Remove the graph from the Blueprint
     FBlueprintEditorUtils::RemoveGraph(Blueprint, FunctionGraph, EGraphRemoveFlags::Recompile);
 
     // Mark Blueprint as modified
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    if (CallSiteReport)
+    {
+        CallSiteUtils::UpdateCallSites(Blueprint, CallSites, true, *CallSiteReport);
+        return;
+    }
+    CompileBlueprint(Blueprint);
 }
 
 void BPUtils::EditFunctionGraph(UBlueprint* Blueprint, const FString& FunctionName,
-    const FString& FunctionInputSignature, const FString& FunctionOutputSignature)
+    const FString& FunctionInputSignature, const FString& FunctionOutputSignature, FCallSiteReport* CallSiteReport)
 {
+    MCP_TRACE_SCOPE("BPUtils::EditFunctionGraph");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -122,11 +163,20 @@ void BPUtils::EditFunctionGraph(UBlueprint* Blueprint, const FString& FunctionNa
     PinUtils::CleanFunctionPins(EntryNode, ReturnNode);
     PinUtils::SetupFunctionPins(EntryNode, FunctionInputSignature, false);
     PinUtils::SetupFunctionPins(ReturnNode, FunctionOutputSignature, true);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    if (CallSiteReport)
+    {
+        // The skeleton class carries the new signature the calls in this Blueprint are rebuilt against
+        FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+        CallSiteUtils::UpdateCallSites(Blueprint, CallSiteUtils::FindCallSites(Blueprint, FunctionName, *CallSiteReport),
+            false, *CallSiteReport);
+        return;
+    }
+    CompileBlueprint(Blueprint);
 }
 
 UEdGraph* BPUtils::GetFunctionGraph(UBlueprint* Blueprint, const FString& FunctionName)
 {
+    MCP_TRACE_SCOPE("BPUtils::GetFunctionGraph");
     if (!Blueprint)
         return nullptr;
 
@@ -187,18 +237,20 @@ void BPUtils::GetOrAddEntryAndReturnNodesOfFunctionGraph(UEdGraph* Graph, UK2Nod
 
 UBlueprint* BPUtils::LoadBlueprint(const FString& Path)
 {
-    UObject* LoadedObj = StaticLoadObject(UBlueprint::StaticClass(), nullptr, *Path);
-    return Cast<UBlueprint>(LoadedObj);
+    MCP_TRACE_SCOPE("BPUtils::LoadBlueprint");
+    return Cast<UBlueprint>(AssetLoadUtils::LoadObject(UBlueprint::StaticClass(), Path));
 }
 
 UEdGraph* BPUtils::GetEventGraph(UBlueprint* Blueprint)
 {
+    MCP_TRACE_SCOPE("BPUtils::GetEventGraph");
     return GetEventGraph(Blueprint, "EventGraph");
 }
 
 
 UEdGraph* BPUtils::GetEventGraph(UBlueprint* Blueprint, const FString& GraphName)
 {
+    MCP_TRACE_SCOPE("BPUtils::GetEventGraph");
     if (!Blueprint)
         return nullptr;
 
@@ -215,14 +267,42 @@ UEdGraph* BPUtils::GetEventGraph(UBlueprint* Blueprint, const FString& GraphName
 
 void BPUtils::CompileBlueprint(UBlueprint* Blueprint)
 {
+    MCP_TRACE_SCOPE("BPUtils::CompileBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
    
+    if (DeferCompileDepth > 0)
+    {
+        DeferredCompiles.AddUnique(Blueprint);
+        return;
+    }
+
+    Metrics::FScopedPhase Phase(EMetricPhase::Compile);
+    TRACE_COUNTER_INCREMENT(UE5_MCP_CompilesTriggered);
     FKismetEditorUtilities::CompileBlueprint(Blueprint);
 }
 
+FString BPUtils::GetCompileStatusName(const UBlueprint* Blueprint)
+{
+    if (!Blueprint)
+        throw std::runtime_error("Blueprint is null");
+
+    switch (Blueprint->Status)
+    {
+    case BS_UpToDate:
+        return TEXT("UpToDate");
+    case BS_UpToDateWithWarnings:
+        return TEXT("UpToDateWithWarnings");
+    case BS_Error:
+        return TEXT("Error");
+    default:
+        return TEXT("Dirty");
+    }
+}
+
 TArray<FString> BPUtils::GetBlueprintVariables(UBlueprint* Blueprint, bool bIncludeAll)
 {
+    MCP_TRACE_SCOPE("BPUtils::GetBlueprintVariables");
     TArray<FString> Vars;
     TArray<FString> SeenVarNames;
 
@@ -272,6 +352,7 @@ TArray<FString> BPUtils::GetBlueprintVariables(UBlueprint* Blueprint, bool bIncl
 
 TArray<FString> BPUtils::GetBlueprintFunctions(UBlueprint* Blueprint)
 {
+    MCP_TRACE_SCOPE("BPUtils::GetBlueprintFunctions");
     TArray<FString> Funcs;
 
     if (!Blueprint)
@@ -328,6 +409,7 @@ void BPUtils::AddVariableToBlueprint(
     const FString& VarSignature,
     const FString &DefaultValue = FString())
 {
+    MCP_TRACE_SCOPE("BPUtils::AddVariableToBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
     
@@ -352,11 +434,12 @@ void BPUtils::AddVariableToBlueprint(
 
     // Mark blueprint dirty
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    CompileBlueprint(Blueprint);
 }
 
 void BPUtils::RenameVariableInBlueprint(UBlueprint* Blueprint, const FString& OldVarName, const FString& NewVarName)
 {
+    MCP_TRACE_SCOPE("BPUtils::RenameVariableInBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
     
@@ -368,23 +451,25 @@ void BPUtils::RenameVariableInBlueprint(UBlueprint* Blueprint, const FString& Ol
 
     FBlueprintEditorUtils::RenameMemberVariable(Blueprint, OldName, NewName);
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    CompileBlueprint(Blueprint);
 }
 
 void BPUtils::DeleteVariableFromBlueprint(UBlueprint* Blueprint, const FString& VarName)
 {
+    MCP_TRACE_SCOPE("BPUtils::DeleteVariableFromBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
     FName VarFName(*VarName);
     FBlueprintEditorUtils::RemoveMemberVariable(Blueprint, VarFName);    
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    CompileBlueprint(Blueprint);
 }
 
 void BPUtils::SetVariableDefaultValueInBlueprint(UBlueprint* Blueprint, const FString& VarName,
     const FString& DefaultValue)
 {
+    MCP_TRACE_SCOPE("BPUtils::SetVariableDefaultValueInBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -393,137 +478,109 @@ void BPUtils::SetVariableDefaultValueInBlueprint(UBlueprint* Blueprint, const FS
     if (!Var)
         throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Variable %s not found in Blueprint"), *VarName)));
 
+    const FString OldDefaultValue = Var->DefaultValue;
     Var->DefaultValue = DefaultValue;
 
+    UObject* CDO = Blueprint->GeneratedClass ? Blueprint->GeneratedClass->GetDefaultObject(false) : nullptr;
+    bool bApplied;
+    try
+    {
+        bApplied = ApplyDefaultsWithoutCompile(Blueprint, CDO, { VarName }, [&]()
+        {
+            FProperty* Property = CDO->GetClass()->FindPropertyByName(*VarName);
+            if (!FBlueprintEditorUtils::PropertyValueFromString(Property, DefaultValue, reinterpret_cast<uint8*>(CDO), CDO))
+                throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Invalid default value %s for variable %s"), *DefaultValue, *VarName)));
+        });
+    }
+    catch (std::runtime_error&)
+    {
+        // Keep the invalid value out of the Blueprint, the next compile would fail on it
+        Var->DefaultValue = OldDefaultValue;
+        throw;
+    }
+
     FBlueprintEditorUtils::ValidateBlueprintChildVariables(Blueprint, *VarName);
+    ChangeEvents::MarkPropertyChanged(Blueprint, TEXT("Default"), VarName);
+    if (bApplied)
+        return;
+
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    CompileBlueprint(Blueprint);
 }
 
-#include "Serialization/JsonWriter.h"
-
-FString BPUtils::GetBlueprintGraphJson(UEdGraph* Graph)
+bool BPUtils::CanEditDefaultsWithoutCompile(const UBlueprint* Blueprint)
 {
-    if (!Graph)
-        throw std::runtime_error("Graph is null");
-    
-    FString Output;
-    // Serialize graph to JSON
-    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+    if (!Blueprint || !Blueprint->GeneratedClass || Blueprint->bBeingCompiled)
+        return false;
+    if (Blueprint->Status != BS_UpToDate && Blueprint->Status != BS_UpToDateWithWarnings)
+        return false;
+    // A compile already queued for this Blueprint would overwrite the defaults anyway
+    return !DeferredCompiles.Contains(Blueprint);
+}
 
-    Writer->WriteArrayStart();
+bool BPUtils::ApplyDefaultsWithoutCompile(UBlueprint* Blueprint, UObject* Archetype,
+    const TArray<FString>& PropertyNames, TFunctionRef<void()> Apply)
+{
+    MCP_TRACE_SCOPE("BPUtils::ApplyDefaultsWithoutCompile");
+    if (!Archetype || !CanEditDefaultsWithoutCompile(Blueprint))
+        return false;
 
-    for (UEdGraphNode* Node : Graph->Nodes)
+    // Instanced subobjects can't be copied to instances by value, those still go through the compile
+    TArray<FProperty*> Properties;
+    for (const FString& PropertyName : PropertyNames)
     {
-        if (!Node)
-            continue;
-        
-        Writer->WriteObjectStart();
-
-        Writer->WriteValue(FString(TEXT("Id")), Node->NodeGuid.ToString());
-        Writer->WriteValue(FString(TEXT("Type")), *Node->GetClass()->GetName());
-        
-        Writer->WriteArrayStart(FString("Pins"));
-        for (UEdGraphPin* Pin : Node->Pins)
-        {
-            Writer->WriteObjectStart();
-            Writer->WriteValue(FString(TEXT("Name")), Pin->GetName());
-
-            auto Dir =  Pin->Direction == EGPD_Input ? FString(TEXT("In")) : FString(TEXT("Out"));
-
-            FString Info;
-            FString Container;
-            switch (Pin->PinType.ContainerType)
-            {
-                case EPinContainerType::Array:
-                    Container = TEXT("TArray");
-                    break;
-                case EPinContainerType::Set:
-                    Container = TEXT("TSet");
-                    break;
-                case EPinContainerType::Map:
-                    Container = TEXT("TMap");
-                    break;
-                default:
-                    Container = TEXT("");
-                    break;
-            }
-            if (Container.IsEmpty())
-                if (Pin->PinType.PinSubCategory.IsNone())
-                    Info = FString::Printf(TEXT("%s-%s"), *Pin->PinType.PinCategory.ToString(), *Dir);
-                else
-                    Info = FString::Printf(TEXT("%s(%s)-%s"), *Pin->PinType.PinCategory.ToString(),
-                        *Pin->PinType.PinSubCategory.ToString(),
-                        *Dir);
-            else
-            {
-                if (Pin->PinType.PinSubCategory.IsNone())
-                    Info = FString::Printf(TEXT("%s<%s>-%s"),
-                        *Container, *Pin->PinType.PinCategory.ToString(), *Dir);
-                else
-                    Info = FString::Printf(TEXT("%s<%s(%s)>-%s"),
-                        *Container,
-                        *Pin->PinType.PinCategory.ToString(),
-                        *Pin->PinType.PinSubCategory.ToString(),
-                        *Dir);
-            }
+        FProperty* Property = Archetype->GetClass()->FindPropertyByName(*PropertyName);
+        if (!Property || Property->ContainsInstancedObjectProperty())
+            return false;
+        Properties.AddUnique(Property);
+    }
 
-            Writer->WriteValue(FString(TEXT("Inf")), Info);
-            Writer->WriteValue(FString(TEXT("DefaultVal")), Pin->DefaultValue);
+    TArray<FString> OldValues;
+    for (const FProperty* Property : Properties)
+    {
+        FString& OldValue = OldValues.AddDefaulted_GetRef();
+        Property->ExportTextItem_InContainer(OldValue, Archetype, nullptr, nullptr, PPF_None);
+    }
 
-            Writer->WriteArrayStart(FString(TEXT("Link")));
-            for (UEdGraphPin* Linked : Pin->LinkedTo)
-            {
-                Writer->WriteObjectStart();
-                Writer->WriteValue(FString(TEXT("Id")), Linked->GetOwningNode()->NodeGuid.ToString());
-                Writer->WriteValue(FString(TEXT("PinName")), Linked->GetName());
-                Writer->WriteObjectEnd();
-            }
-            Writer->WriteArrayEnd();
+    TArray<UObject*> Instances;
+    Archetype->GetArchetypeInstances(Instances);
 
-            Writer->WriteObjectEnd();
-        }
-        Writer->WriteArrayEnd();
-        
-        Writer->WriteObjectStart(TEXT("Meta"));
+    Archetype->Modify();
+    Apply();
 
-        if (auto FuncNode = Cast<UK2Node_CallFunction>(Node))
-        {
-            Writer->WriteValue(TEXT("IsPure"), FuncNode->IsNodePure());
-            Writer->WriteValue(TEXT("FuncName"), FuncNode->FunctionReference.GetMemberName().ToString());
-            Writer->WriteValue(TEXT("FuncClass"), FuncNode->FunctionReference.GetMemberParentClass() ? FuncNode->FunctionReference.GetMemberParentClass()->GetName() : TEXT(""));
-        }
-        else if (auto EventNode = Cast<UK2Node_Event>(Node))
-        {
-            Writer->WriteValue(TEXT("EventName"), EventNode->EventReference.GetMemberName().ToString());
-            Writer->WriteValue(TEXT("EventClass"), EventNode->EventReference.GetMemberParentClass() ? EventNode->EventReference.GetMemberParentClass()->GetName() : TEXT(""));
-        }
-        else if (auto CustomEventNode = Cast<UK2Node_CustomEvent>(Node))
-        {
-            Writer->WriteValue(TEXT("EventName"), CustomEventNode->CustomFunctionName.ToString());
-        }
-        else if (auto VarGetNode = Cast<UK2Node_VariableGet>(Node))
-        {
-            Writer->WriteValue(TEXT("VarName"), VarGetNode->VariableReference.GetMemberName().ToString());
-            Writer->WriteValue(TEXT("VarClass"), VarGetNode->VariableReference.GetMemberParentClass() ? VarGetNode->VariableReference.GetMemberParentClass()->GetName() : TEXT(""));
-            // TODO: add Variable type ?
-        }
-        else if (auto VarSetNode = Cast<UK2Node_VariableSet>(Node))
+    for (UObject* Instance : Instances)
+    {
+        for (int32 Index = 0; Index < Properties.Num(); ++Index)
         {
-            Writer->WriteValue(TEXT("VarName"), VarSetNode->VariableReference.GetMemberName().ToString());
-            Writer->WriteValue(TEXT("VarClass"), VarSetNode->VariableReference.GetMemberParentClass() ? VarSetNode->VariableReference.GetMemberParentClass()->GetName() : TEXT(""));
-            // TODO: add Variable type ?
-        }
-        
-        Writer->WriteObjectEnd();
+            FProperty* Property = Properties[Index];
+            FString InstanceValue;
+            Property->ExportTextItem_InContainer(InstanceValue, Instance, nullptr, nullptr, PPF_None);
+            // The instance overrides this property, keep its value
+            if (InstanceValue != OldValues[Index])
+                continue;
 
-        Writer->WriteObjectEnd();
+            Instance->Modify();
+            Property->CopyCompleteValue_InContainer(Instance, Archetype);
+            FPropertyChangedEvent ChangedEvent(Property);
+            Instance->PostEditChangeProperty(ChangedEvent);
+        }
     }
 
-    Writer->WriteArrayEnd();
-    Writer->Close();
+    Blueprint->MarkPackageDirty();
+    return true;
+}
 
-    return Output;
+#include "JsonBuffer.h"
+#include "SnapshotUtils.h"
+
+TArray<uint8> BPUtils::GetBlueprintGraphJson(UEdGraph* Graph)
+{
+    MCP_TRACE_SCOPE("BPUtils::GetBlueprintGraphJson");
+    if (!Graph)
+        throw std::runtime_error("Graph is null");
+    
+    Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+    return SnapshotUtils::EncodeGraph(SnapshotUtils::CaptureGraph(Graph));
 }
 
 
@@ -534,6 +591,7 @@ void BPUtils::AddComponentToBlueprintByName(UBlueprint* Blueprint,
     const FString& ComponentClassName,
     const FString& ComponentVarName, const FString &AttachTo)
 {
+    MCP_TRACE_SCOPE("BPUtils::AddComponentToBlueprintByName");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -598,138 +656,23 @@ void BPUtils::AddComponentToBlueprintByName(UBlueprint* Blueprint,
 
     // Notify editor
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    CompileBlueprint(Blueprint);
 }
 
 
-FString BPUtils::GetBlueprintComponentsJson(UBlueprint* Blueprint)
+TArray<uint8> BPUtils::GetBlueprintComponentsJson(UBlueprint* Blueprint)
 {
+    MCP_TRACE_SCOPE("BPUtils::GetBlueprintComponentsJson");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
-    UBlueprintGeneratedClass* BPClass = Cast<UBlueprintGeneratedClass>(Blueprint->GeneratedClass);
-    if (!BPClass)
-        throw std::runtime_error("Blueprint's GeneratedClass is null, please compile the Blueprint first");
-
-    FString ResultString;
-    
-    TSharedRef<TJsonWriter<>> Writer =
-        TJsonWriterFactory<>::Create(&ResultString);
-
-    Writer->WriteObjectStart();
-
-    Writer->WriteArrayStart("NativeComponents");
-    // Iterate all native components from CDO
-    if (AActor* CDO = Cast<AActor>(BPClass->GetDefaultObject()))
-    {
-        for (UActorComponent* Comp : CDO->GetComponents())
-        {
-            if (!Comp)
-                continue;
-            Writer->WriteObjectStart();
-            Writer->WriteValue(TEXT("Name"), Comp->GetName());
-            Writer->WriteValue(TEXT("Class"), Comp->GetClass() ? Comp->GetClass()->GetName() : TEXT("None"));
-            Writer->WriteValue(TEXT("Attachable"), Comp->IsA<USceneComponent>());
-            
-            if (auto sceneComp = Cast<USceneComponent>(Comp))
-            {
-                for (auto socketName : sceneComp->GetAllSocketNames())
-                {
-                    Writer->WriteValue(TEXT("Socket"), socketName.ToString());
-                }
-                
-                if (!sceneComp->GetAttachSocketName().IsNone())
-                    Writer->WriteValue("AttachToSocket", sceneComp->GetAttachSocketName().ToString());
-                
-                if (sceneComp->GetAttachParent())
-                    Writer->WriteValue("AttachToParent", sceneComp->GetAttachParent()->GetName());
-
-                auto children = sceneComp->GetAttachChildren();
-                if (children.Num() > 0)
-                {
-                    Writer->WriteArrayStart(TEXT("AttachChildren"));
-                    for (auto child : children)
-                    {
-                        if (child)
-                        {
-                            Writer->WriteValue(child->GetName());
-                        }
-                    }
-                    Writer->WriteArrayEnd();
-                }
-            }
-            Writer->WriteObjectEnd();
-        }
-    }
-    Writer->WriteArrayEnd();
-    
-
-    Writer->WriteArrayStart(TEXT("BpComponents"));
-    // Iterate all SCS nodes
-    if (Blueprint->SimpleConstructionScript)
-    {
-        for (USCS_Node* Node : Blueprint->SimpleConstructionScript->GetAllNodes())
-        {
-            if (!Node)
-                continue;
-
-            Writer->WriteObjectStart();
-            Writer->WriteValue(TEXT("Name"), Node->GetVariableName().ToString());
-            Writer->WriteValue(TEXT("Class"), Node->ComponentClass ? Node->ComponentClass->GetName() : TEXT("None"));
-            Writer->WriteValue(TEXT("Attachable"), Node->ComponentTemplate && Node->ComponentTemplate->IsA<USceneComponent>());
-            Writer->WriteValue(TEXT("IsRoot"), Blueprint->SimpleConstructionScript->GetRootNodes().Contains(Node));
-            
-            Writer->WriteArrayStart(TEXT("Children"));
-            for (USCS_Node* Child : Node->GetChildNodes())
-            {
-                if (Child)
-                {
-                    Writer->WriteValue(Child->GetVariableName().ToString());
-                }
-            }
-            Writer->WriteArrayEnd();
-            
-            if (auto sceneComp = Cast<USceneComponent>(Node->ComponentTemplate))
-            {
-                for (auto socketName : sceneComp->GetAllSocketNames())
-                {
-                    Writer->WriteValue(TEXT("Socket"), socketName.ToString());
-                }
-                
-                if (!sceneComp->GetAttachSocketName().IsNone())
-                    Writer->WriteValue("AttachToSocket", sceneComp->GetAttachSocketName().ToString());
-                
-                if (sceneComp->GetAttachParent())
-                    Writer->WriteValue("AttachToParent", sceneComp->GetAttachParent()->GetName());
-
-                auto children = sceneComp->GetAttachChildren();
-                if ( children.Num() > 0)
-                {
-                    Writer->WriteArrayStart(TEXT("AttachChildren"));
-                    for (auto child : children)
-                    {
-                        if (child)
-                        {
-                            Writer->WriteValue(child->GetName());
-                        }
-                    }
-                    Writer->WriteArrayEnd();
-                }
-                
-            }
-            Writer->WriteObjectEnd();
-        }
-    }
-
-    Writer->WriteArrayEnd();
-    Writer->WriteObjectEnd();
-    Writer->Close();
-
-    return ResultString;
+    Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+    return SnapshotUtils::EncodeComponentList(SnapshotUtils::CaptureBlueprint(Blueprint, ESnapshotFields::Components));
 }
 
 void BPUtils::RemoveComponentFromBlueprint(UBlueprint* Blueprint, const FString& ComponentVarName)
 {
+    MCP_TRACE_SCOPE("BPUtils::RemoveComponentFromBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -741,7 +684,7 @@ void BPUtils::RemoveComponentFromBlueprint(UBlueprint* Blueprint, const FString&
         {
             SCS->RemoveNode(Node);
             FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-            FKismetEditorUtilities::CompileBlueprint(Blueprint);
+            CompileBlueprint(Blueprint);
             return;
         }
     }
@@ -751,6 +694,7 @@ void BPUtils::RemoveComponentFromBlueprint(UBlueprint* Blueprint, const FString&
 
 void BPUtils::RenameComponentInBlueprint(UBlueprint* Blueprint, const FString& OldVarName, const FString& NewVarName)
 {
+    MCP_TRACE_SCOPE("BPUtils::RenameComponentInBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -767,7 +711,7 @@ void BPUtils::RenameComponentInBlueprint(UBlueprint* Blueprint, const FString& O
         {
             Node->SetVariableName(FName(*TrimmedNewName));
             FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-            FKismetEditorUtilities::CompileBlueprint(Blueprint);
+            CompileBlueprint(Blueprint);
             return;
         }
     }
@@ -779,6 +723,7 @@ void BPUtils::ChangeAttachToOfComponentInBlueprint(UBlueprint* Blueprint,
     const FString& ComponentVarName,
     const FString& NewAttachTo)
 {
+    MCP_TRACE_SCOPE("BPUtils::ChangeAttachToOfComponentInBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -848,11 +793,12 @@ void BPUtils::ChangeAttachToOfComponentInBlueprint(UBlueprint* Blueprint,
             SCS->AddNode(TargetNode);
     }
     FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-    FKismetEditorUtilities::CompileBlueprint(Blueprint);
+    CompileBlueprint(Blueprint);
 }
 
-FString BPUtils::GetComponentsPropertiesJson(UBlueprint* Blueprint, const FString& ComponentVarName)
+TArray<uint8> BPUtils::GetComponentsPropertiesJson(UBlueprint* Blueprint, const FString& ComponentVarName)
 {
+    MCP_TRACE_SCOPE("BPUtils::GetComponentsPropertiesJson");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
    
@@ -898,6 +844,7 @@ void BPUtils::SetComponentPropertyInBlueprint(
     UBlueprint* Blueprint, const FString& ComponentVarName,
     const TMap<FString, FString>& Properties)
 {
+    MCP_TRACE_SCOPE("BPUtils::SetComponentPropertyInBlueprint");
     if (!Blueprint)
         throw std::runtime_error("Blueprint is null");
 
@@ -906,12 +853,7 @@ void BPUtils::SetComponentPropertyInBlueprint(
         {
             if (Node && Node->GetVariableName().ToString() == ComponentVarName && Node->ComponentTemplate)
             {
-                for (const auto& [PropertyPath, PropertyValue] : Properties)
-                {
-                    ObjUtils::SetPropertyValueFromString(Node->ComponentTemplate, PropertyPath, PropertyValue);
-                }
-                FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-                FKismetEditorUtilities::CompileBlueprint(Blueprint);
+                SetComponentTemplateProperties(Blueprint, Node->ComponentTemplate, ComponentVarName, Properties);
                 return;
             }
         }
@@ -934,12 +876,7 @@ void BPUtils::SetComponentPropertyInBlueprint(
         UObject* Obj = ObjProp->GetObjectPropertyValue_InContainer(CDO);
         if (UActorComponent* Component = Cast<UActorComponent>(Obj))
         {
-            for (const auto& [PropertyPath, PropertyValue] : Properties)
-            {
-                ObjUtils::SetPropertyValueFromString(Component, PropertyPath, PropertyValue);
-            }
-            FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
-            FKismetEditorUtilities::CompileBlueprint(Blueprint);
+            SetComponentTemplateProperties(Blueprint, Component, ComponentVarName, Properties);
             return;
         }
         throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Property %s is not found in CD0"), *ComponentVarName)));
@@ -947,3 +884,33 @@ void BPUtils::SetComponentPropertyInBlueprint(
     
     throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Property %s is not a component"), *ComponentVarName)));
 }
+
+void BPUtils::SetComponentTemplateProperties(UBlueprint* Blueprint, UActorComponent* Template,
+    const FString& ComponentVarName, const TMap<FString, FString>& Properties)
+{
+    MCP_TRACE_SCOPE("BPUtils::SetComponentTemplateProperties");
+    auto SetAll = [&]()
+    {
+        for (const auto& [PropertyPath, PropertyValue] : Properties)
+        {
+            ObjUtils::SetPropertyValueFromString(Template, PropertyPath, PropertyValue);
+            ChangeEvents::MarkPropertyChanged(Blueprint, ComponentVarName, PropertyPath);
+        }
+    };
+
+    // Only the top level property of each path is copied to the instances
+    TArray<FString> PropertyNames;
+    for (const auto& [PropertyPath, PropertyValue] : Properties)
+    {
+        FString PropertyName;
+        if (!PropertyPath.Split(TEXT("."), &PropertyName, nullptr))
+            PropertyName = PropertyPath;
+        PropertyNames.AddUnique(PropertyName);
+    }
+    if (ApplyDefaultsWithoutCompile(Blueprint, Template, PropertyNames, SetAll))
+        return;
+
+    SetAll();
+    FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+    CompileBlueprint(Blueprint);
+}
@@ -4,6 +4,8 @@
 class UK2Node_FunctionTerminator;
 class UK2Node_FunctionEntry;
 class UK2Node_FunctionResult;
+class UActorComponent;
+struct FCallSiteReport;
 
 class BPUtils
 {
@@ -14,8 +16,35 @@ class BPUtils
 	static void GetOrAddEntryAndReturnNodesOfFunctionGraph(UEdGraph* Graph,
 	                                 UK2Node_FunctionEntry*& OutEntryNode,
 	                                 UK2Node_FunctionResult*& OutReturnNode);
+
+	static int32 DeferCompileDepth;
+	static TArray<TWeakObjectPtr<UBlueprint>> DeferredCompiles;
+
+	// Value edits don't change the generated class, so an up to date class can take them without a compile
+	static bool CanEditDefaultsWithoutCompile(const UBlueprint* Blueprint);
+
+	// Runs Apply on an up to date class's default object or component template, then copies the edited
+	// properties to every instance that still had the old value, the way the details panel propagates defaults
+	// Returns false without calling Apply when the Blueprint needs a compile to pick the edit up
+	static bool ApplyDefaultsWithoutCompile(UBlueprint* Blueprint, UObject* Archetype,
+	                                        const TArray<FString>& PropertyNames, TFunctionRef<void()> Apply);
+
+	static void SetComponentTemplateProperties(UBlueprint* Blueprint, UActorComponent* Template,
+	                                           const FString& ComponentVarName, const TMap<FString, FString>& Properties);
 	
 public:
+	// Holds back CompileBlueprint while it is alive
+	// Every Blueprint that asked for a compile is compiled once when the outermost scope ends
+	// bOutCompiled is set to whether that compiled anything, it stays false for nested scopes
+	struct FScopedDeferCompile
+	{
+		explicit FScopedDeferCompile(bool* bOutCompiled = nullptr);
+		~FScopedDeferCompile();
+
+	private:
+		bool* CompiledResult;
+	};
+
 	static UBlueprint* LoadBlueprint(const FString& Path);
 
 	static UEdGraph* GetEventGraph(UBlueprint* Blueprint);
@@ -29,18 +58,25 @@ public:
 	                           const FString& FunctionInputSignature,
 	                           const FString& FunctionOutputSignature);
 	
-	// Careful: this not remove usages of the function in graphs, may cause compile errors
+	// Careful: without CallSiteReport this not remove usages of the function in graphs, may cause compile errors
+	// With it, the call nodes in this and dependent Blueprints are removed too and reported
 	static void RemoveFunctionGraph(UBlueprint* Blueprint,
-								const FString& FunctionName);
+								const FString& FunctionName,
+								FCallSiteReport* CallSiteReport = nullptr);
 
-	// Careful: this not update usages of the function in graphs, may cause compile errors
+	// Careful: without CallSiteReport this not update usages of the function in graphs, may cause compile errors
+	// With it, the call nodes in this and dependent Blueprints are reconstructed too and reported
 	static void EditFunctionGraph(UBlueprint* Blueprint,
 	                              const FString& FunctionName,
 	                              const FString& FunctionInputSignature,
-	                              const FString& FunctionOutputSignature);
+	                              const FString& FunctionOutputSignature,
+	                              FCallSiteReport* CallSiteReport = nullptr);
 
 	static void CompileBlueprint(UBlueprint* Blueprint);
 
+	// Name of the Blueprint's compile status: UpToDate, UpToDateWithWarnings, Error or Dirty
+	static FString GetCompileStatusName(const UBlueprint* Blueprint);
+
 	// Get all variable names and type in format: 'type name' in the Blueprint
 	// If bIncludeAll is true, include all variables including inherited from parent BP classes and C++ classes
 	static TArray<FString> GetBlueprintVariables(UBlueprint* Blueprint, bool bIncludeAll = false);
@@ -57,12 +93,12 @@ public:
 
 	static void SetVariableDefaultValueInBlueprint(UBlueprint* Blueprint, const FString& VarName, const FString& DefaultValue);
 	
-	static FString GetBlueprintGraphJson(UEdGraph* Graph);
+	static TArray<uint8> GetBlueprintGraphJson(UEdGraph* Graph);
 	
 	static void AddComponentToBlueprintByName(UBlueprint* Blueprint, const FString& ComponentClassName,
 	                                          const FString& ComponentVarName, const FString& AttachTo);
 	
-	static FString GetBlueprintComponentsJson(UBlueprint* Blueprint);
+	static TArray<uint8> GetBlueprintComponentsJson(UBlueprint* Blueprint);
 
 	static void RemoveComponentFromBlueprint(UBlueprint* Blueprint, const FString& ComponentVarName);
 
@@ -70,7 +106,7 @@ public:
 
 	static void ChangeAttachToOfComponentInBlueprint(UBlueprint* Blueprint, const FString& ComponentVarName, const FString& NewAttachTo);
 
-	static FString GetComponentsPropertiesJson(UBlueprint* Blueprint, const FString& ComponentVarName);
+	static TArray<uint8> GetComponentsPropertiesJson(UBlueprint* Blueprint, const FString& ComponentVarName);
 
 	static void SetComponentPropertyInBlueprint(UBlueprint* Blueprint, const FString& ComponentVarName,
 		const TMap<FString, FString>& Properties);
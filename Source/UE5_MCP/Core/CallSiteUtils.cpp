@@ -0,0 +1,171 @@
+﻿#include "CallSiteUtils.h"
+#include "MCPTrace.h"
+
+#include "AssetLoadUtils.h"
+#include "BPUtils.h"
+#include "ChangeEvents.h"
+#include "ImpactUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphPin.h"
+#include "EdGraph/EdGraphSchema.h"
+#include "Engine/Blueprint.h"
+#include "K2Node_CallFunction.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Serialization/MemoryWriter.h"
+
+TArray<FCallSites> CallSiteUtils::FindCallSites(UBlueprint* Owner, const FString& FunctionName, FCallSiteReport& Report)
+{
+	MCP_TRACE_SCOPE("CallSiteUtils::FindCallSites");
+	FImpactReport Impact = ImpactUtils::AnalyzeMemberImpact(Owner, FunctionName, TEXT("Function"));
+	Report.Failed.Append(Impact.Failed);
+
+	TArray<FCallSites> CallSites;
+	for (const FMemberUsage& Usage : Impact.Usages)
+	{
+		if (Usage.Usage != TEXT("Call"))
+			continue;
+		UBlueprint* Blueprint = Cast<UBlueprint>(AssetLoadUtils::FindLoadedObject(UBlueprint::StaticClass(), Usage.BlueprintPath));
+		if (!Blueprint)
+			continue;
+
+		FGuid NodeId;
+		FGuid::Parse(Usage.NodeId, NodeId);
+		TArray<UEdGraph*> Graphs;
+		Blueprint->GetAllGraphs(Graphs);
+		UEdGraph** Graph = Graphs.FindByPredicate([&](const UEdGraph* Candidate) { return Candidate->GetName() == Usage.Graph; });
+		if (!Graph)
+			continue;
+		UEdGraphNode* const* Found = (*Graph)->Nodes.FindByPredicate(
+			[&NodeId](const UEdGraphNode* Candidate) { return Candidate && Candidate->NodeGuid == NodeId; });
+		UK2Node_CallFunction* Node = Found ? Cast<UK2Node_CallFunction>(*Found) : nullptr;
+		if (!Node)
+			continue;
+
+		FCallSites* Sites = CallSites.FindByPredicate([Blueprint](const FCallSites& Candidate) { return Candidate.Blueprint == Blueprint; });
+		if (!Sites)
+		{
+			Sites = &CallSites.AddDefaulted_GetRef();
+			Sites->Blueprint = Blueprint;
+		}
+		Sites->Nodes.Add(Node);
+	}
+	return CallSites;
+}
+
+void CallSiteUtils::ReconstructCallSite(UK2Node_CallFunction* Node, FCallSiteChange& Change)
+{
+	Node->Modify();
+	Node->ReconstructNode();
+
+	// Links are moved over by pin name, drop the ones the new pin type can't take
+	const UEdGraphSchema* Schema = Node->GetSchema();
+	TArray<UEdGraphPin*> OrphanedPins;
+	for (UEdGraphPin* Pin : Node->Pins)
+	{
+		for (UEdGraphPin* LinkedPin : TArray<UEdGraphPin*>(Pin->LinkedTo))
+		{
+			if (!Pin->bOrphanedPin && Schema->CanCreateConnection(Pin, LinkedPin).Response != CONNECT_RESPONSE_DISALLOW)
+				continue;
+			Change.BrokenLinks.Add(FString::Printf(TEXT("%s -> %s.%s"), *Pin->PinName.ToString(),
+				*LinkedPin->GetOwningNode()->NodeGuid.ToString(), *LinkedPin->PinName.ToString()));
+			Pin->BreakLinkTo(LinkedPin);
+		}
+		if (Pin->bOrphanedPin)
+			OrphanedPins.Add(Pin);
+	}
+	// Orphaned pins are the parameters the function no longer has
+	for (UEdGraphPin* Pin : OrphanedPins)
+	{
+		Node->RemovePin(Pin);
+	}
+}
+
+void CallSiteUtils::UpdateBlueprint(UBlueprint* Blueprint, const TArray<UK2Node_CallFunction*>& Nodes, bool bRemove,
+	FCallSiteReport& Report)
+{
+	const FString BlueprintPath = Blueprint->GetPackage()->GetName();
+	for (UK2Node_CallFunction* Node : Nodes)
+	{
+		UEdGraph* Graph = Node->GetGraph();
+		FCallSiteChange& Change = Report.Changes.AddDefaulted_GetRef();
+		Change.BlueprintPath = BlueprintPath;
+		Change.Graph = Graph->GetName();
+		Change.NodeId = Node->NodeGuid.ToString();
+		if (bRemove)
+		{
+			Change.Action = TEXT("Removed");
+			FBlueprintEditorUtils::RemoveNode(Blueprint, Node, true);
+		}
+		else
+		{
+			Change.Action = TEXT("Reconstructed");
+			ReconstructCallSite(Node, Change);
+		}
+		// Not batched through GraphUtils, the compile below already refreshes the Blueprint
+		ChangeEvents::MarkGraphChanged(Blueprint, Graph);
+	}
+
+	BPUtils::CompileBlueprint(Blueprint);
+	Report.Compiled.Add(BlueprintPath);
+}
+
+void CallSiteUtils::UpdateCallSites(UBlueprint* Owner, const TArray<FCallSites>& CallSites, bool bRemove,
+	FCallSiteReport& Report)
+{
+	MCP_TRACE_SCOPE("CallSiteUtils::UpdateCallSites");
+	if (!Owner)
+		throw std::runtime_error("Blueprint is null");
+
+	const FCallSites* OwnerSites = CallSites.FindByPredicate([Owner](const FCallSites& Sites) { return Sites.Blueprint == Owner; });
+	UpdateBlueprint(Owner, OwnerSites ? OwnerSites->Nodes : TArray<UK2Node_CallFunction*>(), bRemove, Report);
+
+	for (const FCallSites& Sites : CallSites)
+	{
+		if (Sites.Blueprint != Owner)
+			UpdateBlueprint(Sites.Blueprint, Sites.Nodes, bRemove, Report);
+	}
+}
+
+TArray<uint8> CallSiteUtils::EncodeReport(const FCallSiteReport& Report)
+{
+	MCP_TRACE_SCOPE("CallSiteUtils::EncodeReport");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteArrayStart(TEXT("Changes"));
+	for (const FCallSiteChange& Change : Report.Changes)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Blueprint"), Change.BlueprintPath);
+		Writer->WriteValue(TEXT("Graph"), Change.Graph);
+		Writer->WriteValue(TEXT("NodeId"), Change.NodeId);
+		Writer->WriteValue(TEXT("Action"), Change.Action);
+		Writer->WriteArrayStart(TEXT("BrokenLinks"));
+		for (const FString& Link : Change.BrokenLinks)
+		{
+			Writer->WriteValue(Link);
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteArrayStart(TEXT("Compiled"));
+	for (const FString& Path : Report.Compiled)
+	{
+		Writer->WriteValue(Path);
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteArrayStart(TEXT("Failed"));
+	for (const FString& Path : Report.Failed)
+	{
+		Writer->WriteValue(Path);
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
@@ -0,0 +1,48 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include <stdexcept>
+
+class UBlueprint;
+class UK2Node_CallFunction;
+
+struct FCallSiteChange
+{
+	FString BlueprintPath;
+	FString Graph;
+	FString NodeId;
+	FString Action; // Reconstructed or Removed
+	TArray<FString> BrokenLinks; // 'Pin -> NodeId.Pin' links that no longer fit the new signature
+};
+
+struct FCallSiteReport
+{
+	TArray<FCallSiteChange> Changes;
+	TArray<FString> Compiled; // every affected Blueprint, compiled once
+	TArray<FString> Failed; // dependent Blueprints that couldn't be loaded
+};
+
+// The call nodes of one Blueprint function in one Blueprint
+struct FCallSites
+{
+	UBlueprint* Blueprint = nullptr;
+	TArray<UK2Node_CallFunction*> Nodes;
+};
+
+// Keeps the calls to a Blueprint function in step with its signature
+class CallSiteUtils
+{
+public:
+	// Call nodes in the owning Blueprint and in the Blueprints referencing it, found through ImpactUtils
+	static TArray<FCallSites> FindCallSites(UBlueprint* Owner, const FString& FunctionName, FCallSiteReport& Report);
+
+	// Reconstructs the nodes against the function's current signature, or removes them, then compiles the owner
+	// and every Blueprint that had a call site once. The owner goes first so dependents see its new signature
+	// Links are kept by pin name while the schema still allows them, the others are broken and reported
+	static void UpdateCallSites(UBlueprint* Owner, const TArray<FCallSites>& CallSites, bool bRemove, FCallSiteReport& Report);
+
+	static TArray<uint8> EncodeReport(const FCallSiteReport& Report);
+
+private:
+	static void ReconstructCallSite(UK2Node_CallFunction* Node, FCallSiteChange& Change);
+	static void UpdateBlueprint(UBlueprint* Blueprint, const TArray<UK2Node_CallFunction*>& Nodes, bool bRemove, FCallSiteReport& Report);
+};
@@ -0,0 +1,240 @@
+﻿#include "ChangeEvents.h"
+
+#include "Editor.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SCS_Node.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Misc/CoreDelegates.h"
+#include "UObject/UObjectGlobals.h"
+
+ChangeEvents::FOnChange ChangeEvents::OnChangeDelegate;
+ChangeEvents::FOnChange ChangeEvents::OnChangeQueuedDelegate;
+TArray<FChangeEvent> ChangeEvents::Pending;
+TArray<TWeakObjectPtr<UBlueprint>> ChangeEvents::Compiling;
+FTSTicker::FDelegateHandle ChangeEvents::TickerHandle;
+FDelegateHandle ChangeEvents::PostEngineInitHandle;
+FDelegateHandle ChangeEvents::PreCompileHandle;
+FDelegateHandle ChangeEvents::CompiledHandle;
+FDelegateHandle ChangeEvents::ObjectModifiedHandle;
+FDelegateHandle ChangeEvents::PropertyChangedHandle;
+
+void ChangeEvents::Initialize()
+{
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&ChangeEvents::Flush));
+	ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddStatic(&ChangeEvents::HandleObjectModified);
+	PropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddStatic(&ChangeEvents::HandleObjectPropertyChanged);
+
+	// The editor engine doesn't exist yet when the module starts with the editor
+	if (GEditor)
+		RegisterEditorHooks();
+	else
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddStatic(&ChangeEvents::RegisterEditorHooks);
+}
+
+void ChangeEvents::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	FCoreUObjectDelegates::OnObjectModified.Remove(ObjectModifiedHandle);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(PropertyChangedHandle);
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	if (GEditor)
+	{
+		GEditor->OnBlueprintPreCompile().Remove(PreCompileHandle);
+		GEditor->OnBlueprintCompiled().Remove(CompiledHandle);
+	}
+	Pending.Empty();
+	Compiling.Empty();
+}
+
+void ChangeEvents::RegisterEditorHooks()
+{
+	if (!GEditor)
+		return;
+	PreCompileHandle = GEditor->OnBlueprintPreCompile().AddStatic(&ChangeEvents::HandleBlueprintPreCompile);
+	CompiledHandle = GEditor->OnBlueprintCompiled().AddStatic(&ChangeEvents::HandleBlueprintCompiled);
+}
+
+ChangeEvents::FOnChange& ChangeEvents::OnChange()
+{
+	return OnChangeDelegate;
+}
+
+ChangeEvents::FOnChange& ChangeEvents::OnChangeQueued()
+{
+	return OnChangeQueuedDelegate;
+}
+
+void ChangeEvents::MarkGraphChanged(UBlueprint* Blueprint, UEdGraph* Graph)
+{
+	if (!Blueprint || !Graph)
+		return;
+
+	FChangeEvent Event;
+	Event.Type = EChangeEventType::GraphChanged;
+	Event.BlueprintPath = Blueprint->GetPackage()->GetName();
+	Event.GraphName = Graph->GetName();
+	Enqueue(MoveTemp(Event));
+}
+
+void ChangeEvents::MarkPropertyChanged(UBlueprint* Blueprint, const FString& ObjectName, const FString& PropertyName)
+{
+	if (!Blueprint)
+		return;
+
+	FChangeEvent Event;
+	Event.Type = EChangeEventType::PropertyChanged;
+	Event.BlueprintPath = Blueprint->GetPackage()->GetName();
+	Event.ObjectName = ObjectName;
+	Event.PropertyName = PropertyName;
+	Enqueue(MoveTemp(Event));
+}
+
+const TCHAR* ChangeEvents::GetTypeName(EChangeEventType Type)
+{
+	switch (Type)
+	{
+	case EChangeEventType::BlueprintCompiled:
+		return TEXT("blueprint_compiled");
+	case EChangeEventType::GraphChanged:
+		return TEXT("graph_changed");
+	case EChangeEventType::PropertyChanged:
+		return TEXT("property_changed");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+void ChangeEvents::Enqueue(FChangeEvent&& Event)
+{
+	check(IsInGameThread());
+	OnChangeQueuedDelegate.Broadcast(Event);
+	Pending.AddUnique(MoveTemp(Event));
+}
+
+bool ChangeEvents::Flush(float DeltaTime)
+{
+	if (Pending.Num() > 0)
+	{
+		// Listeners may change Blueprints again, those changes go out next tick
+		TArray<FChangeEvent> Events = MoveTemp(Pending);
+		Pending.Reset();
+		for (const FChangeEvent& Event : Events)
+		{
+			OnChangeDelegate.Broadcast(Event);
+		}
+	}
+	return true;
+}
+
+UBlueprint* ChangeEvents::FindOwningBlueprint(const UObject* Object, FString& OutObjectName)
+{
+	if (!Object)
+		return nullptr;
+
+	if (const UBlueprint* Blueprint = Cast<UBlueprint>(Object))
+	{
+		OutObjectName = Blueprint->GetName();
+		return const_cast<UBlueprint*>(Blueprint);
+	}
+
+	// Class default object
+	if (Object->HasAnyFlags(RF_ClassDefaultObject))
+	{
+		OutObjectName = TEXT("Default");
+		return Cast<UBlueprint>(Object->GetClass()->ClassGeneratedBy);
+	}
+
+	// Component template of the construction script, reported with its variable name
+	if (const UBlueprintGeneratedClass* GeneratedClass = Object->GetTypedOuter<UBlueprintGeneratedClass>())
+	{
+		UBlueprint* Blueprint = Cast<UBlueprint>(GeneratedClass->ClassGeneratedBy);
+		OutObjectName = Object->GetName();
+		if (Blueprint && Blueprint->SimpleConstructionScript)
+		{
+			for (USCS_Node* Node : Blueprint->SimpleConstructionScript->GetAllNodes())
+			{
+				if (Node && Node->ComponentTemplate == Object)
+				{
+					OutObjectName = Node->GetVariableName().ToString();
+					break;
+				}
+			}
+		}
+		return Blueprint;
+	}
+
+	OutObjectName = Object->GetName();
+	return Object->GetTypedOuter<UBlueprint>();
+}
+
+void ChangeEvents::HandleBlueprintPreCompile(UBlueprint* Blueprint)
+{
+	if (Blueprint)
+		Compiling.AddUnique(Blueprint);
+}
+
+void ChangeEvents::HandleBlueprintCompiled()
+{
+	for (const TWeakObjectPtr<UBlueprint>& WeakBlueprint : Compiling)
+	{
+		UBlueprint* Blueprint = WeakBlueprint.Get();
+		if (!Blueprint)
+			continue;
+
+		FChangeEvent Event;
+		Event.Type = EChangeEventType::BlueprintCompiled;
+		Event.BlueprintPath = Blueprint->GetPackage()->GetName();
+		switch (Blueprint->Status)
+		{
+		case BS_UpToDate:
+			Event.Status = TEXT("UpToDate");
+			break;
+		case BS_UpToDateWithWarnings:
+			Event.Status = TEXT("UpToDateWithWarnings");
+			break;
+		case BS_Error:
+			Event.Status = TEXT("Error");
+			break;
+		case BS_Dirty:
+			Event.Status = TEXT("Dirty");
+			break;
+		default:
+			Event.Status = TEXT("Unknown");
+			break;
+		}
+		Enqueue(MoveTemp(Event));
+	}
+	Compiling.Reset();
+}
+
+void ChangeEvents::HandleObjectModified(UObject* Object)
+{
+	// Modify() runs before the change, the event goes out on the next tick after it
+	UEdGraph* Graph = Cast<UEdGraph>(Object);
+	if (!Graph)
+	{
+		if (const UEdGraphNode* Node = Cast<UEdGraphNode>(Object))
+			Graph = Node->GetGraph();
+	}
+	if (!Graph || !IsInGameThread())
+		return;
+
+	MarkGraphChanged(FBlueprintEditorUtils::FindBlueprintForGraph(Graph), Graph);
+}
+
+void ChangeEvents::HandleObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (!IsInGameThread())
+		return;
+
+	FString ObjectName;
+	UBlueprint* Blueprint = FindOwningBlueprint(Object, ObjectName);
+	if (!Blueprint)
+		return;
+
+	MarkPropertyChanged(Blueprint, ObjectName, PropertyChangedEvent.GetMemberPropertyName().ToString());
+}
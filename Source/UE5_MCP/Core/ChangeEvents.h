@@ -0,0 +1,75 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class UBlueprint;
+class UEdGraph;
+struct FPropertyChangedEvent;
+
+enum class EChangeEventType : uint8
+{
+	BlueprintCompiled,
+	GraphChanged,
+	PropertyChanged
+};
+
+struct FChangeEvent
+{
+	EChangeEventType Type = EChangeEventType::GraphChanged;
+	FString BlueprintPath; // package path, the same form as the bp_path the API takes
+	FString GraphName; // GraphChanged
+	FString ObjectName; // PropertyChanged, component variable name or the class default object
+	FString PropertyName; // PropertyChanged
+	FString Status; // BlueprintCompiled
+
+	bool operator==(const FChangeEvent& Other) const
+	{
+		return Type == Other.Type && BlueprintPath == Other.BlueprintPath && GraphName == Other.GraphName
+			&& ObjectName == Other.ObjectName && PropertyName == Other.PropertyName && Status == Other.Status;
+	}
+};
+
+// Collects Blueprint changes made through the API or in the editor and broadcasts them once per tick
+// Repeated changes of the same graph or property within a tick are coalesced into one event
+class ChangeEvents
+{
+public:
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnChange, const FChangeEvent&);
+
+	static void Initialize();
+	static void Shutdown();
+
+	static FOnChange& OnChange();
+
+	// Fired as soon as a change is recorded, before it is coalesced, for state that must not be read stale within the tick
+	// Editor changes are recorded when the object is about to be modified, so don't read the Blueprint from here
+	static FOnChange& OnChangeQueued();
+
+	static void MarkGraphChanged(UBlueprint* Blueprint, UEdGraph* Graph);
+	static void MarkPropertyChanged(UBlueprint* Blueprint, const FString& ObjectName, const FString& PropertyName);
+
+	static const TCHAR* GetTypeName(EChangeEventType Type);
+
+private:
+	static void Enqueue(FChangeEvent&& Event);
+	static bool Flush(float DeltaTime);
+
+	static void RegisterEditorHooks();
+	static UBlueprint* FindOwningBlueprint(const UObject* Object, FString& OutObjectName);
+	static void HandleBlueprintPreCompile(UBlueprint* Blueprint);
+	static void HandleBlueprintCompiled();
+	static void HandleObjectModified(UObject* Object);
+	static void HandleObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+
+	static FOnChange OnChangeDelegate;
+	static FOnChange OnChangeQueuedDelegate;
+	static TArray<FChangeEvent> Pending;
+	static TArray<TWeakObjectPtr<UBlueprint>> Compiling;
+
+	static FTSTicker::FDelegateHandle TickerHandle;
+	static FDelegateHandle PostEngineInitHandle;
+	static FDelegateHandle PreCompileHandle;
+	static FDelegateHandle CompiledHandle;
+	static FDelegateHandle ObjectModifiedHandle;
+	static FDelegateHandle PropertyChangedHandle;
+};
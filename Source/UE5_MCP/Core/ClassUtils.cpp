@@ -1,4 +1,5 @@
 ﻿#include "ClassUtils.h"
+#include "MCPTrace.h"
 
 #include "AssetToolsModule.h"
 #include "AssetRegistry/AssetRegistryModule.h"
@@ -8,6 +9,7 @@
 
 UClass* ClassUtils::FindClassByName(const FString& ClassFullName)
 {
+	MCP_TRACE_SCOPE("ClassUtils::FindClassByName");
 	// 1. Already loaded?
 	UClass* Class = FindFirstObject<UClass>(*ClassFullName);
 	if (Class)
@@ -60,6 +62,7 @@ UClass* ClassUtils::FindClassByName(const FString& ClassFullName)
 
 FString ClassUtils::CreateBlueprintFromClass(const FString& ParentClassFullName, const FString& BlueprintPath)
 {
+	MCP_TRACE_SCOPE("ClassUtils::CreateBlueprintFromClass");
 	UE_LOG(LogTemp, Log, TEXT("Creating Blueprint: %s from Parent Class: %s"), *BlueprintPath, *ParentClassFullName);
 	
 	UClass* ParentClass = FindClassByName(ParentClassFullName);
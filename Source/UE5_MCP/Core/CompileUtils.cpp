@@ -0,0 +1,192 @@
+﻿#include "CompileUtils.h"
+#include "MCPTrace.h"
+
+#include "BPUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "BlueprintCompilationManager.h"
+#include "BlueprintEditorSettings.h"
+#include "FileHelpers.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "Engine/Blueprint.h"
+#include "Serialization/MemoryWriter.h"
+
+FBatchCompileReport CompileUtils::CompileBlueprints(const TArray<FString>& Paths, const FOptions& Options)
+{
+	MCP_TRACE_SCOPE("CompileUtils::CompileBlueprints");
+	FBatchCompileReport Report;
+	TArray<UBlueprint*> Blueprints;
+
+	double StartSeconds = FPlatformTime::Seconds();
+	for (const FString& Path : Paths)
+	{
+		FBlueprintCompileReport& Entry = Report.Blueprints.AddDefaulted_GetRef();
+		Entry.Path = Path;
+		UBlueprint* Blueprint = BPUtils::LoadBlueprint(Path);
+		if (!Blueprint)
+		{
+			Entry.Status = TEXT("LoadFailed");
+			++Report.Errors;
+			Blueprints.Add(nullptr);
+			continue;
+		}
+		Blueprints.Add(Blueprint);
+	}
+	Report.LoadMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+	StartSeconds = FPlatformTime::Seconds();
+	{
+		Metrics::FScopedPhase Phase(EMetricPhase::Compile);
+		int32 Queued = 0;
+		for (UBlueprint* Blueprint : Blueprints)
+		{
+			if (!Blueprint)
+				continue;
+			FBlueprintCompilationManager::QueueForCompilation(Blueprint);
+			++Queued;
+		}
+		TRACE_COUNTER_ADD(UE5_MCP_CompilesTriggered, Queued);
+		FBlueprintCompilationManager::FlushCompilationQueueAndReinstance();
+	}
+	Report.CompileMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+	// One collection for the whole batch, the editor collects after every single compile
+	if (!Options.bSkipGarbageCollection)
+	{
+		StartSeconds = FPlatformTime::Seconds();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		Report.GarbageCollectMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+	}
+
+	TArray<UPackage*> PackagesToSave;
+	const ESaveOnCompile SaveOnCompile = GetDefault<UBlueprintEditorSettings>()->SaveOnCompile;
+	for (int32 Index = 0; Index < Blueprints.Num(); ++Index)
+	{
+		UBlueprint* Blueprint = Blueprints[Index];
+		if (!Blueprint)
+			continue;
+
+		FBlueprintCompileReport& Entry = Report.Blueprints[Index];
+		Entry.Status = BPUtils::GetCompileStatusName(Blueprint);
+		Entry.Messages = CollectNodeMessages(Blueprint);
+		for (const FCompileMessage& Message : Entry.Messages)
+		{
+			if (Message.Severity == TEXT("Error"))
+				++Report.Errors;
+			else if (Message.Severity == TEXT("Warning"))
+				++Report.Warnings;
+		}
+		// An error that no node carries, e.g. a broken parent class, is still counted
+		if (Blueprint->Status == BS_Error && !Entry.Messages.ContainsByPredicate(
+			[](const FCompileMessage& Message) { return Message.Severity == TEXT("Error"); }))
+			++Report.Errors;
+
+		if (SaveOnCompile == SoC_Always || (SaveOnCompile == SoC_SuccessOnly && Blueprint->Status != BS_Error))
+			PackagesToSave.Add(Blueprint->GetOutermost());
+	}
+
+	if (!Options.bSkipSave && PackagesToSave.Num() > 0)
+	{
+		StartSeconds = FPlatformTime::Seconds();
+		UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true);
+		Report.SaveMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+	}
+	return Report;
+}
+
+TArray<FString> CompileUtils::FindBlueprintsUnderPath(const FString& PathPrefix)
+{
+	MCP_TRACE_SCOPE("CompileUtils::FindBlueprintsUnderPath");
+	if (PathPrefix.IsEmpty() || !PathPrefix.StartsWith(TEXT("/")))
+		throw std::runtime_error("Path prefix must be a content folder, e.g. /Game/Blueprints");
+
+	FARFilter Filter;
+	Filter.PackagePaths.Add(FName(*PathPrefix));
+	Filter.bRecursivePaths = true;
+	Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+
+	TArray<FAssetData> Assets;
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	TArray<FString> Paths;
+	Paths.Reserve(Assets.Num());
+	for (const FAssetData& Asset : Assets)
+	{
+		Paths.Add(Asset.PackageName.ToString());
+	}
+	return Paths;
+}
+
+TArray<FCompileMessage> CompileUtils::CollectNodeMessages(UBlueprint* Blueprint)
+{
+	MCP_TRACE_SCOPE("CompileUtils::CollectNodeMessages");
+	TArray<FCompileMessage> Messages;
+	if (!Blueprint)
+		return Messages;
+
+	TArray<UEdGraph*> Graphs;
+	Blueprint->GetAllGraphs(Graphs);
+	for (const UEdGraph* Graph : Graphs)
+	{
+		for (const UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (!Node || !Node->bHasCompilerMessage)
+				continue;
+
+			FCompileMessage& Message = Messages.AddDefaulted_GetRef();
+			Message.Severity = Node->ErrorType <= EMessageSeverity::Error ? TEXT("Error")
+				: Node->ErrorType <= EMessageSeverity::Warning ? TEXT("Warning")
+				: TEXT("Note");
+			Message.Graph = Graph->GetName();
+			Message.NodeId = Node->NodeGuid.ToString();
+			Message.Message = Node->ErrorMsg;
+		}
+	}
+	return Messages;
+}
+
+TArray<uint8> CompileUtils::EncodeReport(const FBatchCompileReport& Report)
+{
+	MCP_TRACE_SCOPE("CompileUtils::EncodeReport");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Errors"), Report.Errors);
+	Writer->WriteValue(TEXT("Warnings"), Report.Warnings);
+	Writer->WriteObjectStart(TEXT("Timing"));
+	Writer->WriteValue(TEXT("LoadMs"), Report.LoadMs);
+	Writer->WriteValue(TEXT("CompileMs"), Report.CompileMs);
+	Writer->WriteValue(TEXT("GarbageCollectMs"), Report.GarbageCollectMs);
+	Writer->WriteValue(TEXT("SaveMs"), Report.SaveMs);
+	Writer->WriteObjectEnd();
+	Writer->WriteArrayStart(TEXT("Blueprints"));
+	for (const FBlueprintCompileReport& Entry : Report.Blueprints)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Path"), Entry.Path);
+		Writer->WriteValue(TEXT("Status"), Entry.Status);
+		Writer->WriteArrayStart(TEXT("Messages"));
+		for (const FCompileMessage& Message : Entry.Messages)
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("Severity"), Message.Severity);
+			Writer->WriteValue(TEXT("Graph"), Message.Graph);
+			Writer->WriteValue(TEXT("NodeId"), Message.NodeId);
+			Writer->WriteValue(TEXT("Message"), Message.Message);
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include <stdexcept>
+
+class UBlueprint;
+
+struct FCompileMessage
+{
+	FString Severity; // Error, Warning or Note
+	FString Graph;
+	FString NodeId;
+	FString Message;
+};
+
+struct FBlueprintCompileReport
+{
+	FString Path;
+	FString Status; // see BPUtils::GetCompileStatusName, LoadFailed when it couldn't be loaded
+	TArray<FCompileMessage> Messages;
+};
+
+struct FBatchCompileReport
+{
+	TArray<FBlueprintCompileReport> Blueprints;
+	int32 Errors = 0;
+	int32 Warnings = 0;
+	double LoadMs = 0.0;
+	double CompileMs = 0.0;
+	double GarbageCollectMs = 0.0;
+	double SaveMs = 0.0;
+};
+
+// Compiles many Blueprints in one pass of the Blueprint compilation manager
+class CompileUtils
+{
+public:
+	struct FOptions
+	{
+		bool bSkipGarbageCollection = false;
+		// Skips saving the compiled Blueprints when the editor's Save on Compile setting asks for it
+		bool bSkipSave = false;
+	};
+
+	// Queues every Blueprint and flushes the queue once, so parents compile before their children and
+	// each Blueprint is compiled and reinstanced once. Garbage is collected and packages saved once for the batch
+	static FBatchCompileReport CompileBlueprints(const TArray<FString>& Paths, const FOptions& Options);
+
+	// Package paths of every Blueprint asset under a content folder, e.g. /Game/Enemies
+	static TArray<FString> FindBlueprintsUnderPath(const FString& PathPrefix);
+
+	// Compiler messages left on the Blueprint's nodes by its last compile
+	static TArray<FCompileMessage> CollectNodeMessages(UBlueprint* Blueprint);
+
+	static TArray<uint8> EncodeReport(const FBatchCompileReport& Report);
+};
@@ -0,0 +1,396 @@
+﻿#include "GraphApplyUtils.h"
+#include "MCPTrace.h"
+
+#include "ClassUtils.h"
+#include "GraphUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "EdGraphNode_Comment.h"
+#include "Editor.h"
+#include "K2Node_BreakStruct.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_CastByteToEnum.h"
+#include "K2Node_ClassDynamicCast.h"
+#include "K2Node_CustomEvent.h"
+#include "K2Node_DynamicCast.h"
+#include "K2Node_Event.h"
+#include "K2Node_MakeStruct.h"
+#include "K2Node_VariableGet.h"
+#include "K2Node_VariableSet.h"
+#include "ScopedTransaction.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphSchema.h"
+#include "Editor/Transactor.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Serialization/MemoryWriter.h"
+
+FGraphApplyResult GraphApplyUtils::ApplyGraph(UBlueprint* Blueprint, UEdGraph* Graph, const TArray<FGraphNodeDesc>& Nodes,
+	const TArray<FGraphLinkDesc>& Links, bool bPrune)
+{
+	MCP_TRACE_SCOPE("GraphApplyUtils::ApplyGraph");
+	if (!Blueprint || !Graph)
+		throw std::runtime_error("Blueprint or Graph is null");
+
+	TMap<FGuid, UEdGraphNode*> NodesByGuid;
+	NodesByGuid.Reserve(Graph->Nodes.Num());
+	for (UEdGraphNode* Node : Graph->Nodes)
+	{
+		if (Node)
+			NodesByGuid.Add(Node->NodeGuid, Node);
+	}
+
+	FGraphApplyResult Result;
+	FPlan Plan;
+	TMap<FString, FGuid> GuidById;
+	TSet<FGuid> Described;
+	// Nodes created by this apply, every link they have is made again
+	TSet<FGuid> Created;
+
+	// Everything is planned before the first edit, so a description that doesn't fit fails without touching the graph
+	for (const FGraphNodeDesc& Desc : Nodes)
+	{
+		if (Desc.Id.IsEmpty())
+			throw std::runtime_error("Node id is empty");
+		if (GuidById.Contains(Desc.Id))
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Duplicated node id %s"), *Desc.Id)));
+
+		const FGuid Guid = ResolveNodeGuid(Graph, Desc.Id);
+		GuidById.Add(Desc.Id, Guid);
+		Described.Add(Guid);
+		Result.NodeIds.Add({ Desc.Id, Guid });
+
+		UEdGraphNode* const* Existing = NodesByGuid.Find(Guid);
+		if (Existing && MatchesNode(*Existing, Desc))
+		{
+			UEdGraphNode_Comment* Comment = Cast<UEdGraphNode_Comment>(*Existing);
+			if (Comment && Comment->NodeComment != Desc.Name)
+				Plan.CommentsToUpdate.Add({ Comment, &Desc.Name });
+
+			for (const TPair<FString, FString>& Default : Desc.Defaults)
+			{
+				UEdGraphPin* Pin = FindPin(*Existing, Desc.Id, Default.Key);
+				if (Pin->DefaultValue != Default.Value)
+					Plan.DefaultsToSet.Add({ Pin, &Default.Value });
+			}
+			continue;
+		}
+
+		// A node of another kind under the same id is replaced
+		if (Existing)
+			Plan.ToDelete.Add(*Existing);
+		Plan.ToCreate.Add(&Desc);
+		Created.Add(Guid);
+	}
+
+	if (bPrune)
+	{
+		for (UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (Node && !Described.Contains(Node->NodeGuid) && Node->CanUserDeleteNode())
+				Plan.ToDelete.Add(Node);
+		}
+	}
+
+	TSet<FLinkKey> DesiredLinks;
+	for (const FGraphLinkDesc& Link : Links)
+	{
+		const FGuid* FromGuid = GuidById.Find(Link.From);
+		const FGuid* ToGuid = GuidById.Find(Link.To);
+		if (!FromGuid || !ToGuid)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Link references unknown node id %s"),
+				FromGuid ? *Link.To : *Link.From)));
+
+		if (Created.Contains(*FromGuid) || Created.Contains(*ToGuid))
+		{
+			Plan.ToLink.Add(&Link);
+			continue;
+		}
+
+		UEdGraphPin* FromPin = FindPin(NodesByGuid[*FromGuid], Link.From, Link.FromPin);
+		UEdGraphPin* ToPin = FindPin(NodesByGuid[*ToGuid], Link.To, Link.ToPin);
+		OrientLink(FromPin, ToPin, Link);
+
+		bool bAlreadyDesired = false;
+		DesiredLinks.Add(FLinkKey(FromPin->GetOwningNode()->NodeGuid, FromPin->PinName, ToPin->GetOwningNode()->NodeGuid, ToPin->PinName),
+			&bAlreadyDesired);
+		if (!bAlreadyDesired && !FromPin->LinkedTo.Contains(ToPin))
+		{
+			// Pins of the nodes still to be created are only checked once they exist
+			CheckLink(FromPin, ToPin, Link);
+			Plan.ToLink.Add(&Link);
+		}
+	}
+
+	// Links between kept nodes that the description no longer has, links to nodes it doesn't describe are left alone
+	for (const TPair<FString, FGuid>& NodeId : GuidById)
+	{
+		if (Created.Contains(NodeId.Value))
+			continue;
+		for (UEdGraphPin* Pin : NodesByGuid[NodeId.Value]->Pins)
+		{
+			if (!Pin || Pin->Direction != EGPD_Output)
+				continue;
+			for (UEdGraphPin* Linked : Pin->LinkedTo)
+			{
+				const FGuid LinkedGuid = Linked->GetOwningNode()->NodeGuid;
+				if (!Described.Contains(LinkedGuid) || Created.Contains(LinkedGuid))
+					continue;
+				if (!DesiredLinks.Contains(FLinkKey(NodeId.Value, Pin->PinName, LinkedGuid, Linked->PinName)))
+					Plan.ToUnlink.Add({ Pin, Linked });
+			}
+		}
+	}
+
+	if (Plan.IsEmpty())
+		return Result;
+
+	// Inside an outer transaction ours only joins it, and rolling back is left to its owner
+	const bool bOwnsTransaction = GUndo == nullptr;
+	const int32 QueueLength = GEditor && GEditor->Trans ? GEditor->Trans->GetQueueLength() : 0;
+	try
+	{
+		GraphUtils::FScopedBatchEdit Batch;
+		FScopedTransaction Transaction(NSLOCTEXT("UE5_MCP", "ApplyGraph", "Apply Graph"));
+		Execute(Blueprint, Graph, Plan, NodesByGuid, GuidById, Result);
+	}
+	catch (std::runtime_error&)
+	{
+		// Rolls back the edits made before the one that failed, only if our transaction was recorded,
+		// otherwise the top of the buffer is an unrelated edit
+		if (bOwnsTransaction && GEditor && GEditor->Trans && GEditor->Trans->GetQueueLength() > QueueLength)
+			GEditor->UndoTransaction(false);
+		throw;
+	}
+	return Result;
+}
+
+void GraphApplyUtils::Execute(UBlueprint* Blueprint, UEdGraph* Graph, const FPlan& Plan,
+	TMap<FGuid, UEdGraphNode*>& NodesByGuid, const TMap<FString, FGuid>& GuidById, FGraphApplyResult& Result)
+{
+	Blueprint->Modify();
+	Graph->Modify();
+
+	auto SetDefault = [&Result](UEdGraphPin* Pin, const FString& Value)
+	{
+		UEdGraphNode* Node = Pin->GetOwningNode();
+		Node->Modify();
+		Pin->DefaultValue = Value;
+		Node->PinDefaultValueChanged(Pin);
+		++Result.DefaultsSet;
+	};
+
+	// Only adding or removing nodes like events changes the class, wiring and defaults never do
+	bool bStructural = false;
+	for (UEdGraphNode* Node : Plan.ToDelete)
+	{
+		bStructural |= GraphUtils::IsStructuralNode(Node);
+		NodesByGuid.Remove(Node->NodeGuid);
+		FBlueprintEditorUtils::RemoveNode(Blueprint, Node, true);
+		++Result.Deleted;
+	}
+
+	for (const FGraphNodeDesc* Desc : Plan.ToCreate)
+	{
+		UEdGraphNode* Node = CreateNode(Blueprint, Graph, *Desc);
+		if (!Node)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Failed to create node %s"), *Desc->Id)));
+		Node->NodeGuid = GuidById[Desc->Id];
+		bStructural |= GraphUtils::IsStructuralNode(Node);
+		NodesByGuid.Add(Node->NodeGuid, Node);
+		++Result.Created;
+
+		for (const TPair<FString, FString>& Default : Desc->Defaults)
+		{
+			UEdGraphPin* Pin = FindPin(Node, Desc->Id, Default.Key);
+			if (Pin->DefaultValue != Default.Value)
+				SetDefault(Pin, Default.Value);
+		}
+	}
+
+	for (const TPair<UEdGraphNode_Comment*, const FString*>& Comment : Plan.CommentsToUpdate)
+	{
+		Comment.Key->Modify();
+		Comment.Key->NodeComment = *Comment.Value;
+		++Result.Updated;
+	}
+
+	for (const TPair<UEdGraphPin*, UEdGraphPin*>& Link : Plan.ToUnlink)
+	{
+		Link.Key->BreakLinkTo(Link.Value);
+		++Result.Unlinked;
+	}
+
+	for (const FGraphLinkDesc* Link : Plan.ToLink)
+	{
+		UEdGraphPin* FromPin = FindPin(NodesByGuid[GuidById[Link->From]], Link->From, Link->FromPin);
+		UEdGraphPin* ToPin = FindPin(NodesByGuid[GuidById[Link->To]], Link->To, Link->ToPin);
+		OrientLink(FromPin, ToPin, *Link);
+		if (FromPin->LinkedTo.Contains(ToPin))
+			continue;
+		CheckLink(FromPin, ToPin, *Link);
+		// Breaks the links the schema asks for and adds the conversion node if one is needed, like connect_pins
+		if (!Graph->GetSchema()->TryCreateConnection(FromPin, ToPin))
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Failed to link %s.%s -> %s.%s"),
+				*Link->From, *Link->FromPin, *Link->To, *Link->ToPin)));
+		TRACE_COUNTER_INCREMENT(UE5_MCP_PinsLinked);
+		++Result.Linked;
+	}
+
+	for (const TPair<UEdGraphPin*, const FString*>& Default : Plan.DefaultsToSet)
+	{
+		SetDefault(Default.Key, *Default.Value);
+	}
+
+	GraphUtils::NotifyGraphChanged(Blueprint, Graph, bStructural);
+}
+
+FGuid GraphApplyUtils::ResolveNodeGuid(const UEdGraph* Graph, const FString& Id)
+{
+	FGuid Guid;
+	if (FGuid::Parse(Id, Guid))
+		return Guid;
+	// Scoped by graph, so one client id used in two graphs of a Blueprint gives two nodes
+	return FGuid::NewDeterministicGuid(FString::Printf(TEXT("UE5_MCP/%s/%s"), *Graph->GetName(), *Id));
+}
+
+bool GraphApplyUtils::MatchesNode(const UEdGraphNode* Node, const FGraphNodeDesc& Desc)
+{
+	const FName Name(*Desc.Name);
+	if (Desc.Type == TEXT("FunctionCall") || Desc.Type == TEXT("Math"))
+	{
+		const UK2Node_CallFunction* CallNode = ExactCast<UK2Node_CallFunction>(Node);
+		return CallNode && CallNode->FunctionReference.GetMemberName() == Name;
+	}
+	if (Desc.Type == TEXT("Event"))
+	{
+		const UK2Node_Event* EventNode = ExactCast<UK2Node_Event>(Node);
+		return EventNode && EventNode->EventReference.GetMemberName() == Name;
+	}
+	if (Desc.Type == TEXT("CustomEvent"))
+	{
+		const UK2Node_CustomEvent* EventNode = ExactCast<UK2Node_CustomEvent>(Node);
+		return EventNode && EventNode->CustomFunctionName == Name;
+	}
+	if (Desc.Type == TEXT("GetVariable"))
+	{
+		const UK2Node_VariableGet* GetNode = ExactCast<UK2Node_VariableGet>(Node);
+		return GetNode && GetNode->VariableReference.GetMemberName() == Name;
+	}
+	if (Desc.Type == TEXT("SetVariable"))
+	{
+		const UK2Node_VariableSet* SetNode = ExactCast<UK2Node_VariableSet>(Node);
+		return SetNode && SetNode->VariableReference.GetMemberName() == Name;
+	}
+	if (Desc.Type == TEXT("MakeStruct"))
+	{
+		const UK2Node_MakeStruct* MakeNode = ExactCast<UK2Node_MakeStruct>(Node);
+		return MakeNode && MakeNode->StructType && MakeNode->StructType->GetName() == Desc.Name;
+	}
+	if (Desc.Type == TEXT("BreakStruct"))
+	{
+		const UK2Node_BreakStruct* BreakNode = ExactCast<UK2Node_BreakStruct>(Node);
+		return BreakNode && BreakNode->StructType && BreakNode->StructType->GetName() == Desc.Name;
+	}
+	if (Desc.Type == TEXT("DynamicCast") || Desc.Type == TEXT("ClassCast"))
+	{
+		const UK2Node_DynamicCast* CastNode = Desc.Type == TEXT("ClassCast")
+			? ExactCast<UK2Node_ClassDynamicCast>(Node)
+			: ExactCast<UK2Node_DynamicCast>(Node);
+		return CastNode && CastNode->TargetType
+			&& (CastNode->TargetType->GetName() == Desc.Name || CastNode->TargetType == ClassUtils::FindClassByName(Desc.Name));
+	}
+	if (Desc.Type == TEXT("EnumCast"))
+	{
+		const UK2Node_CastByteToEnum* CastNode = ExactCast<UK2Node_CastByteToEnum>(Node);
+		return CastNode && CastNode->Enum && CastNode->Enum->GetName() == Desc.Name;
+	}
+	if (Desc.Type == TEXT("Comment"))
+	{
+		// The text is updated in place
+		return Node->IsA<UEdGraphNode_Comment>();
+	}
+	return Node->GetClass()->GetName() == Desc.Type;
+}
+
+UEdGraphNode* GraphApplyUtils::CreateNode(UBlueprint* Blueprint, UEdGraph* Graph, const FGraphNodeDesc& Desc)
+{
+	if (Desc.Type == TEXT("FunctionCall"))
+	{
+		return Desc.ClassToCall.IsEmpty()
+			? GraphUtils::AddFunctionCallToGraph(Blueprint, Graph, Desc.Name)
+			: GraphUtils::AddFunctionCallToGraph(Blueprint, Graph, Desc.ClassToCall, Desc.Name);
+	}
+	if (Desc.Type == TEXT("Math"))
+		return GraphUtils::AddMathFunctionCallToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("Event"))
+		return GraphUtils::AddEventToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("CustomEvent"))
+		return GraphUtils::AddCustomEventToGraph(Blueprint, Graph, Desc.Name, Desc.EventSignature);
+	if (Desc.Type == TEXT("GetVariable"))
+		return GraphUtils::AddGetVariableNodeToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("SetVariable"))
+		return GraphUtils::AddSetVariableNodeToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("MakeStruct"))
+		return GraphUtils::AddMakeStructNodeToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("BreakStruct"))
+		return GraphUtils::AddBreakStructNodeToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("DynamicCast"))
+		return GraphUtils::AddDynamicCastNodeToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("ClassCast"))
+		return GraphUtils::AddClassCastNodeToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("EnumCast"))
+		return GraphUtils::AddByteToEnumNodeCastToGraph(Blueprint, Graph, Desc.Name);
+	if (Desc.Type == TEXT("Comment"))
+		return GraphUtils::AddCommentNodeToGraph(Blueprint, Graph, Desc.Name);
+	return GraphUtils::AddNodeByNameToGraph(Blueprint, Graph, Desc.Type);
+}
+
+UEdGraphPin* GraphApplyUtils::FindPin(UEdGraphNode* Node, const FString& NodeId, const FString& PinName)
+{
+	UEdGraphPin* Pin = Node->FindPin(PinName);
+	if (!Pin)
+		throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Pin %s not found on node %s"), *PinName, *NodeId)));
+	return Pin;
+}
+
+void GraphApplyUtils::OrientLink(UEdGraphPin*& From, UEdGraphPin*& To, const FGraphLinkDesc& Link)
+{
+	if (From->Direction == EGPD_Input && To->Direction == EGPD_Output)
+		Swap(From, To);
+	if (From->Direction != EGPD_Output || To->Direction != EGPD_Input)
+		throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Link %s.%s -> %s.%s doesn't join an output pin to an input pin"),
+			*Link.From, *Link.FromPin, *Link.To, *Link.ToPin)));
+}
+
+void GraphApplyUtils::CheckLink(const UEdGraphPin* From, const UEdGraphPin* To, const FGraphLinkDesc& Link)
+{
+	const FPinConnectionResponse Response = From->GetSchema()->CanCreateConnection(From, To);
+	if (Response.Response == CONNECT_RESPONSE_DISALLOW)
+		throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Link %s.%s -> %s.%s is not allowed: %s"),
+			*Link.From, *Link.FromPin, *Link.To, *Link.ToPin, *Response.Message.ToString())));
+}
+
+TArray<uint8> GraphApplyUtils::EncodeResult(const FGraphApplyResult& Result)
+{
+	MCP_TRACE_SCOPE("GraphApplyUtils::EncodeResult");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Created"), Result.Created);
+	Writer->WriteValue(TEXT("Deleted"), Result.Deleted);
+	Writer->WriteValue(TEXT("Updated"), Result.Updated);
+	Writer->WriteValue(TEXT("Linked"), Result.Linked);
+	Writer->WriteValue(TEXT("Unlinked"), Result.Unlinked);
+	Writer->WriteValue(TEXT("DefaultsSet"), Result.DefaultsSet);
+	Writer->WriteObjectStart(TEXT("Nodes"));
+	for (const TPair<FString, FGuid>& NodeId : Result.NodeIds)
+	{
+		Writer->WriteValue(NodeId.Key, NodeId.Value.ToString());
+	}
+	Writer->WriteObjectEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "UE5_MCP/API/DTO/Graph/ApplyGraphReq.h"
+#include <stdexcept>
+
+class UBlueprint;
+class UEdGraph;
+class UEdGraphNode;
+class UEdGraphNode_Comment;
+class UEdGraphPin;
+
+struct FGraphApplyResult
+{
+	// Client id to the GUID of its node, in the order of the description
+	TArray<TPair<FString, FGuid>> NodeIds;
+	int32 Created = 0;
+	int32 Deleted = 0;
+	int32 Updated = 0;
+	int32 Linked = 0;
+	int32 Unlinked = 0;
+	int32 DefaultsSet = 0;
+};
+
+// Reconciles a graph with a declarative description of the nodes, links and pin defaults it should have
+// Nodes keep a GUID derived from their client id, so applying a description again only touches what changed
+class GraphApplyUtils
+{
+public:
+	// Diffs the description against the graph and applies the edits in one transaction with one modified notification
+	// A description that matches the graph makes no edits and no transaction. If an edit fails the transaction is undone
+	static FGraphApplyResult ApplyGraph(UBlueprint* Blueprint, UEdGraph* Graph, const TArray<FGraphNodeDesc>& Nodes,
+	                                    const TArray<FGraphLinkDesc>& Links, bool bPrune);
+
+	// The GUID a client id resolves to in the graph, the id itself when it is a GUID
+	static FGuid ResolveNodeGuid(const UEdGraph* Graph, const FString& Id);
+
+	static TArray<uint8> EncodeResult(const FGraphApplyResult& Result);
+
+private:
+	using FLinkKey = TTuple<FGuid, FName, FGuid, FName>;
+
+	struct FPlan
+	{
+		TArray<UEdGraphNode*> ToDelete;
+		TArray<const FGraphNodeDesc*> ToCreate;
+		TArray<TPair<UEdGraphNode_Comment*, const FString*>> CommentsToUpdate;
+		TArray<TPair<UEdGraphPin*, UEdGraphPin*>> ToUnlink;
+		TArray<const FGraphLinkDesc*> ToLink;
+		TArray<TPair<UEdGraphPin*, const FString*>> DefaultsToSet;
+
+		bool IsEmpty() const
+		{
+			return ToDelete.Num() == 0 && ToCreate.Num() == 0 && CommentsToUpdate.Num() == 0 && ToUnlink.Num() == 0
+				&& ToLink.Num() == 0 && DefaultsToSet.Num() == 0;
+		}
+	};
+
+	// Whether an existing node is the node the description asks for, otherwise it is recreated
+	static bool MatchesNode(const UEdGraphNode* Node, const FGraphNodeDesc& Desc);
+
+	static UEdGraphNode* CreateNode(UBlueprint* Blueprint, UEdGraph* Graph, const FGraphNodeDesc& Desc);
+
+	static UEdGraphPin* FindPin(UEdGraphNode* Node, const FString& NodeId, const FString& PinName);
+
+	// Orders a link's pins output first, throwing when they can't form a link
+	static void OrientLink(UEdGraphPin*& From, UEdGraphPin*& To, const FGraphLinkDesc& Link);
+	// Throws when the graph's schema disallows the link, e.g. mismatched pin types
+	static void CheckLink(const UEdGraphPin* From, const UEdGraphPin* To, const FGraphLinkDesc& Link);
+
+	static void Execute(UBlueprint* Blueprint, UEdGraph* Graph, const FPlan& Plan, TMap<FGuid, UEdGraphNode*>& NodesByGuid,
+	                    const TMap<FString, FGuid>& GuidById, FGraphApplyResult& Result);
+};
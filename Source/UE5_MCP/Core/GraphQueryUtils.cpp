@@ -0,0 +1,242 @@
+﻿#include "GraphQueryUtils.h"
+#include "MCPTrace.h"
+
+FCriticalSection GraphQueryUtils::Lock;
+TMap<FString, GraphQueryUtils::FEntry> GraphQueryUtils::Entries;
+
+EGraphQuery GraphQueryUtils::ParseQueryKind(const FString& Name)
+{
+	if (Name.IsEmpty() || Name.Equals(TEXT("Filter"), ESearchCase::IgnoreCase))
+		return EGraphQuery::Filter;
+	if (Name.Equals(TEXT("ExecForward"), ESearchCase::IgnoreCase))
+		return EGraphQuery::ExecForward;
+	if (Name.Equals(TEXT("ExecBackward"), ESearchCase::IgnoreCase))
+		return EGraphQuery::ExecBackward;
+	if (Name.Equals(TEXT("DataUpstream"), ESearchCase::IgnoreCase))
+		return EGraphQuery::DataUpstream;
+	if (Name.Equals(TEXT("DataDownstream"), ESearchCase::IgnoreCase))
+		return EGraphQuery::DataDownstream;
+	throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(
+		TEXT("Unknown query %s, expected ExecForward, ExecBackward, DataUpstream, DataDownstream or Filter"), *Name)));
+}
+
+FGraphAdjacencyPtr GraphQueryUtils::GetAdjacency(const FBlueprintSnapshot& Snapshot, const FGraphSnapshot& Graph)
+{
+	MCP_TRACE_SCOPE("GraphQueryUtils::GetAdjacency");
+	// Snapshots taken outside SnapshotCache have no revision to key on
+	if (Snapshot.Revision == 0)
+		return BuildAdjacency(Graph);
+
+	const FString Key = FString::Printf(TEXT("%s:%s:%s"), *Snapshot.Path, *Graph.Kind, *Graph.Name);
+	{
+		FScopeLock ScopeLock(&Lock);
+		FEntry* Entry = Entries.Find(Key);
+		if (Entry && Entry->Revision == Snapshot.Revision)
+		{
+			Entry->LastAccessSeconds = FPlatformTime::Seconds();
+			return Entry->Adjacency;
+		}
+	}
+
+	// Built outside the lock, two queries racing on a new revision build the same adjacency twice
+	FGraphAdjacencyPtr Adjacency = BuildAdjacency(Graph);
+
+	FScopeLock ScopeLock(&Lock);
+	FEntry* Entry = Entries.Find(Key);
+	if (Entry && Entry->Revision > Snapshot.Revision)
+		return Adjacency;
+	if (!Entry && Entries.Num() >= MaxEntries)
+	{
+		const FString* Oldest = nullptr;
+		double OldestSeconds = TNumericLimits<double>::Max();
+		for (const TPair<FString, FEntry>& Pair : Entries)
+		{
+			if (Pair.Value.LastAccessSeconds < OldestSeconds)
+			{
+				OldestSeconds = Pair.Value.LastAccessSeconds;
+				Oldest = &Pair.Key;
+			}
+		}
+		if (Oldest)
+			Entries.Remove(FString(*Oldest));
+	}
+	Entries.Add(Key, { Snapshot.Revision, Adjacency, FPlatformTime::Seconds() });
+	return Adjacency;
+}
+
+FGraphAdjacencyPtr GraphQueryUtils::BuildAdjacency(const FGraphSnapshot& Graph)
+{
+	MCP_TRACE_SCOPE("GraphQueryUtils::BuildAdjacency");
+	TSharedRef<FGraphAdjacency, ESPMode::ThreadSafe> Adjacency = MakeShared<FGraphAdjacency, ESPMode::ThreadSafe>();
+	const int32 NodeCount = Graph.Nodes.Num();
+	Adjacency->NodeIndex.Reserve(NodeCount);
+	for (int32 Index = 0; Index < NodeCount; ++Index)
+	{
+		Adjacency->NodeIndex.Add(Graph.Nodes[Index].Id, Index);
+	}
+	Adjacency->ExecNext.SetNum(NodeCount);
+	Adjacency->ExecPrev.SetNum(NodeCount);
+	Adjacency->DataIn.SetNum(NodeCount);
+	Adjacency->DataOut.SetNum(NodeCount);
+
+	// Every link is on both of its pins, only the exec outputs and data inputs are walked so each is added once
+	for (int32 Index = 0; Index < NodeCount; ++Index)
+	{
+		for (const FPinSnapshot& Pin : Graph.Nodes[Index].Pins)
+		{
+			const bool bExec = Pin.IsExec();
+			const bool bInput = Pin.IsInput();
+			if (bExec == bInput)
+				continue;
+
+			for (const FPinLinkSnapshot& Link : Pin.Links)
+			{
+				const int32* Linked = Adjacency->NodeIndex.Find(Link.NodeId);
+				if (!Linked)
+					continue;
+				if (bExec)
+				{
+					Adjacency->ExecNext[Index].AddUnique(*Linked);
+					Adjacency->ExecPrev[*Linked].AddUnique(Index);
+				}
+				else
+				{
+					Adjacency->DataIn[Index].AddUnique(*Linked);
+					Adjacency->DataOut[*Linked].AddUnique(Index);
+				}
+			}
+		}
+	}
+	return Adjacency;
+}
+
+TArray<int32> GraphQueryUtils::Run(const FBlueprintSnapshot& Snapshot, const FGraphSnapshot& Graph, const FGraphQuery& Query)
+{
+	MCP_TRACE_SCOPE("GraphQueryUtils::Run");
+	TArray<int32> Result;
+	if (Query.Kind == EGraphQuery::Filter)
+	{
+		for (int32 Index = 0; Index < Graph.Nodes.Num(); ++Index)
+		{
+			if (MatchesFilters(Graph.Nodes[Index], Query))
+				Result.Add(Index);
+		}
+		return Result;
+	}
+
+	FGraphAdjacencyPtr Adjacency = GetAdjacency(Snapshot, Graph);
+
+	int32 Start = INDEX_NONE;
+	if (!Query.NodeId.IsEmpty())
+	{
+		if (const int32* Found = Adjacency->NodeIndex.Find(Query.NodeId))
+			Start = *Found;
+	}
+	else if (!Query.EventName.IsEmpty())
+	{
+		Start = Graph.Nodes.IndexOfByPredicate([&Query](const FNodeSnapshot& Node)
+		{
+			return Node.Meta.ContainsByPredicate([&Query](const TPair<FString, FString>& Meta)
+			{
+				return Meta.Key == TEXT("EventName") && Meta.Value.Equals(Query.EventName, ESearchCase::IgnoreCase);
+			});
+		});
+	}
+	else
+		throw std::runtime_error("Missing NodeId or EventName to start the query from");
+	if (Start == INDEX_NONE)
+		throw std::runtime_error("Start node not found in graph");
+
+	const bool bExec = Query.Kind == EGraphQuery::ExecForward || Query.Kind == EGraphQuery::ExecBackward;
+	const TArray<TArray<int32>>& Edges =
+		Query.Kind == EGraphQuery::ExecForward ? Adjacency->ExecNext
+		: Query.Kind == EGraphQuery::ExecBackward ? Adjacency->ExecPrev
+		: Query.Kind == EGraphQuery::DataUpstream ? Adjacency->DataIn
+		: Adjacency->DataOut;
+
+	TArray<int32> Frontier;
+	if (Query.PinName.IsEmpty())
+		Frontier = Edges[Start];
+	else
+	{
+		// Only the pin's own links for the first step, then the node level edges
+		const FPinSnapshot* Pin = Graph.Nodes[Start].Pins.FindByPredicate(
+			[&Query](const FPinSnapshot& Candidate) { return Candidate.Name == Query.PinName; });
+		if (!Pin)
+			throw std::runtime_error("Pin not found on start node");
+		const bool bWantInput = Query.Kind == EGraphQuery::ExecBackward || Query.Kind == EGraphQuery::DataUpstream;
+		if (Pin->IsExec() != bExec || Pin->IsInput() != bWantInput)
+			throw std::runtime_error(bWantInput ? "Pin must be an input of the kind the query follows"
+				: "Pin must be an output of the kind the query follows");
+		for (const FPinLinkSnapshot& Link : Pin->Links)
+		{
+			if (const int32* Linked = Adjacency->NodeIndex.Find(Link.NodeId))
+				Frontier.AddUnique(*Linked);
+		}
+	}
+
+	TBitArray<> Visited(false, Graph.Nodes.Num());
+	Visited[Start] = true;
+	TArray<int32> Reached;
+	for (int32 Depth = 1; Frontier.Num() > 0 && (Query.MaxDepth <= 0 || Depth <= Query.MaxDepth); ++Depth)
+	{
+		TArray<int32> Next;
+		for (int32 Index : Frontier)
+		{
+			if (Visited[Index])
+				continue;
+			Visited[Index] = true;
+			Reached.Add(Index);
+			Next.Append(Edges[Index]);
+		}
+		Frontier = MoveTemp(Next);
+	}
+
+	for (int32 Index : Reached)
+	{
+		if (MatchesFilters(Graph.Nodes[Index], Query))
+			Result.Add(Index);
+	}
+	return Result;
+}
+
+bool GraphQueryUtils::MatchesFilters(const FNodeSnapshot& Node, const FGraphQuery& Query)
+{
+	if (!Query.NodeType.IsEmpty())
+	{
+		FString Type = Node.Type;
+		Type.RemoveFromStart(TEXT("K2Node_"));
+		FString Wanted = Query.NodeType;
+		Wanted.RemoveFromStart(TEXT("K2Node_"));
+		if (!Type.Equals(Wanted, ESearchCase::IgnoreCase))
+			return false;
+	}
+
+	if (!Query.MemberName.IsEmpty() && !Node.Meta.ContainsByPredicate([&Query](const TPair<FString, FString>& Meta)
+	{
+		return (Meta.Key == TEXT("FuncName") || Meta.Key == TEXT("EventName") || Meta.Key == TEXT("VarName"))
+			&& Meta.Value.Equals(Query.MemberName, ESearchCase::IgnoreCase);
+	}))
+		return false;
+
+	if (!Query.PinType.IsEmpty() && !Node.Pins.ContainsByPredicate([&Query](const FPinSnapshot& Pin)
+	{
+		return Pin.Info.Contains(Query.PinType) || Pin.TypeObject.Contains(Query.PinType);
+	}))
+		return false;
+	return true;
+}
+
+TArray<uint8> GraphQueryUtils::EncodeNodes(const FGraphSnapshot& Graph, const TArray<int32>& NodeIndices)
+{
+	MCP_TRACE_SCOPE("GraphQueryUtils::EncodeNodes");
+	FGraphSnapshot Subset;
+	Subset.Name = Graph.Name;
+	Subset.Kind = Graph.Kind;
+	Subset.Nodes.Reserve(NodeIndices.Num());
+	for (int32 Index : NodeIndices)
+	{
+		Subset.Nodes.Add(Graph.Nodes[Index]);
+	}
+	return SnapshotUtils::EncodeGraph(Subset);
+}
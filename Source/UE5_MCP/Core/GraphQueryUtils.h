@@ -0,0 +1,73 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "SnapshotUtils.h"
+#include <stdexcept>
+
+// The links of one graph snapshot as per-node index lists, into the snapshot's Nodes array
+struct FGraphAdjacency
+{
+	TMap<FString, int32> NodeIndex;
+	TArray<TArray<int32>> ExecNext; // nodes an exec output runs
+	TArray<TArray<int32>> ExecPrev; // nodes whose exec output runs this node
+	TArray<TArray<int32>> DataIn; // nodes feeding an input of this node
+	TArray<TArray<int32>> DataOut; // nodes reading an output of this node
+};
+
+using FGraphAdjacencyPtr = TSharedPtr<const FGraphAdjacency, ESPMode::ThreadSafe>;
+
+enum class EGraphQuery : uint8
+{
+	ExecForward, // nodes run after the start node
+	ExecBackward, // nodes that can run before the start node
+	DataUpstream, // nodes its input values come from
+	DataDownstream, // nodes reading its output values
+	Filter // every node of the graph
+};
+
+struct FGraphQuery
+{
+	EGraphQuery Kind = EGraphQuery::Filter;
+	FString NodeId; // start node, or
+	FString EventName; // the event or custom event node to start from
+	FString PinName; // only follow the links of this pin of the start node
+	int32 MaxDepth = 0; // links followed from the start node, 0 for no limit
+
+	// Filters on the resulting nodes, empty ones match everything
+	FString NodeType; // node class, the K2Node_ prefix may be left out
+	FString MemberName; // called function, event or variable name
+	FString PinType; // part of a pin's type, e.g. 'exec', 'object(self)' or 'Actor'
+};
+
+// Answers reachability and filter queries over a graph snapshot without sending the whole graph
+// Adjacency is built once per graph revision and shared by every query on it
+class GraphQueryUtils
+{
+public:
+	static EGraphQuery ParseQueryKind(const FString& Name);
+
+	// Matching node indices in the order they are reached, safe on any thread
+	static TArray<int32> Run(const FBlueprintSnapshot& Snapshot, const FGraphSnapshot& Graph, const FGraphQuery& Query);
+
+	// Cached by Blueprint, graph and snapshot revision. Safe on any thread
+	static FGraphAdjacencyPtr GetAdjacency(const FBlueprintSnapshot& Snapshot, const FGraphSnapshot& Graph);
+
+	static FGraphAdjacencyPtr BuildAdjacency(const FGraphSnapshot& Graph);
+
+	// The matched nodes in the /get_graph format
+	static TArray<uint8> EncodeNodes(const FGraphSnapshot& Graph, const TArray<int32>& NodeIndices);
+
+private:
+	static bool MatchesFilters(const FNodeSnapshot& Node, const FGraphQuery& Query);
+
+	struct FEntry
+	{
+		uint64 Revision = 0;
+		FGraphAdjacencyPtr Adjacency;
+		double LastAccessSeconds = 0.0;
+	};
+
+	static constexpr int32 MaxEntries = 64;
+
+	static FCriticalSection Lock;
+	static TMap<FString, FEntry> Entries; // Blueprint path, graph kind and name
+};
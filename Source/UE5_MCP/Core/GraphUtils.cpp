@@ -1,7 +1,10 @@
 ﻿#include "GraphUtils.h"
+#include "MCPTrace.h"
 
+#include "ChangeEvents.h"
 #include "ClassUtils.h"
 #include "EdGraphNode_Comment.h"
+#include "JsonBuffer.h"
 #include "K2Node_BreakStruct.h"
 #include "K2Node_CallFunction.h"
 #include "K2Node_CastByteToEnum.h"
@@ -12,13 +15,80 @@
 #include "K2Node_SwitchEnum.h"
 #include "K2Node_VariableGet.h"
 #include "K2Node_VariableSet.h"
+#include "Metrics.h"
 #include "PinUtils.h"
 #include "Kismet2/BlueprintEditorUtils.h"
+#include "Serialization/MemoryWriter.h"
 
 
+int32 GraphUtils::BatchDepth = 0;
+TArray<GraphUtils::FBatchedChange> GraphUtils::BatchedChanges;
 
-void GraphUtils::AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName)
+GraphUtils::FScopedBatchEdit::FScopedBatchEdit()
 {
+	check(IsInGameThread());
+	++BatchDepth;
+}
+
+GraphUtils::FScopedBatchEdit::~FScopedBatchEdit()
+{
+	if (--BatchDepth > 0)
+		return;
+
+	TArray<FBatchedChange> Changes = MoveTemp(BatchedChanges);
+	TMap<UBlueprint*, bool> Blueprints;
+	for (const FBatchedChange& Change : Changes)
+	{
+		if (UBlueprint* Blueprint = Change.Blueprint.Get())
+			Blueprints.FindOrAdd(Blueprint) |= Change.bStructural;
+	}
+
+	// One skeleton refresh per Blueprint, only when one of its edits needed it
+	for (const TPair<UBlueprint*, bool>& Blueprint : Blueprints)
+	{
+		if (Blueprint.Value)
+			FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint.Key);
+		else
+			FBlueprintEditorUtils::MarkBlueprintAsModified(Blueprint.Key);
+	}
+	for (const FBatchedChange& Change : Changes)
+	{
+		if (Change.Blueprint.IsValid() && Change.Graph.IsValid())
+			ChangeEvents::MarkGraphChanged(Change.Blueprint.Get(), Change.Graph.Get());
+	}
+}
+
+void GraphUtils::NotifyGraphChanged(UBlueprint* Blueprint, UEdGraph* Graph, bool bStructural)
+{
+	if (BatchDepth > 0)
+	{
+		FBatchedChange* Existing = BatchedChanges.FindByPredicate([Blueprint, Graph](const FBatchedChange& Change)
+		{
+			return Change.Blueprint == Blueprint && Change.Graph == Graph;
+		});
+		if (Existing)
+			Existing->bStructural |= bStructural;
+		else
+			BatchedChanges.Add({ Blueprint, Graph, bStructural });
+		return;
+	}
+
+	if (bStructural)
+		FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	else
+		FBlueprintEditorUtils::MarkBlueprintAsModified(Blueprint);
+	ChangeEvents::MarkGraphChanged(Blueprint, Graph);
+}
+
+bool GraphUtils::IsStructuralNode(const UEdGraphNode* Node)
+{
+	const UK2Node* K2Node = Cast<UK2Node>(Node);
+	return K2Node && K2Node->NodeCausesStructuralBlueprintChange();
+}
+
+UEdGraphNode* GraphUtils::AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName)
+{
+    MCP_TRACE_SCOPE("GraphUtils::AddFunctionCallToGraph");
     if (!Blueprint || !Graph)
         throw std::runtime_error("Blueprint or Graph is null");
 
@@ -32,15 +102,18 @@ void GraphUtils::AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph,
 
     FGraphNodeCreator<UK2Node_CallFunction> NodeCreator(*Graph);
     UK2Node_CallFunction* CallFuncNode = NodeCreator.CreateNode();
+    TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
     CallFuncNode->SetFromFunction(TargetFunction);
     NodeCreator.Finalize();
 
-    FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+    NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CallFuncNode));
+    return CallFuncNode;
 }
 
-void GraphUtils::AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& ClassToCall,
+UEdGraphNode* GraphUtils::AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& ClassToCall,
 	const FString& FunctionName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddFunctionCallToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
@@ -54,15 +127,18 @@ void GraphUtils::AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph,
 
 	FGraphNodeCreator<UK2Node_CallFunction> NodeCreator(*Graph);
 	UK2Node_CallFunction* CallFuncNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	CallFuncNode->SetFromFunction(TargetFunction);
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CallFuncNode));
+	return CallFuncNode;
 }
 
 #include "Kismet/KismetMathLibrary.h"
 
-void GraphUtils::AddMathFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName)
+UEdGraphNode* GraphUtils::AddMathFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddMathFunctionCallToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
@@ -73,16 +149,19 @@ void GraphUtils::AddMathFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Gra
 	
 	FGraphNodeCreator<UK2Node_CallFunction> NodeCreator(*Graph);
 	UK2Node_CallFunction* CallFuncNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	CallFuncNode->SetFromFunction(TargetFunction);
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CallFuncNode));
+	return CallFuncNode;
 }
 
 
 
-void GraphUtils::AddEventToGraph(UBlueprint* Blueprint,
+UEdGraphNode* GraphUtils::AddEventToGraph(UBlueprint* Blueprint,
                                  UEdGraph* Graph, const FString& EventName)
 {
+    MCP_TRACE_SCOPE("GraphUtils::AddEventToGraph");
     if (!Blueprint || !Graph)
         throw std::runtime_error("Blueprint or Graph is null");
     
@@ -96,24 +175,28 @@ void GraphUtils::AddEventToGraph(UBlueprint* Blueprint,
     
     FGraphNodeCreator<UK2Node_Event> NodeCreator(*Graph);
     UK2Node_Event* EventNode = NodeCreator.CreateNode();
+    TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
     EventNode->EventReference.SetFromField<UFunction>(EventFunc, true);
     EventNode->bOverrideFunction = true;
     NodeCreator.Finalize();
 
-    FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+    NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(EventNode));
+    return EventNode;
 }
 
-void GraphUtils::AddCustomEventToGraph(
+UEdGraphNode* GraphUtils::AddCustomEventToGraph(
     UBlueprint* Blueprint,
     UEdGraph* Graph,
     const FString& EventName,
     const FString& EventSignature)
 {
-    if (!Blueprint || !Graph) return;
+    MCP_TRACE_SCOPE("GraphUtils::AddCustomEventToGraph");
+    if (!Blueprint || !Graph) return nullptr;
 
     // Create the node
     FGraphNodeCreator<UK2Node_CustomEvent> NodeCreator(*Graph);
     UK2Node_CustomEvent* CustomEventNode = NodeCreator.CreateNode();
+    TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
     CustomEventNode->CustomFunctionName = *EventName;
 
     // Always has execution pin
@@ -150,16 +233,18 @@ void GraphUtils::AddCustomEventToGraph(
 
     NodeCreator.Finalize();
 
-    FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+    NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CustomEventNode));
+    return CustomEventNode;
 }
 
 #include "EdGraph/EdGraph.h"
 #include "EdGraphSchema_K2.h"
 
 
-void GraphUtils::AddGetVariableNodeToGraph(
+UEdGraphNode* GraphUtils::AddGetVariableNodeToGraph(
     UBlueprint* Blueprint, UEdGraph* Graph, const FString& VarName)
 {
+    MCP_TRACE_SCOPE("GraphUtils::AddGetVariableNodeToGraph");
     if (!Blueprint || !Graph)
         throw std::runtime_error("Blueprint or Graph is null");
 
@@ -175,15 +260,18 @@ void GraphUtils::AddGetVariableNodeToGraph(
 
     FGraphNodeCreator<UK2Node_VariableGet> NodeCreator(*Graph);
     UK2Node_VariableGet* GetNode = NodeCreator.CreateNode();
+    TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
     GetNode->VariableReference.SetSelfMember(*VarName);
     NodeCreator.Finalize();
     
-    FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+    NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(GetNode));
+    return GetNode;
 }
 
-void GraphUtils::AddSetVariableNodeToGraph(
+UEdGraphNode* GraphUtils::AddSetVariableNodeToGraph(
     UBlueprint* Blueprint, UEdGraph* Graph, const FString& VarName)
 {
+    MCP_TRACE_SCOPE("GraphUtils::AddSetVariableNodeToGraph");
     if (!Blueprint || !Graph)
         throw std::runtime_error("Blueprint or Graph is null");
 
@@ -200,14 +288,17 @@ void GraphUtils::AddSetVariableNodeToGraph(
     
     FGraphNodeCreator<UK2Node_VariableSet> NodeCreator(*Graph);
     UK2Node_VariableSet* SetNode = NodeCreator.CreateNode();
+    TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
     SetNode->VariableReference.SetSelfMember(*VarName);
     NodeCreator.Finalize();
 
-    FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+    NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(SetNode));
+    return SetNode;
 }
 
-void GraphUtils::AddBreakStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName)
+UEdGraphNode* GraphUtils::AddBreakStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddBreakStructNodeToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
@@ -217,13 +308,16 @@ void GraphUtils::AddBreakStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Grap
 
 	FGraphNodeCreator<UK2Node_BreakStruct> NodeCreator(*Graph);
 	UK2Node_BreakStruct* BreakStructNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	BreakStructNode->StructType = Struct;
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(BreakStructNode));
+	return BreakStructNode;
 }
 
-void GraphUtils::AddMakeStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName)
+UEdGraphNode* GraphUtils::AddMakeStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddMakeStructNodeToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
@@ -233,25 +327,30 @@ void GraphUtils::AddMakeStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph
 
 	FGraphNodeCreator<UK2Node_MakeStruct> NodeCreator(*Graph);
 	UK2Node_MakeStruct* MakeStructNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	MakeStructNode->StructType = Struct;
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(MakeStructNode));
+	return MakeStructNode;
 }
 
-void GraphUtils::AddCommentNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& CommentText)
+UEdGraphNode* GraphUtils::AddCommentNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& CommentText)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddCommentNodeToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
 	FGraphNodeCreator<UEdGraphNode_Comment> NodeCreator(*Graph);
 	UEdGraphNode_Comment* CommentNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	CommentNode->NodeComment = CommentText;
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CommentNode));
+	return CommentNode;
 }
 
 /*
-void GraphUtils::AddSwitchEnumNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
+UEdGraphNode* GraphUtils::AddSwitchEnumNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
 {
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
@@ -262,11 +361,13 @@ void GraphUtils::AddSwitchEnumNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph
 	
 	FGraphNodeCreator<UK2Node_SwitchEnum> NodeCreator(*Graph);
 	UK2Node_SwitchEnum* SwitchEnumNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	// some reason SetEnum doesn't work
 	// unresolved external symbol "public: void __cdecl UK2Node_SwitchEnum::SetEnum(class UEnum *)"
 	SwitchEnumNode->SetEnum(Enum);
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(SwitchEnumNode));
+	return SwitchEnumNode;
 }*/
 
 UClass* GraphUtils::FindK2NodeClassByName(const FString& NodeClassName)
@@ -283,8 +384,9 @@ UClass* GraphUtils::FindK2NodeClassByName(const FString& NodeClassName)
 }
 
 
-void GraphUtils::AddNodeByNameToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& NodeTypeName)
+UEdGraphNode* GraphUtils::AddNodeByNameToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& NodeTypeName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddNodeByNameToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
@@ -300,12 +402,15 @@ void GraphUtils::AddNodeByNameToGraph(UBlueprint* Blueprint, UEdGraph* Graph, co
 	NewNode->PostPlacedNewNode();
 	NewNode->AllocateDefaultPins();
 	Graph->AddNode(NewNode);
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(NewNode));
+	return NewNode;
 }
 
-void GraphUtils::AddDynamicCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
+UEdGraphNode* GraphUtils::AddDynamicCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddDynamicCastNodeToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
@@ -316,13 +421,16 @@ void GraphUtils::AddDynamicCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Grap
 
 	FGraphNodeCreator<UK2Node_DynamicCast> NodeCreator(*Graph);
 	UK2Node_DynamicCast* CastNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	CastNode->TargetType = TargetClass;
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CastNode));
+	return CastNode;
 }
 
-void GraphUtils::AddClassCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
+UEdGraphNode* GraphUtils::AddClassCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddClassCastNodeToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 	auto TargetClass = ClassUtils::FindClassByName(PinTypeName);
@@ -331,13 +439,16 @@ void GraphUtils::AddClassCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph,
 
 	FGraphNodeCreator<UK2Node_ClassDynamicCast> NodeCreator(*Graph);
 	UK2Node_ClassDynamicCast* CastNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	CastNode->TargetType = TargetClass;
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CastNode));
+	return CastNode;
 }
 
-void GraphUtils::AddByteToEnumNodeCastToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
+UEdGraphNode* GraphUtils::AddByteToEnumNodeCastToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::AddByteToEnumNodeCastToGraph");
 	if (!Blueprint || !Graph)
 		throw std::runtime_error("Blueprint or Graph is null");
 
@@ -347,14 +458,17 @@ void GraphUtils::AddByteToEnumNodeCastToGraph(UBlueprint* Blueprint, UEdGraph* G
 
 	FGraphNodeCreator<UK2Node_CastByteToEnum> NodeCreator(*Graph);
 	UK2Node_CastByteToEnum* CastNode = NodeCreator.CreateNode();
+	TRACE_COUNTER_INCREMENT(UE5_MCP_NodesCreated);
 	CastNode->Enum = Enum;
 	NodeCreator.Finalize();
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, IsStructuralNode(CastNode));
+	return CastNode;
 }
 
 
 TArray<FString> GraphUtils::GetSupportedNode()
 {
+	MCP_TRACE_SCOPE("GraphUtils::GetSupportedNode");
 	TArray<FString> NodeTypes;
 	for (TObjectIterator<UClass> It; It; ++It)
 	{
@@ -392,8 +506,10 @@ void GraphUtils::ConnectPins(
 	UBlueprint* Blueprint,
 	UEdGraph* Graph,
 	const FGuid& OutputNodeId, const FString& OutputPinName,
-	const FGuid& InputNodeId, const FString& InputPinName)
+	const FGuid& InputNodeId, const FString& InputPinName,
+	bool bValidate)
 {
+	MCP_TRACE_SCOPE("GraphUtils::ConnectPins");
 	if (!Blueprint)
 		throw std::runtime_error("Blueprint is null");
     
@@ -413,14 +529,119 @@ void GraphUtils::ConnectPins(
 	if (!OutPin || !InPin)
 		throw std::runtime_error("OutPin or InPin not found");
 
-	OutPin->MakeLinkTo(InPin);
+	if (bValidate)
+	{
+		const UEdGraphSchema* Schema = Graph->GetSchema();
+		const FPinConnectionResponse Response = Schema->CanCreateConnection(OutPin, InPin);
+		if (Response.Response == CONNECT_RESPONSE_DISALLOW)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Cannot connect %s to %s: %s"),
+				*OutputPinName, *InputPinName, *Response.Message.ToString())));
+		// Breaks the links the response asks for and adds the conversion or promotion node if one is needed
+		if (!Schema->TryCreateConnection(OutPin, InPin))
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Failed to connect %s to %s"),
+				*OutputPinName, *InputPinName)));
+	}
+	else
+		OutPin->MakeLinkTo(InPin);
+	TRACE_COUNTER_INCREMENT(UE5_MCP_PinsLinked);
+
+	NotifyGraphChanged(Blueprint, Graph, false);
+}
+
+TArray<FPinConnectionCheck> GraphUtils::CheckPinConnections(UEdGraph* Graph,
+	const TArray<FPinConnectionCandidate>& Candidates)
+{
+	MCP_TRACE_SCOPE("GraphUtils::CheckPinConnections");
+	if (!Graph)
+		throw std::runtime_error("Graph is null");
+
+	const UEdGraphSchema* Schema = Graph->GetSchema();
+	TMap<FGuid, UEdGraphNode*> Nodes;
+	Nodes.Reserve(Graph->Nodes.Num());
+	for (UEdGraphNode* Node : Graph->Nodes)
+	{
+		if (Node)
+			Nodes.Add(Node->NodeGuid, Node);
+	}
 
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	TArray<FPinConnectionCheck> Checks;
+	Checks.Reserve(Candidates.Num());
+	for (const FPinConnectionCandidate& Candidate : Candidates)
+	{
+		FPinConnectionCheck& Check = Checks.AddDefaulted_GetRef();
+		UEdGraphNode* const* OutputNode = Nodes.Find(Candidate.OutputNodeId);
+		UEdGraphNode* const* InputNode = Nodes.Find(Candidate.InputNodeId);
+		if (!OutputNode || !InputNode)
+		{
+			Check.Message = TEXT("OutputNode or InputNode not found");
+			continue;
+		}
+		const UEdGraphPin* OutPin = (*OutputNode)->FindPin(Candidate.OutputPinName);
+		const UEdGraphPin* InPin = (*InputNode)->FindPin(Candidate.InputPinName);
+		if (!OutPin || !InPin)
+		{
+			Check.Message = TEXT("OutPin or InPin not found");
+			continue;
+		}
+		const FPinConnectionResponse Response = Schema->CanCreateConnection(OutPin, InPin);
+		Check.Response = Response.Response;
+		Check.Message = Response.Message.ToString();
+	}
+	return Checks;
+}
+
+const TCHAR* GraphUtils::GetConnectionResponseName(ECanCreateConnectionResponse Response)
+{
+	switch (Response)
+	{
+	case CONNECT_RESPONSE_MAKE:
+		return TEXT("Make");
+	case CONNECT_RESPONSE_BREAK_OTHERS_A:
+		return TEXT("BreakOthersA");
+	case CONNECT_RESPONSE_BREAK_OTHERS_B:
+		return TEXT("BreakOthersB");
+	case CONNECT_RESPONSE_BREAK_OTHERS_AB:
+		return TEXT("BreakOthersAB");
+	case CONNECT_RESPONSE_MAKE_WITH_CONVERSION_NODE:
+		return TEXT("MakeWithConversionNode");
+	case CONNECT_RESPONSE_MAKE_WITH_PROMOTION:
+		return TEXT("MakeWithPromotion");
+	default:
+		return TEXT("Disallow");
+	}
+}
+
+TArray<uint8> GraphUtils::EncodePinConnectionChecks(const TArray<FPinConnectionCheck>& Checks)
+{
+	MCP_TRACE_SCOPE("GraphUtils::EncodePinConnectionChecks");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	// One result per candidate, in request order
+	Writer->WriteArrayStart();
+	for (const FPinConnectionCheck& Check : Checks)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Response"), GetConnectionResponseName(Check.Response));
+		Writer->WriteValue(TEXT("CanConnect"), Check.Response != CONNECT_RESPONSE_DISALLOW);
+		// Anything but a plain link needs connect_pins with Validate, otherwise the pins are linked directly,
+		// keeping the other links of a single link pin or skipping the conversion node, and the next compile fails
+		Writer->WriteValue(TEXT("NeedsValidate"), Check.Response != CONNECT_RESPONSE_MAKE
+			&& Check.Response != CONNECT_RESPONSE_DISALLOW);
+		if (!Check.Message.IsEmpty())
+			Writer->WriteValue(TEXT("Message"), Check.Message);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->Close();
+	return Output;
 }
 
 void GraphUtils::BreakPinConnection(UBlueprint* Blueprint, UEdGraph* Graph, const FGuid& OutputNodeId,
 	const FString& OutputPinName, const FGuid& InputNodeId, const FString& InputPinName)
 {
+	MCP_TRACE_SCOPE("GraphUtils::BreakPinConnection");
 	
 	if (!Blueprint)
 		throw std::runtime_error("Blueprint is null");
@@ -443,7 +664,7 @@ void GraphUtils::BreakPinConnection(UBlueprint* Blueprint, UEdGraph* Graph, cons
 
 	OutPin->BreakLinkTo(InPin);
 
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	NotifyGraphChanged(Blueprint, Graph, false);
 }
 
 void GraphUtils::SetPinDefaultValue(
@@ -453,6 +674,7 @@ void GraphUtils::SetPinDefaultValue(
 	const FString& PinName,
 	const FString& DefaultValue)
 {
+	MCP_TRACE_SCOPE("GraphUtils::SetPinDefaultValue");
 	if (!Blueprint)
 		throw std::runtime_error("Blueprint is null");
     
@@ -471,5 +693,6 @@ void GraphUtils::SetPinDefaultValue(
 	Pin->DefaultValue = DefaultValue;
 
 	Node->PinDefaultValueChanged(Pin);
+	NotifyGraphChanged(Blueprint, Graph, false);
 }
 
@@ -1,58 +1,102 @@
 ﻿#pragma once
+#include "EdGraph/EdGraphSchema.h"
 #include <stdexcept>
 
+// A link to check, the output pin is usually the source but either order is accepted, as in the editor
+struct FPinConnectionCandidate
+{
+	FGuid OutputNodeId;
+	FString OutputPinName;
+	FGuid InputNodeId;
+	FString InputPinName;
+};
+
+struct FPinConnectionCheck
+{
+	ECanCreateConnectionResponse Response = CONNECT_RESPONSE_DISALLOW;
+	FString Message; // why it is disallowed, or what connecting would change
+};
+
 // Utility functions for manipulating Blueprint graphs
 class GraphUtils
 {
 	static UEdGraphNode* GetNodeById(UEdGraph* Graph, const FGuid& NodeId);
 
 	static UClass* FindK2NodeClassByName(const FString& NodeTypeName);
+
+	struct FBatchedChange
+	{
+		TWeakObjectPtr<UBlueprint> Blueprint;
+		TWeakObjectPtr<UEdGraph> Graph;
+		bool bStructural = false;
+	};
+
+	static int32 BatchDepth;
+	static TArray<FBatchedChange> BatchedChanges;
 public:
-	
+	// Defers the modified notification of every edit made while it is alive
+	// Each Blueprint is notified once, and each graph reports one change, when the outermost scope ends
+	// The skeleton class is only regenerated when one of the edits was structural
+	struct FScopedBatchEdit
+	{
+		FScopedBatchEdit();
+		~FScopedBatchEdit();
+	};
+
+	// Notifies the editor that a graph changed, or records it for the end of the current batch
+	// Structural edits change the Blueprint's class, e.g. adding an event, and regenerate the skeleton class
+	// Wiring pins, setting defaults and most nodes only mark the Blueprint as modified
+	static void NotifyGraphChanged(UBlueprint* Blueprint, UEdGraph* Graph, bool bStructural);
+
+	// Whether adding or removing the node changes the Blueprint's class
+	static bool IsStructuralNode(const UEdGraphNode* Node);
+
 #pragma region AddNodes
+	// Every Add function returns the node it created
+
 	// Adds a function / custom event call node to the specified Blueprint's graph, calling the function from the Blueprint's own class
 	// Careful: it doesn't check duplicated custom event names, may cause compile errors
-	static void AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName);
+	static UEdGraphNode* AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName);
 
 	// Adds a function call node to the specified Blueprint's graph, specifying the class to call the function from
-	static void AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& ClassToCall, const FString& FunctionName);
+	static UEdGraphNode* AddFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& ClassToCall, const FString& FunctionName);
 
 	// Adds a math function call node to the specified Blueprint's graph, calling the function from UKismetMathLibrary
-	static void AddMathFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName);
+	static UEdGraphNode* AddMathFunctionCallToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& FunctionName);
 
 	// Adds an existed event to the specified Blueprint's event graph
 	// Careful: it doesn't check duplicated event names, may cause compile errors
-	static void AddEventToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& EventName);
+	static UEdGraphNode* AddEventToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& EventName);
 	
 	// Adds a custom event to the specified Blueprint's graph
-	static void AddCustomEventToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& EventName, const FString& EventSignature);
+	static UEdGraphNode* AddCustomEventToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& EventName, const FString& EventSignature);
 
 	// Adds a variable get node to the specified Blueprint's graph
-	static void AddGetVariableNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& VarName);
+	static UEdGraphNode* AddGetVariableNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& VarName);
 
 	// Adds a variable set node to the specified Blueprint's graph
-	static void AddSetVariableNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& VarName);
+	static UEdGraphNode* AddSetVariableNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& VarName);
 
 	// Adds a Break Struct node to the specified Blueprint's graph
-	static void AddBreakStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName);
+	static UEdGraphNode* AddBreakStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName);
 
 	// Adds a Make Struct node to the specified Blueprint's graph
-	static void AddMakeStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName);
+	static UEdGraphNode* AddMakeStructNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& StructTypeName);
 
 	// Adds a Comment node to the specified Blueprint's graph
-	static void AddCommentNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& CommentText);
+	static UEdGraphNode* AddCommentNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& CommentText);
 
 	// Adds a Switch Enum node to the specified Blueprint's graph
-	// static void AddSwitchEnumNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
+	// static UEdGraphNode* AddSwitchEnumNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
 
 	// Adds a Dynamic Cast node to the specified Blueprint's graph
-	static void AddDynamicCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
+	static UEdGraphNode* AddDynamicCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
 
 	// Adds a Class Cast node to the specified Blueprint's graph
-	static void AddClassCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
+	static UEdGraphNode* AddClassCastNodeToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
 
 	// Adds a Byte to Enum Cast node to the specified Blueprint's graph
-	static void AddByteToEnumNodeCastToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
+	static UEdGraphNode* AddByteToEnumNodeCastToGraph(UBlueprint* Blueprint, UEdGraph* Graph, const FString& PinTypeName);
 
 	// TODO: Add support for Switch on Name, String, Int nodes
 	
@@ -65,7 +109,7 @@ public:
 	// Adds a node by its type name to the specified Blueprint's graph
 	// This is fallback method for adding nodes that do not have specific handling implemented
 	// For nodes have implemented handling, please use the specific functions above instead
-	static void AddNodeByNameToGraph(UBlueprint* Blueprint,
+	static UEdGraphNode* AddNodeByNameToGraph(UBlueprint* Blueprint,
 		UEdGraph* Graph,
 		const FString& NodeTypeName);
 
@@ -77,12 +121,24 @@ public:
 #pragma region PinOperations
 
 	// Connects two pins from two nodes in the specified Blueprint's graph
+	// With bValidate the graph's schema must allow the link, which may break the pins' other links
+	// or insert a conversion node, the way dragging a wire in the editor does
 	static void ConnectPins(UBlueprint* Blueprint,
 	                                UEdGraph* Graph,
 	                                const FGuid& OutputNodeId,
 	                                const FString& OutputPinName,
 	                                const FGuid& InputNodeId,
-	                                const FString& InputPinName);
+	                                const FString& InputPinName,
+	                                bool bValidate = false);
+
+	// Asks the graph's schema whether each candidate link can be made, without changing the graph
+	// Missing nodes and pins are reported as disallowed instead of failing the whole batch
+	static TArray<FPinConnectionCheck> CheckPinConnections(UEdGraph* Graph,
+	                                                       const TArray<FPinConnectionCandidate>& Candidates);
+
+	static const TCHAR* GetConnectionResponseName(ECanCreateConnectionResponse Response);
+
+	static TArray<uint8> EncodePinConnectionChecks(const TArray<FPinConnectionCheck>& Checks);
 
 	// Breaks the connection between two pins from two nodes in the specified Blueprint's graph
 	static void BreakPinConnection(UBlueprint* Blueprint,
@@ -0,0 +1,190 @@
+﻿#include "ImpactUtils.h"
+#include "MCPTrace.h"
+
+#include "AssetLoadUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "EdGraph/EdGraph.h"
+#include "Engine/Blueprint.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_FunctionEntry.h"
+#include "K2Node_Variable.h"
+#include "K2Node_VariableSet.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/UObjectGlobals.h"
+
+TArray<FString> ImpactUtils::FindCandidates(const FString& PackagePath, const UClass* OwnerClass)
+{
+	MCP_TRACE_SCOPE("ImpactUtils::FindCandidates");
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	auto IsBlueprintPackage = [&AssetRegistry](FName Package)
+	{
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByPackageName(Package, Assets);
+		return Assets.ContainsByPredicate([](const FAssetData& Asset) { return Asset.IsInstanceOf(UBlueprint::StaticClass()); });
+	};
+
+	// Child Blueprints inherit the member without referencing the owner's package from the node using it, so they
+	// come from the registry's class hierarchy, which covers unloaded Blueprints
+	TArray<FString> Candidates = { PackagePath };
+	TSet<FTopLevelAssetPath> DerivedClasses;
+	AssetRegistry.GetDerivedClassNames({ OwnerClass->GetClassPathName() }, {}, DerivedClasses);
+	for (const FTopLevelAssetPath& DerivedClass : DerivedClasses)
+	{
+		if (IsBlueprintPackage(DerivedClass.GetPackageName()))
+			Candidates.AddUnique(DerivedClass.GetPackageName().ToString());
+	}
+
+	// Using a member hard references the class it was resolved from, the owner or one of its children
+	const int32 OwnerCount = Candidates.Num();
+	for (int32 Index = 0; Index < OwnerCount; ++Index)
+	{
+		TArray<FName> Referencers;
+		AssetRegistry.GetReferencers(FName(*Candidates[Index]), Referencers, UE::AssetRegistry::EDependencyCategory::Package,
+			UE::AssetRegistry::EDependencyQuery::Hard);
+		for (const FName& Referencer : Referencers)
+		{
+			if (IsBlueprintPackage(Referencer))
+				Candidates.AddUnique(Referencer.ToString());
+		}
+	}
+	return Candidates;
+}
+
+void ImpactUtils::InspectBlueprint(UBlueprint* Candidate, const UClass* OwnerClass, FName MemberName, bool bFunction,
+	TArray<FMemberUsage>& OutUsages)
+{
+	MCP_TRACE_SCOPE("ImpactUtils::InspectBlueprint");
+	const FString BlueprintPath = Candidate->GetPackage()->GetName();
+	// Members of the Blueprint being inspected resolve to its skeleton class, which derives from the owner too
+	auto IsOwnedMember = [OwnerClass](const UClass* MemberParent)
+	{
+		return MemberParent && MemberParent->GetAuthoritativeClass()->IsChildOf(OwnerClass);
+	};
+	auto Add = [&](const UEdGraph* Graph, const UEdGraphNode* Node, const TCHAR* Usage)
+	{
+		OutUsages.Add({ BlueprintPath, Graph->GetName(), Node->NodeGuid.ToString(), Usage });
+	};
+
+	TArray<UEdGraph*> Graphs;
+	Candidate->GetAllGraphs(Graphs);
+	for (const UEdGraph* Graph : Graphs)
+	{
+		for (const UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (bFunction)
+			{
+				if (const UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node))
+				{
+					if (CallNode->FunctionReference.GetMemberName() == MemberName
+						&& IsOwnedMember(CallNode->FunctionReference.GetMemberParentClass(CallNode->GetBlueprintClassFromNode())))
+						Add(Graph, Node, TEXT("Call"));
+				}
+				// Overrides in child Blueprints have to keep the signature
+				else if (Node->IsA<UK2Node_FunctionEntry>())
+				{
+					if (Candidate->GeneratedClass != OwnerClass && Graph->GetFName() == MemberName
+						&& IsOwnedMember(Candidate->ParentClass))
+						Add(Graph, Node, TEXT("Override"));
+				}
+				continue;
+			}
+
+			if (const UK2Node_Variable* VariableNode = Cast<UK2Node_Variable>(Node))
+			{
+				if (VariableNode->GetVarName() == MemberName
+					&& IsOwnedMember(VariableNode->VariableReference.GetMemberParentClass(VariableNode->GetBlueprintClassFromNode())))
+					Add(Graph, Node, Node->IsA<UK2Node_VariableSet>() ? TEXT("Set") : TEXT("Get"));
+			}
+		}
+	}
+}
+
+FImpactReport ImpactUtils::AnalyzeMemberImpact(UBlueprint* Blueprint, const FString& MemberName, const FString& MemberKind)
+{
+	MCP_TRACE_SCOPE("ImpactUtils::AnalyzeMemberImpact");
+	if (!Blueprint)
+		throw std::runtime_error("Blueprint is null");
+	if (!Blueprint->GeneratedClass)
+		throw std::runtime_error("Blueprint's GeneratedClass is null, please compile the Blueprint first");
+
+	const bool bFunction = MemberKind.Equals(TEXT("Function"), ESearchCase::IgnoreCase);
+	if (!bFunction && !MemberKind.Equals(TEXT("Variable"), ESearchCase::IgnoreCase))
+		throw std::runtime_error("Member kind must be Function or Variable");
+
+	FImpactReport Report;
+	const UClass* OwnerClass = Blueprint->GeneratedClass->GetAuthoritativeClass();
+	Report.Candidates = FindCandidates(Blueprint->GetPackage()->GetName(), OwnerClass);
+
+	for (int32 BatchStart = 0; BatchStart < Report.Candidates.Num(); BatchStart += BatchSize)
+	{
+		const TArray<FString> Batch(Report.Candidates.GetData() + BatchStart,
+			FMath::Min(BatchSize, Report.Candidates.Num() - BatchStart));
+
+		// The whole batch loads on the async loading threads at once
+		double StartSeconds = FPlatformTime::Seconds();
+		{
+			Metrics::FScopedPhase Phase(EMetricPhase::Load);
+			AssetLoadUtils::Prefetch(Batch);
+			FlushAsyncLoading();
+		}
+		Report.LoadMs += (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+		StartSeconds = FPlatformTime::Seconds();
+		for (const FString& Path : Batch)
+		{
+			UBlueprint* Candidate = Cast<UBlueprint>(AssetLoadUtils::FindLoadedObject(UBlueprint::StaticClass(), Path));
+			if (!Candidate)
+			{
+				Report.Failed.Add(Path);
+				continue;
+			}
+			InspectBlueprint(Candidate, OwnerClass, FName(*MemberName), bFunction, Report.Usages);
+		}
+		Report.InspectMs += (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+	}
+	return Report;
+}
+
+TArray<uint8> ImpactUtils::EncodeReport(const FImpactReport& Report)
+{
+	MCP_TRACE_SCOPE("ImpactUtils::EncodeReport");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	// Every package that was scanned, so an empty Usages can be told apart from a Blueprint that was never looked at
+	Writer->WriteArrayStart(TEXT("Candidates"));
+	for (const FString& Path : Report.Candidates)
+	{
+		Writer->WriteValue(Path);
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteArrayStart(TEXT("Failed"));
+	for (const FString& Path : Report.Failed)
+	{
+		Writer->WriteValue(Path);
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectStart(TEXT("Timing"));
+	Writer->WriteValue(TEXT("LoadMs"), Report.LoadMs);
+	Writer->WriteValue(TEXT("InspectMs"), Report.InspectMs);
+	Writer->WriteObjectEnd();
+	Writer->WriteArrayStart(TEXT("Usages"));
+	for (const FMemberUsage& Usage : Report.Usages)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Blueprint"), Usage.BlueprintPath);
+		Writer->WriteValue(TEXT("Graph"), Usage.Graph);
+		Writer->WriteValue(TEXT("NodeId"), Usage.NodeId);
+		Writer->WriteValue(TEXT("Usage"), Usage.Usage);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
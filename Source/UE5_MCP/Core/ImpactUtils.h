@@ -0,0 +1,42 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include <stdexcept>
+
+class UBlueprint;
+
+struct FMemberUsage
+{
+	FString BlueprintPath;
+	FString Graph;
+	FString NodeId;
+	FString Usage; // Call, Get, Set or Override
+};
+
+struct FImpactReport
+{
+	TArray<FString> Candidates; // the Blueprint and the Blueprints referencing its package
+	TArray<FString> Failed; // candidates that couldn't be loaded
+	TArray<FMemberUsage> Usages;
+	double LoadMs = 0.0;
+	double InspectMs = 0.0;
+};
+
+// Finds the nodes a change to a Blueprint member would break, loading only the Blueprints that can use it
+class ImpactUtils
+{
+public:
+	// Candidates come from the asset registry's referencers of the Blueprint's package, nothing else is loaded
+	// They are loaded asynchronously in batches and each batch is inspected once it is in memory
+	static FImpactReport AnalyzeMemberImpact(UBlueprint* Blueprint, const FString& MemberName, const FString& MemberKind);
+
+	static TArray<uint8> EncodeReport(const FImpactReport& Report);
+
+private:
+	// The owner, the Blueprints deriving from it, and the Blueprints hard referencing any of them
+	static TArray<FString> FindCandidates(const FString& PackagePath, const UClass* OwnerClass);
+
+	static void InspectBlueprint(UBlueprint* Candidate, const UClass* OwnerClass, FName MemberName, bool bFunction,
+	                             TArray<FMemberUsage>& OutUsages);
+
+	static constexpr int32 BatchSize = 16;
+};
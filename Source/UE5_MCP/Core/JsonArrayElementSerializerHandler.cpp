@@ -3,7 +3,7 @@
 TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	{
 		FByteProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FByteProperty>(InnerProp))
 			{
@@ -21,7 +21,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FInt16Property::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FInt16Property>(InnerProp))
 			{
@@ -32,7 +32,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FIntProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FIntProperty>(InnerProp))
 			{
@@ -43,7 +43,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FInt64Property::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FInt64Property>(InnerProp))
 			{
@@ -54,7 +54,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FFloatProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FFloatProperty>(InnerProp))
 			{
@@ -65,7 +65,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FDoubleProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FDoubleProperty>(InnerProp))
 			{
@@ -76,7 +76,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FBoolProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FBoolProperty>(InnerProp))
 			{
@@ -87,7 +87,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FStrProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FStrProperty>(InnerProp))
 			{
@@ -98,7 +98,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FNameProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FNameProperty>(InnerProp))
 			{
@@ -109,7 +109,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FTextProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FTextProperty>(InnerProp))
 			{
@@ -120,7 +120,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FObjectProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (auto Prop = CastField<FObjectProperty>(InnerProp))
 			{
@@ -143,7 +143,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FStructProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const FStructProperty* StructProp = CastField<FStructProperty>(InnerProp))
 			{
@@ -160,7 +160,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FArrayProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const FArrayProperty* ArrayProp = CastField<FArrayProperty>(InnerProp))
 			{
@@ -175,7 +175,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FSetProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const FSetProperty* SetProp = CastField<FSetProperty>(InnerProp))
 			{
@@ -190,7 +190,7 @@ TMap<FFieldClass*, FJsonArraySerializerFunc> ObjUtils::JsonArraySerializers {
 	},
 	{
 		FEnumProperty::StaticClass(),
-		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)
+		[](FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)
 		{
 			if (const auto Prop = CastField<FEnumProperty>(InnerProp))
 			{
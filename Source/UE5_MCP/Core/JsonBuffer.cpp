@@ -0,0 +1,93 @@
+﻿#include "JsonBuffer.h"
+
+FCriticalSection JsonBuffer::PoolLock;
+TArray<TArray<uint8>> JsonBuffer::Pool;
+std::atomic<int64> JsonBuffer::SizeHint{0};
+std::atomic<uint64> JsonBuffer::BytesProduced{0};
+std::atomic<uint64> JsonBuffer::CopiesAvoided{0};
+std::atomic<uint64> JsonBuffer::BuffersReused{0};
+std::atomic<uint64> JsonBuffer::BuffersAllocated{0};
+
+TArray<uint8> JsonBuffer::Acquire()
+{
+	{
+		FScopeLock Lock(&PoolLock);
+		if (Pool.Num() > 0)
+		{
+			++BuffersReused;
+			return Pool.Pop();
+		}
+	}
+
+	++BuffersAllocated;
+	TArray<uint8> Buffer;
+	Buffer.Reserve(static_cast<int32>(FMath::Min(SizeHint.load(), MaxReservedBytes)));
+	return Buffer;
+}
+
+void JsonBuffer::Recycle(TArray<uint8>&& Buffer)
+{
+	if (Buffer.Max() == 0 || Buffer.Max() > MaxPooledBytes)
+		return;
+
+	Buffer.Reset();
+	FScopeLock Lock(&PoolLock);
+	if (Pool.Num() < MaxPooledBuffers)
+		Pool.Add(MoveTemp(Buffer));
+}
+
+void JsonBuffer::RecordMovedToResponse(int64 Bytes)
+{
+	BytesProduced += Bytes;
+	++CopiesAvoided;
+	// Racy updates only make the hint a little less smooth
+	SizeHint.store((SizeHint.load() * 7 + Bytes) / 8);
+}
+
+JsonBuffer::FStats JsonBuffer::GetStats()
+{
+	FStats Stats;
+	Stats.BytesProduced = BytesProduced.load();
+	Stats.CopiesAvoided = CopiesAvoided.load();
+	Stats.BuffersReused = BuffersReused.load();
+	Stats.BuffersAllocated = BuffersAllocated.load();
+	return Stats;
+}
+
+void JsonBuffer::AppendString(TArray<uint8>& Out, const FString& Value)
+{
+	static const ANSICHAR* Hex = "0123456789abcdef";
+	const FTCHARToUTF8 Utf8(*Value);
+	const uint8* Bytes = reinterpret_cast<const uint8*>(Utf8.Get());
+
+	Out.Add('"');
+	for (int32 i = 0; i < Utf8.Length(); ++i)
+	{
+		const uint8 C = Bytes[i];
+		if (C == '"' || C == '\\')
+		{
+			Out.Add('\\');
+			Out.Add(C);
+		}
+		else if (C == '\n')
+			AppendRaw(Out, "\\n");
+		else if (C == '\r')
+			AppendRaw(Out, "\\r");
+		else if (C == '\t')
+			AppendRaw(Out, "\\t");
+		else if (C < 0x20)
+		{
+			AppendRaw(Out, "\\u00");
+			Out.Add(Hex[C >> 4]);
+			Out.Add(Hex[C & 0xF]);
+		}
+		else
+			Out.Add(C);
+	}
+	Out.Add('"');
+}
+
+void JsonBuffer::AppendRaw(TArray<uint8>& Out, const ANSICHAR* Text)
+{
+	Out.Append(reinterpret_cast<const uint8*>(Text), FCStringAnsi::Strlen(Text));
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/MemoryWriter.h"
+
+#include <atomic>
+
+// JSON writer that encodes straight to UTF-8, responses are built with it instead of a UTF-16 FString
+using FUtf8JsonWriter = TJsonWriter<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>;
+using FUtf8JsonWriterFactory = TJsonWriterFactory<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>;
+
+// Pool of the UTF-8 byte buffers responses are written into
+// A buffer handed to the HTTP response by move leaves the pool, buffers that are only used as scratch come back with Recycle
+class JsonBuffer
+{
+public:
+	struct FStats
+	{
+		uint64 BytesProduced = 0;
+		uint64 CopiesAvoided = 0; // bodies moved into the response instead of re-encoded from an FString
+		uint64 BuffersReused = 0;
+		uint64 BuffersAllocated = 0;
+	};
+
+	// Returns an empty buffer, reusing a pooled allocation when there is one
+	static TArray<uint8> Acquire();
+
+	// Gives back a buffer that was not handed to a response
+	static void Recycle(TArray<uint8>&& Buffer);
+
+	static void RecordMovedToResponse(int64 Bytes);
+
+	static FStats GetStats();
+
+	// Appends Value as a quoted, escaped JSON string, for stitching separately encoded parts together
+	static void AppendString(TArray<uint8>& Out, const FString& Value);
+
+	static void AppendRaw(TArray<uint8>& Out, const ANSICHAR* Text);
+
+private:
+	static constexpr int32 MaxPooledBuffers = 8;
+	static constexpr int64 MaxPooledBytes = 16 * 1024 * 1024;
+	static constexpr int64 MaxReservedBytes = 4 * 1024 * 1024;
+
+	static FCriticalSection PoolLock;
+	static TArray<TArray<uint8>> Pool;
+
+	// Smoothed response size, new buffers reserve it up front so they don't regrow while writing
+	static std::atomic<int64> SizeHint;
+
+	static std::atomic<uint64> BytesProduced;
+	static std::atomic<uint64> CopiesAvoided;
+	static std::atomic<uint64> BuffersReused;
+	static std::atomic<uint64> BuffersAllocated;
+};
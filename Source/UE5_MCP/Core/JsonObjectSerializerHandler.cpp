@@ -4,7 +4,7 @@
 TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	{
 		FByteProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FByteProperty>(Prop))
 			{
@@ -22,7 +22,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FInt16Property::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FInt16Property>(Prop))
 			{
@@ -33,7 +33,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FIntProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FIntProperty>(Prop))
 			{
@@ -44,7 +44,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FInt64Property::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FInt64Property>(Prop))
 			{
@@ -55,7 +55,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FFloatProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FFloatProperty>(Prop))
 			{
@@ -66,7 +66,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FDoubleProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FDoubleProperty>(Prop))
 			{
@@ -77,7 +77,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FBoolProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FBoolProperty>(Prop))
 			{
@@ -88,7 +88,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FStrProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FStrProperty>(Prop))
 			{
@@ -99,7 +99,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FNameProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FNameProperty>(Prop))
 			{
@@ -110,7 +110,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FTextProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FTextProperty>(Prop))
 			{
@@ -121,7 +121,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FObjectProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const auto PropCasted = CastField<FObjectProperty>(Prop))
 			{
@@ -144,7 +144,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FArrayProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const FArrayProperty* ArrayProp = CastField<FArrayProperty>(Prop))
 			{
@@ -159,7 +159,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FSetProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const FSetProperty* SetProp = CastField<FSetProperty>(Prop))
 			{
@@ -174,7 +174,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FStructProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			if (const FStructProperty* StructProp = CastField<FStructProperty>(Prop))
 			{
@@ -191,7 +191,7 @@ TMap<FFieldClass*, FJsonSerializerFunc> ObjUtils::JsonSerializers = {
 	},
 	{
 		FEnumProperty::StaticClass(),
-		[](FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)
+		[](FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)
 		{
 			const FEnumProperty* EnumProp = CastField<FEnumProperty>(Prop);
 			if (!EnumProp)
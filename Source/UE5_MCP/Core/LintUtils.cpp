@@ -0,0 +1,586 @@
+﻿#include "LintUtils.h"
+#include "MCPTrace.h"
+
+#include "AssetLoadUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "SnapshotUtils.h"
+#include "Algo/Find.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Blueprint.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/Class.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace
+{
+	const ELintRule AllRules[] = {
+		ELintRule::UnconnectedExec, ELintRule::UnusedVariable, ELintRule::UnusedFunction, ELintRule::ImpureCallInLoop,
+		ELintRule::CastAlwaysFails, ELintRule::HeavyTick, ELintRule::OrphanedPin
+	};
+
+	const FString* FindMeta(const FNodeSnapshot& Node, const TCHAR* Key)
+	{
+		for (const TPair<FString, FString>& Meta : Node.Meta)
+		{
+			if (Meta.Key == Key)
+				return &Meta.Value;
+		}
+		return nullptr;
+	}
+
+	// Nodes without exec pins are evaluated by every node reading their outputs
+	bool IsPureNode(const FNodeSnapshot& Node)
+	{
+		if (Node.bIsPure.IsSet())
+			return Node.bIsPure.GetValue();
+		return !Node.Pins.ContainsByPredicate([](const FPinSnapshot& Pin) { return Pin.IsExec(); });
+	}
+
+	// /Script/Engine.Actor -> Actor, /Game/BP_Enemy.BP_Enemy_C -> BP_Enemy
+	FString GetClassName(const FString& ClassPath)
+	{
+		FString Name = ClassPath;
+		int32 Dot;
+		if (Name.FindLastChar(TEXT('.'), Dot))
+			Name.RightChopInline(Dot + 1);
+		Name.RemoveFromEnd(TEXT("_C"));
+		return Name;
+	}
+
+	FLintIssue MakeIssue(ELintRule Rule, const TCHAR* Severity, const FString& Graph, const FString& NodeId,
+	                     FString&& Message)
+	{
+		return { LintUtils::GetRuleName(Rule), Severity, Graph, NodeId, MoveTemp(Message) };
+	}
+}
+
+const TCHAR* LintUtils::GetRuleName(ELintRule Rule)
+{
+	switch (Rule)
+	{
+	case ELintRule::UnconnectedExec: return TEXT("UnconnectedExec");
+	case ELintRule::UnusedVariable: return TEXT("UnusedVariable");
+	case ELintRule::UnusedFunction: return TEXT("UnusedFunction");
+	case ELintRule::ImpureCallInLoop: return TEXT("ImpureCallInLoop");
+	case ELintRule::CastAlwaysFails: return TEXT("CastAlwaysFails");
+	case ELintRule::HeavyTick: return TEXT("HeavyTick");
+	case ELintRule::OrphanedPin: return TEXT("OrphanedPin");
+	default: return TEXT("None");
+	}
+}
+
+ELintRule LintUtils::ParseRules(const TArray<FString>& Names)
+{
+	MCP_TRACE_SCOPE("LintUtils::ParseRules");
+	if (Names.Num() == 0)
+		return ELintRule::All;
+
+	ELintRule Rules = ELintRule::None;
+	for (const FString& Name : Names)
+	{
+		const FString Trimmed = Name.TrimStartAndEnd();
+		const ELintRule* Rule = Algo::FindByPredicate(AllRules,
+			[&Trimmed](ELintRule Candidate) { return Trimmed.Equals(GetRuleName(Candidate), ESearchCase::IgnoreCase); });
+		if (!Rule)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(
+				TEXT("Unknown lint rule %s, expected UnconnectedExec, UnusedVariable, UnusedFunction, ImpureCallInLoop, "
+					"CastAlwaysFails, HeavyTick or OrphanedPin"), *Name)));
+		Rules |= *Rule;
+	}
+	return Rules;
+}
+
+TArray<FBlueprintSnapshotPtr> LintUtils::CaptureSnapshots(const TArray<FString>& Paths, FLintReport& Report)
+{
+	MCP_TRACE_SCOPE("LintUtils::CaptureSnapshots");
+	check(IsInGameThread());
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	TArray<FBlueprintSnapshotPtr> Snapshots;
+	Snapshots.Reserve(Paths.Num());
+	for (int32 BatchStart = 0; BatchStart < Paths.Num(); BatchStart += BatchSize)
+	{
+		const TArray<FString> Batch(Paths.GetData() + BatchStart, FMath::Min(BatchSize, Paths.Num() - BatchStart));
+
+		// Cached snapshots need no load, the rest of the batch loads on the async loading threads at once
+		TArray<FString> Missing = Batch.FilterByPredicate(
+			[](const FString& Path) { return !SnapshotCache::Find(Path).IsValid(); });
+		if (Missing.Num() > 1)
+		{
+			Metrics::FScopedPhase Phase(EMetricPhase::Load);
+			AssetLoadUtils::Prefetch(Missing);
+			FlushAsyncLoading();
+		}
+
+		// Storing a whole folder in the cache would evict the Blueprints the agent is working on
+		for (const FString& Path : Batch)
+		{
+			if (FBlueprintSnapshotPtr Snapshot = SnapshotCache::Find(Path))
+			{
+				Snapshots.Add(MoveTemp(Snapshot));
+				continue;
+			}
+			UBlueprint* Blueprint = Cast<UBlueprint>(AssetLoadUtils::LoadObject(UBlueprint::StaticClass(), Path));
+			if (!Blueprint)
+			{
+				Report.Failed.Add(Path);
+				continue;
+			}
+			Snapshots.Add(MakeShared<const FBlueprintSnapshot, ESPMode::ThreadSafe>(SnapshotUtils::CaptureBlueprint(Blueprint)));
+		}
+	}
+
+	Report.CaptureMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+	return Snapshots;
+}
+
+FLintClassHierarchy LintUtils::CaptureClassHierarchy(const TArray<FBlueprintSnapshotPtr>& Snapshots)
+{
+	MCP_TRACE_SCOPE("LintUtils::CaptureClassHierarchy");
+	check(IsInGameThread());
+	FLintClassHierarchy Hierarchy;
+
+	auto AddClass = [&Hierarchy](const FString& ClassPath)
+	{
+		if (Hierarchy.Supers.Contains(ClassPath))
+			return;
+		const UClass* Class = FindObject<UClass>(nullptr, *ClassPath);
+		if (!Class)
+			return;
+
+		if (Class->HasAnyClassFlags(CLASS_Interface))
+			Hierarchy.Interfaces.Add(ClassPath);
+		// Pins of Blueprint classes may point at the skeleton class, compare the classes that get instanced
+		TArray<FString>& Supers = Hierarchy.Supers.Add(ClassPath);
+		for (const UClass* Super = Class->GetAuthoritativeClass(); Super; Super = Super->GetSuperClass())
+		{
+			Supers.Add(Super->GetAuthoritativeClass()->GetPathName());
+		}
+	};
+
+	for (const FBlueprintSnapshotPtr& Snapshot : Snapshots)
+	{
+		for (const FGraphSnapshot& Graph : Snapshot->Graphs)
+		{
+			FNodeMap Nodes;
+			for (const FNodeSnapshot& Node : Graph.Nodes)
+			{
+				if (Node.Type == TEXT("K2Node_DynamicCast"))
+				{
+					if (Nodes.IsEmpty())
+					{
+						for (const FNodeSnapshot& Other : Graph.Nodes)
+						{
+							Nodes.Add(Other.Id, &Other);
+						}
+					}
+
+					FString Source, Target;
+					if (!FindCastClasses(Node, Nodes, Source, Target))
+						continue;
+					AddClass(Source);
+					AddClass(Target);
+				}
+			}
+		}
+	}
+	return Hierarchy;
+}
+
+void LintUtils::Lint(const TArray<FBlueprintSnapshotPtr>& Snapshots, const FLintClassHierarchy& Hierarchy,
+                     ELintRule Rules, FLintReport& Report)
+{
+	MCP_TRACE_SCOPE("LintUtils::Lint");
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	// Snapshots are immutable, so every Blueprint can be linted on its own worker
+	TArray<FBlueprintLintResult> Results;
+	Results.SetNum(Snapshots.Num());
+	ParallelFor(Snapshots.Num(), [&](int32 Index)
+	{
+		Results[Index] = LintBlueprint(*Snapshots[Index], Hierarchy, Rules);
+	});
+
+	Report.Linted += Snapshots.Num();
+	for (FBlueprintLintResult& Result : Results)
+	{
+		if (Result.Issues.IsEmpty())
+			continue;
+		for (const FLintIssue& Issue : Result.Issues)
+		{
+			if (Issue.Severity == TEXT("Warning"))
+				++Report.Warnings;
+			else
+				++Report.Infos;
+		}
+		Report.Blueprints.Add(MoveTemp(Result));
+	}
+	Report.LintMs += (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+}
+
+FBlueprintLintResult LintUtils::LintBlueprint(const FBlueprintSnapshot& Snapshot, const FLintClassHierarchy& Hierarchy,
+                                              ELintRule Rules)
+{
+	MCP_TRACE_SCOPE("LintUtils::LintBlueprint");
+	FBlueprintLintResult Result;
+	Result.Path = Snapshot.Path;
+
+	if (EnumHasAnyFlags(Rules, ELintRule::UnusedVariable | ELintRule::UnusedFunction))
+		LintUnusedMembers(Snapshot, Rules, Result.Issues);
+
+	for (const FGraphSnapshot& Graph : Snapshot.Graphs)
+	{
+		FNodeMap Nodes;
+		Nodes.Reserve(Graph.Nodes.Num());
+		for (const FNodeSnapshot& Node : Graph.Nodes)
+		{
+			Nodes.Add(Node.Id, &Node);
+		}
+
+		if (EnumHasAnyFlags(Rules, ELintRule::UnconnectedExec))
+			LintUnconnectedExec(Graph, Result.Issues);
+		if (EnumHasAnyFlags(Rules, ELintRule::ImpureCallInLoop))
+			LintLoops(Graph, Nodes, Result.Issues);
+		if (EnumHasAnyFlags(Rules, ELintRule::CastAlwaysFails))
+			LintCasts(Graph, Nodes, Hierarchy, Result.Issues);
+		if (EnumHasAnyFlags(Rules, ELintRule::HeavyTick))
+			LintTick(Graph, Nodes, Result.Issues);
+		if (EnumHasAnyFlags(Rules, ELintRule::OrphanedPin))
+			LintOrphanedPins(Graph, Result.Issues);
+	}
+	return Result;
+}
+
+void LintUtils::LintUnconnectedExec(const FGraphSnapshot& Graph, TArray<FLintIssue>& OutIssues)
+{
+	// Macro graphs start from tunnel nodes and are checked where they are instanced
+	if (Graph.Kind == TEXT("Macro"))
+		return;
+
+	for (const FNodeSnapshot& Node : Graph.Nodes)
+	{
+		if (!Node.bEnabled)
+			continue;
+
+		bool bHasExecIn = false, bExecInLinked = false, bHasExecOut = false, bExecOutLinked = false;
+		for (const FPinSnapshot& Pin : Node.Pins)
+		{
+			if (!Pin.IsExec())
+				continue;
+			bool& bHas = Pin.IsInput() ? bHasExecIn : bHasExecOut;
+			bool& bLinked = Pin.IsInput() ? bExecInLinked : bExecOutLinked;
+			bHas = true;
+			bLinked |= Pin.Links.Num() > 0;
+		}
+
+		// Only the first node of a dead chain is reported, the ones after it are linked
+		if (bHasExecIn && !bExecInLinked)
+		{
+			OutIssues.Add(MakeIssue(ELintRule::UnconnectedExec, TEXT("Warning"), Graph.Name, Node.Id,
+				FString::Printf(TEXT("Nothing executes %s, it and the nodes after it never run"), *GetDisplayName(Node))));
+			continue;
+		}
+
+		const FString* EventName = FindMeta(Node, TEXT("EventName"));
+		if (!EventName || !bHasExecOut || bExecOutLinked)
+			continue;
+		if (*EventName == TEXT("ReceiveTick") || *EventName == TEXT("Tick"))
+			OutIssues.Add(MakeIssue(ELintRule::UnconnectedExec, TEXT("Warning"), Graph.Name, Node.Id,
+				FString::Printf(TEXT("Event %s runs nothing but still makes the object tick every frame, delete it"), **EventName)));
+		else
+			OutIssues.Add(MakeIssue(ELintRule::UnconnectedExec, TEXT("Info"), Graph.Name, Node.Id,
+				FString::Printf(TEXT("Event %s runs nothing"), **EventName)));
+	}
+}
+
+void LintUtils::LintUnusedMembers(const FBlueprintSnapshot& Snapshot, ELintRule Rules, TArray<FLintIssue>& OutIssues)
+{
+	TSet<FString> UsedVariables;
+	TSet<FString> CalledFunctions;
+	for (const FGraphSnapshot& Graph : Snapshot.Graphs)
+	{
+		for (const FNodeSnapshot& Node : Graph.Nodes)
+		{
+			if (const FString* VarName = FindMeta(Node, TEXT("VarName")))
+				UsedVariables.Add(*VarName);
+			else if (const FString* FuncName = FindMeta(Node, TEXT("FuncName")))
+				CalledFunctions.Add(*FuncName);
+		}
+	}
+
+	// Other Blueprints and instance defaults may still use them, so these are only hints
+	if (EnumHasAnyFlags(Rules, ELintRule::UnusedVariable))
+	{
+		for (const FString& Variable : Snapshot.Variables)
+		{
+			// "Type Name", types never contain spaces but variable names may
+			FString Type, Name;
+			if (!Variable.Split(TEXT(" "), &Type, &Name, ESearchCase::CaseSensitive, ESearchDir::FromStart))
+				continue;
+			// Event dispatchers are bound and called through delegate nodes, which carry no variable name
+			if (Type.StartsWith(TEXT("mcdelegate")) || UsedVariables.Contains(Name))
+				continue;
+			OutIssues.Add(MakeIssue(ELintRule::UnusedVariable, TEXT("Info"), FString(), FString(),
+				FString::Printf(TEXT("Variable %s is never read or written in this Blueprint"), *Name)));
+		}
+	}
+
+	if (EnumHasAnyFlags(Rules, ELintRule::UnusedFunction))
+	{
+		for (const FGraphSnapshot& Graph : Snapshot.Graphs)
+		{
+			// Overrides, the construction script included, are called by the parent class
+			if (Graph.Kind != TEXT("Function") || Graph.bOverride || CalledFunctions.Contains(Graph.Name))
+				continue;
+			OutIssues.Add(MakeIssue(ELintRule::UnusedFunction, TEXT("Info"), Graph.Name, FString(),
+				FString::Printf(TEXT("Function %s is never called in this Blueprint"), *Graph.Name)));
+		}
+	}
+}
+
+void LintUtils::LintLoops(const FGraphSnapshot& Graph, const FNodeMap& Nodes, TArray<FLintIssue>& OutIssues)
+{
+	static const TArray<FString> LoopBodyPins = { TEXT("LoopBody") };
+	TSet<const FNodeSnapshot*> Reported;
+
+	for (const FNodeSnapshot& Node : Graph.Nodes)
+	{
+		// ForLoop, ForEachLoop, WhileLoop and their variants all run their body from a LoopBody pin
+		const bool bIsLoop = Node.bEnabled && Node.Pins.ContainsByPredicate([](const FPinSnapshot& Pin)
+		{
+			return Pin.IsExec() && !Pin.IsInput() && Pin.Name == TEXT("LoopBody");
+		});
+		if (!bIsLoop)
+			continue;
+
+		for (const FNodeSnapshot* Executed : CollectExecuted(Node, LoopBodyPins, Nodes))
+		{
+			if (!IsExpensive(*Executed) || Reported.Contains(Executed))
+				continue;
+			Reported.Add(Executed);
+			OutIssues.Add(MakeIssue(ELintRule::ImpureCallInLoop, TEXT("Warning"), Graph.Name, Executed->Id,
+				FString::Printf(TEXT("%s runs on every iteration of loop %s, move it before the loop"),
+					*GetDisplayName(*Executed), *Node.Id)));
+		}
+	}
+}
+
+void LintUtils::LintCasts(const FGraphSnapshot& Graph, const FNodeMap& Nodes, const FLintClassHierarchy& Hierarchy,
+                          TArray<FLintIssue>& OutIssues)
+{
+	for (const FNodeSnapshot& Node : Graph.Nodes)
+	{
+		if (!Node.bEnabled || Node.Type != TEXT("K2Node_DynamicCast"))
+			continue;
+
+		FString Source, Target;
+		if (!FindCastClasses(Node, Nodes, Source, Target))
+			continue;
+
+		// Any class may implement an interface, and classes missing from the hierarchy couldn't be resolved
+		const TArray<FString>* SourceSupers = Hierarchy.Supers.Find(Source);
+		const TArray<FString>* TargetSupers = Hierarchy.Supers.Find(Target);
+		if (!SourceSupers || !TargetSupers || Hierarchy.Interfaces.Contains(Source) || Hierarchy.Interfaces.Contains(Target))
+			continue;
+
+		// Up casts and down casts may succeed, a cast between two branches of the hierarchy never does
+		if (TargetSupers->Contains((*SourceSupers)[0]) || SourceSupers->Contains((*TargetSupers)[0]))
+			continue;
+		OutIssues.Add(MakeIssue(ELintRule::CastAlwaysFails, TEXT("Warning"), Graph.Name, Node.Id,
+			FString::Printf(TEXT("Cast to %s always fails, a %s is never a %s"),
+				*GetClassName(Target), *GetClassName(Source), *GetClassName(Target))));
+	}
+}
+
+void LintUtils::LintTick(const FGraphSnapshot& Graph, const FNodeMap& Nodes, TArray<FLintIssue>& OutIssues)
+{
+	static const TArray<FString> ThenPins = { TEXT("then") };
+	for (const FNodeSnapshot& Node : Graph.Nodes)
+	{
+		const FString* EventName = FindMeta(Node, TEXT("EventName"));
+		if (!Node.bEnabled || !EventName || (*EventName != TEXT("ReceiveTick") && *EventName != TEXT("Tick")))
+			continue;
+
+		for (const FNodeSnapshot* Executed : CollectExecuted(Node, ThenPins, Nodes))
+		{
+			if (!IsExpensive(*Executed))
+				continue;
+			OutIssues.Add(MakeIssue(ELintRule::HeavyTick, TEXT("Warning"), Graph.Name, Executed->Id,
+				FString::Printf(TEXT("%s runs every frame from Event %s, cache its result or use a timer"),
+					*GetDisplayName(*Executed), **EventName)));
+		}
+	}
+}
+
+void LintUtils::LintOrphanedPins(const FGraphSnapshot& Graph, TArray<FLintIssue>& OutIssues)
+{
+	for (const FNodeSnapshot& Node : Graph.Nodes)
+	{
+		for (const FPinSnapshot& Pin : Node.Pins)
+		{
+			if (!Pin.bOrphaned)
+				continue;
+			OutIssues.Add(MakeIssue(ELintRule::OrphanedPin, TEXT("Warning"), Graph.Name, Node.Id,
+				FString::Printf(TEXT("Pin %s of %s no longer exists and is only kept for its links or value, "
+					"reconnect them and remove it"), *Pin.Name, *GetDisplayName(Node))));
+		}
+	}
+}
+
+TArray<const FNodeSnapshot*> LintUtils::CollectExecuted(const FNodeSnapshot& From, const TArray<FString>& PinNames,
+                                                        const FNodeMap& Nodes)
+{
+	TArray<const FNodeSnapshot*> Executed;
+	TSet<const FNodeSnapshot*> Visited = { &From };
+	TArray<const FNodeSnapshot*> Stack;
+
+	auto FollowExec = [&](const FNodeSnapshot& Node, bool bOnlyPinNames)
+	{
+		for (const FPinSnapshot& Pin : Node.Pins)
+		{
+			if (!Pin.IsExec() || Pin.IsInput() || (bOnlyPinNames && !PinNames.Contains(Pin.Name)))
+				continue;
+			for (const FPinLinkSnapshot& Link : Pin.Links)
+			{
+				const FNodeSnapshot* Next = Nodes.FindRef(Link.NodeId);
+				if (Next && Next->bEnabled && !Visited.Contains(Next))
+				{
+					Visited.Add(Next);
+					Stack.Push(Next);
+				}
+			}
+		}
+	};
+
+	FollowExec(From, true);
+	while (Stack.Num() > 0)
+	{
+		const FNodeSnapshot* Node = Stack.Pop();
+		Executed.Add(Node);
+		FollowExec(*Node, false);
+	}
+
+	TArray<const FNodeSnapshot*> Readers = Executed;
+	Readers.Add(&From);
+	for (int32 Index = 0; Index < Readers.Num(); ++Index)
+	{
+		for (const FPinSnapshot& Pin : Readers[Index]->Pins)
+		{
+			if (Pin.IsExec() || !Pin.IsInput())
+				continue;
+			for (const FPinLinkSnapshot& Link : Pin.Links)
+			{
+				const FNodeSnapshot* Input = Nodes.FindRef(Link.NodeId);
+				if (Input && IsPureNode(*Input) && !Visited.Contains(Input))
+				{
+					Visited.Add(Input);
+					Executed.Add(Input);
+					Readers.Add(Input);
+				}
+			}
+		}
+	}
+	return Executed;
+}
+
+bool LintUtils::FindCastClasses(const FNodeSnapshot& Node, const FNodeMap& Nodes, FString& OutSource, FString& OutTarget)
+{
+	OutSource.Reset();
+	OutTarget.Reset();
+	for (const FPinSnapshot& Pin : Node.Pins)
+	{
+		if (Pin.IsInput() && Pin.Name == TEXT("Object") && Pin.Links.Num() > 0)
+		{
+			const FNodeSnapshot* SourceNode = Nodes.FindRef(Pin.Links[0].NodeId);
+			const FPinSnapshot* SourcePin = SourceNode ? SourceNode->Pins.FindByPredicate(
+				[&Pin](const FPinSnapshot& Candidate) { return Candidate.Name == Pin.Links[0].PinName; }) : nullptr;
+			if (SourcePin)
+				OutSource = SourcePin->TypeObject;
+		}
+		// The As<Class> output, interface casts write to an interface pin and are left alone
+		else if (!Pin.IsInput() && Pin.Info.StartsWith(TEXT("object-")))
+			OutTarget = Pin.TypeObject;
+	}
+	return !OutSource.IsEmpty() && !OutTarget.IsEmpty();
+}
+
+bool LintUtils::IsExpensive(const FNodeSnapshot& Node)
+{
+	// Calls that walk every actor or component, allocate, load or trace for many hits
+	static const TSet<FString> ExpensiveFunctions = {
+		TEXT("GetAllActorsOfClass"), TEXT("GetAllActorsOfClassWithTag"), TEXT("GetAllActorsWithTag"),
+		TEXT("GetAllActorsWithInterface"), TEXT("GetAllWidgetsOfClass"), TEXT("GetAllWidgetsWithInterface"),
+		TEXT("K2_GetComponentsByClass"), TEXT("GetComponentsByTag"), TEXT("GetComponentsByInterface"),
+		TEXT("BeginDeferredActorSpawnFromClass"), TEXT("FinishSpawningActor"),
+		TEXT("SpawnEmitterAtLocation"), TEXT("SpawnEmitterAttached"), TEXT("SpawnSystemAtLocation"), TEXT("SpawnSystemAttached"),
+		TEXT("LineTraceMulti"), TEXT("LineTraceMultiForObjects"), TEXT("SphereTraceMulti"), TEXT("SphereTraceMultiForObjects"),
+		TEXT("BoxTraceMulti"), TEXT("CapsuleTraceMulti"), TEXT("SphereOverlapActors"), TEXT("SphereOverlapComponents"),
+		TEXT("BoxOverlapActors"), TEXT("BoxOverlapComponents"), TEXT("CapsuleOverlapActors"),
+		TEXT("LoadAsset_Blocking"), TEXT("LoadClassAsset_Blocking"), TEXT("ExecuteConsoleCommand")
+	};
+	static const TSet<FString> ExpensiveNodes = {
+		TEXT("K2Node_SpawnActorFromClass"), TEXT("K2Node_CreateWidget"), TEXT("K2Node_ConstructObjectFromClass"),
+		TEXT("K2Node_AddComponentByClass")
+	};
+
+	if (ExpensiveNodes.Contains(Node.Type))
+		return true;
+	const FString* FuncName = FindMeta(Node, TEXT("FuncName"));
+	return FuncName && ExpensiveFunctions.Contains(*FuncName);
+}
+
+FString LintUtils::GetDisplayName(const FNodeSnapshot& Node)
+{
+	if (const FString* FuncName = FindMeta(Node, TEXT("FuncName")))
+		return *FuncName;
+	FString Name = Node.Type;
+	Name.RemoveFromStart(TEXT("K2Node_"));
+	return Name;
+}
+
+TArray<uint8> LintUtils::EncodeReport(const FLintReport& Report)
+{
+	MCP_TRACE_SCOPE("LintUtils::EncodeReport");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Linted"), Report.Linted);
+	Writer->WriteValue(TEXT("Warnings"), Report.Warnings);
+	Writer->WriteValue(TEXT("Infos"), Report.Infos);
+	Writer->WriteArrayStart(TEXT("Failed"));
+	for (const FString& Path : Report.Failed)
+	{
+		Writer->WriteValue(Path);
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectStart(TEXT("Timing"));
+	Writer->WriteValue(TEXT("CaptureMs"), Report.CaptureMs);
+	Writer->WriteValue(TEXT("LintMs"), Report.LintMs);
+	Writer->WriteObjectEnd();
+	Writer->WriteArrayStart(TEXT("Blueprints"));
+	for (const FBlueprintLintResult& Result : Report.Blueprints)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Path"), Result.Path);
+		Writer->WriteArrayStart(TEXT("Issues"));
+		for (const FLintIssue& Issue : Result.Issues)
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("Rule"), Issue.Rule);
+			Writer->WriteValue(TEXT("Severity"), Issue.Severity);
+			Writer->WriteValue(TEXT("Graph"), Issue.Graph);
+			Writer->WriteValue(TEXT("NodeId"), Issue.NodeId);
+			Writer->WriteValue(TEXT("Message"), Issue.Message);
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
@@ -0,0 +1,102 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "SnapshotCache.h"
+#include <stdexcept>
+
+enum class ELintRule : uint8
+{
+	None = 0,
+	UnconnectedExec = 1 << 0, // nodes nothing executes, events that run nothing
+	UnusedVariable = 1 << 1,
+	UnusedFunction = 1 << 2,
+	ImpureCallInLoop = 1 << 3, // expensive calls made on every iteration of a loop
+	CastAlwaysFails = 1 << 4, // cast between unrelated classes
+	HeavyTick = 1 << 5, // expensive calls made every frame
+	OrphanedPin = 1 << 6,
+	All = UnconnectedExec | UnusedVariable | UnusedFunction | ImpureCallInLoop | CastAlwaysFails | HeavyTick | OrphanedPin
+};
+ENUM_CLASS_FLAGS(ELintRule);
+
+struct FLintIssue
+{
+	FString Rule;
+	FString Severity; // Warning or Info
+	FString Graph;
+	FString NodeId; // empty for issues about a variable or function
+	FString Message;
+};
+
+struct FBlueprintLintResult
+{
+	FString Path;
+	TArray<FLintIssue> Issues;
+};
+
+// Class relations the cast rule needs, resolved on the game thread so the rules never touch a UClass
+struct FLintClassHierarchy
+{
+	TMap<FString, TArray<FString>> Supers; // class path to itself and every super class, authoritative classes only
+	TSet<FString> Interfaces;
+};
+
+struct FLintReport
+{
+	TArray<FBlueprintLintResult> Blueprints;
+	TArray<FString> Failed; // paths that couldn't be loaded
+	int32 Linted = 0;
+	int32 Warnings = 0;
+	int32 Infos = 0;
+	double CaptureMs = 0.0;
+	double LintMs = 0.0;
+};
+
+// Static checks over Blueprint snapshots
+// Only the snapshots and the class hierarchy are captured on the game thread, the rules run on task graph workers
+class LintUtils
+{
+public:
+	// Parses rule names ('UnusedVariable,HeavyTick'), empty means all rules
+	static ELintRule ParseRules(const TArray<FString>& Names);
+
+	// Loads the Blueprints asynchronously in batches and snapshots them. Game thread only
+	// Cached snapshots are reused, the others are captured without entering the cache
+	static TArray<FBlueprintSnapshotPtr> CaptureSnapshots(const TArray<FString>& Paths, FLintReport& Report);
+
+	// Resolves the classes the snapshots' cast nodes convert between. Game thread only
+	static FLintClassHierarchy CaptureClassHierarchy(const TArray<FBlueprintSnapshotPtr>& Snapshots);
+
+	// Lints every snapshot in parallel, safe on any thread. Blueprints without issues are left out of the report
+	static void Lint(const TArray<FBlueprintSnapshotPtr>& Snapshots, const FLintClassHierarchy& Hierarchy,
+	                 ELintRule Rules, FLintReport& Report);
+
+	static FBlueprintLintResult LintBlueprint(const FBlueprintSnapshot& Snapshot, const FLintClassHierarchy& Hierarchy,
+	                                          ELintRule Rules);
+
+	static TArray<uint8> EncodeReport(const FLintReport& Report);
+
+	static const TCHAR* GetRuleName(ELintRule Rule);
+
+private:
+	using FNodeMap = TMap<FString, const FNodeSnapshot*>;
+
+	static void LintUnconnectedExec(const FGraphSnapshot& Graph, TArray<FLintIssue>& OutIssues);
+	static void LintUnusedMembers(const FBlueprintSnapshot& Snapshot, ELintRule Rules, TArray<FLintIssue>& OutIssues);
+	static void LintLoops(const FGraphSnapshot& Graph, const FNodeMap& Nodes, TArray<FLintIssue>& OutIssues);
+	static void LintCasts(const FGraphSnapshot& Graph, const FNodeMap& Nodes, const FLintClassHierarchy& Hierarchy,
+	                      TArray<FLintIssue>& OutIssues);
+	static void LintTick(const FGraphSnapshot& Graph, const FNodeMap& Nodes, TArray<FLintIssue>& OutIssues);
+	static void LintOrphanedPins(const FGraphSnapshot& Graph, TArray<FLintIssue>& OutIssues);
+
+	// Nodes run by following exec links out of the given pins, plus the pure nodes feeding From and those nodes,
+	// which are evaluated again every time they run
+	static TArray<const FNodeSnapshot*> CollectExecuted(const FNodeSnapshot& From, const TArray<FString>& PinNames,
+	                                                    const FNodeMap& Nodes);
+
+	// Class paths a K2Node_DynamicCast converts from and to, false when its input isn't linked to a typed pin
+	static bool FindCastClasses(const FNodeSnapshot& Node, const FNodeMap& Nodes, FString& OutSource, FString& OutTarget);
+
+	static bool IsExpensive(const FNodeSnapshot& Node);
+	static FString GetDisplayName(const FNodeSnapshot& Node);
+
+	static constexpr int32 BatchSize = 64;
+};
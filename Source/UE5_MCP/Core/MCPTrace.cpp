@@ -0,0 +1,7 @@
+﻿#include "MCPTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(UE5_MCPChannel)
+
+TRACE_DECLARE_INT_COUNTER(UE5_MCP_NodesCreated, TEXT("UE5_MCP/NodesCreated"));
+TRACE_DECLARE_INT_COUNTER(UE5_MCP_PinsLinked, TEXT("UE5_MCP/PinsLinked"));
+TRACE_DECLARE_INT_COUNTER(UE5_MCP_CompilesTriggered, TEXT("UE5_MCP/CompilesTriggered"));
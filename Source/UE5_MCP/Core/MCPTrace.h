@@ -0,0 +1,16 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Trace/Trace.h"
+
+// Unreal Insights channel of the plugin, enable it with -trace=cpu,UE5_MCP or "Trace.Enable UE5_MCP"
+UE_TRACE_CHANNEL_EXTERN(UE5_MCPChannel)
+
+// Named CPU scope on the plugin channel, Name must be a string literal
+#define MCP_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, UE5_MCPChannel)
+
+TRACE_DECLARE_INT_COUNTER_EXTERN(UE5_MCP_NodesCreated);
+TRACE_DECLARE_INT_COUNTER_EXTERN(UE5_MCP_PinsLinked);
+TRACE_DECLARE_INT_COUNTER_EXTERN(UE5_MCP_CompilesTriggered);
@@ -0,0 +1,330 @@
+﻿#include "Metrics.h"
+
+#include "JsonBuffer.h"
+#include "SnapshotCache.h"
+#include <atomic>
+
+#include "Serialization/JsonWriter.h"
+
+const double Metrics::FHistogram::BucketBounds[NumBounds] = {
+	0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+FCriticalSection Metrics::StatsLock;
+TMap<FString, Metrics::FRouteStats> Metrics::RouteStats;
+double Metrics::StartupSeconds = FPlatformTime::Seconds();
+thread_local Metrics::FRequest* Metrics::CurrentRequest = nullptr;
+
+void Metrics::FHistogram::Observe(double Seconds)
+{
+	int32 Bucket = 0;
+	while (Bucket < NumBounds && Seconds > BucketBounds[Bucket])
+		++Bucket;
+	++BucketCounts[Bucket];
+	++Count;
+	Sum += Seconds;
+}
+
+double Metrics::FHistogram::Quantile(double Q) const
+{
+	if (Count == 0)
+		return 0.0;
+
+	const double Rank = Q * Count;
+	uint64 Cumulative = 0;
+	for (int32 Bucket = 0; Bucket <= NumBounds; ++Bucket)
+	{
+		const uint64 InBucket = BucketCounts[Bucket];
+		if (InBucket > 0 && Cumulative + InBucket >= Rank)
+		{
+			// Values above the last bound can't be interpolated, report the last bound
+			if (Bucket == NumBounds)
+				return BucketBounds[NumBounds - 1];
+			const double Lower = Bucket == 0 ? 0.0 : BucketBounds[Bucket - 1];
+			const double Upper = BucketBounds[Bucket];
+			return Lower + (Upper - Lower) * ((Rank - Cumulative) / InBucket);
+		}
+		Cumulative += InBucket;
+	}
+	return BucketBounds[NumBounds - 1];
+}
+
+Metrics::FScopedCurrentRequest::FScopedCurrentRequest(const TSharedRef<FRequest>& InRequest)
+	: Request(InRequest)
+	, Previous(CurrentRequest)
+{
+	Request->ActiveSince = FPlatformTime::Seconds();
+	CurrentRequest = &Request.Get();
+}
+
+Metrics::FScopedCurrentRequest::~FScopedCurrentRequest()
+{
+	if (Request->ActiveSince > 0.0)
+		Request->ActiveSeconds += FPlatformTime::Seconds() - Request->ActiveSince;
+	Request->ActiveSince = 0.0;
+	CurrentRequest = Previous;
+}
+
+Metrics::FScopedPhase::FScopedPhase(EMetricPhase InPhase)
+	: Phase(InPhase)
+	, StartSeconds(FPlatformTime::Seconds())
+	, bOwnsPhase(false)
+{
+	if (CurrentRequest && CurrentRequest->ActivePhase == EMetricPhase::Num)
+	{
+		CurrentRequest->ActivePhase = Phase;
+		bOwnsPhase = true;
+	}
+}
+
+Metrics::FScopedPhase::~FScopedPhase()
+{
+	if (!bOwnsPhase || !CurrentRequest)
+		return;
+	CurrentRequest->PhaseSeconds[static_cast<int32>(Phase)] += FPlatformTime::Seconds() - StartSeconds;
+	CurrentRequest->ActivePhase = EMetricPhase::Num;
+}
+
+TSharedRef<Metrics::FRequest> Metrics::BeginRequest(const FString& Route, const FString& Id)
+{
+	static std::atomic<uint64> NextRequestId{1};
+
+	TSharedRef<FRequest> Request = MakeShared<FRequest>();
+	Request->Route = Route;
+	Request->Id = Id.IsEmpty() ? FString::Printf(TEXT("mcp-%llu"), NextRequestId++) : Id;
+	Request->StartSeconds = FPlatformTime::Seconds();
+	return Request;
+}
+
+void Metrics::AddPhaseTime(const TSharedRef<FRequest>& Request, EMetricPhase Phase, double Seconds)
+{
+	Request->PhaseSeconds[static_cast<int32>(Phase)] += Seconds;
+}
+
+TSharedPtr<Metrics::FRequest> Metrics::GetCurrentRequest()
+{
+	return CurrentRequest ? CurrentRequest->AsShared().ToSharedPtr() : nullptr;
+}
+
+void Metrics::EndRequest(const TSharedRef<FRequest>& Request, int32 ResponseCode)
+{
+	if (Request->bCompleted)
+		return;
+	Request->bCompleted = true;
+
+	const double NowSeconds = FPlatformTime::Seconds();
+	const double TotalSeconds = NowSeconds - Request->StartSeconds;
+
+	// Responses are usually handed back from inside the handler, while the request is still current
+	double ActiveSeconds = Request->ActiveSeconds;
+	if (Request->ActiveSince > 0.0)
+		ActiveSeconds += NowSeconds - Request->ActiveSince;
+
+	// Mutation is the handler time left after the explicitly scoped phases
+	double Attributed = 0.0;
+	for (int32 Phase = 0; Phase < static_cast<int32>(EMetricPhase::Num); ++Phase)
+	{
+		if (Phase != static_cast<int32>(EMetricPhase::Mutation) && Phase != static_cast<int32>(EMetricPhase::Compress)
+			&& Phase != static_cast<int32>(EMetricPhase::Queue))
+			Attributed += Request->PhaseSeconds[Phase];
+	}
+	Request->PhaseSeconds[static_cast<int32>(EMetricPhase::Mutation)] = FMath::Max(0.0, ActiveSeconds - Attributed);
+
+	FScopeLock Lock(&StatsLock);
+	FRouteStats& Stats = RouteStats.FindOrAdd(Request->Route);
+	++Stats.ResponsesByCode.FindOrAdd(ResponseCode);
+	if (ResponseCode >= 400)
+		++Stats.Errors;
+	Stats.Latency.Observe(TotalSeconds);
+	for (int32 Phase = 0; Phase < static_cast<int32>(EMetricPhase::Num); ++Phase)
+	{
+		Stats.Phases[Phase].Observe(Request->PhaseSeconds[Phase]);
+	}
+}
+
+const TCHAR* Metrics::GetPhaseName(EMetricPhase Phase)
+{
+	switch (Phase)
+	{
+	case EMetricPhase::Parse:
+		return TEXT("parse");
+	case EMetricPhase::Load:
+		return TEXT("load");
+	case EMetricPhase::Mutation:
+		return TEXT("mutation");
+	case EMetricPhase::Compile:
+		return TEXT("compile");
+	case EMetricPhase::Serialize:
+		return TEXT("serialize");
+	case EMetricPhase::Compress:
+		return TEXT("compress");
+	case EMetricPhase::Queue:
+		return TEXT("queue");
+	default:
+		return TEXT("unknown");
+	}
+}
+
+FString Metrics::ToPrometheusText()
+{
+	FScopeLock Lock(&StatsLock);
+	TStringBuilder<4096> Out;
+
+	Out << TEXT("# HELP ue5_mcp_requests_total Requests handled, by route and response code.\n");
+	Out << TEXT("# TYPE ue5_mcp_requests_total counter\n");
+	for (const auto& [Route, Stats] : RouteStats)
+	{
+		for (const auto& [Code, Count] : Stats.ResponsesByCode)
+		{
+			Out.Appendf(TEXT("ue5_mcp_requests_total{route=\"%s\",code=\"%d\"} %llu\n"), *Route, Code, Count);
+		}
+	}
+
+	Out << TEXT("# HELP ue5_mcp_request_errors_total Requests answered with a 4xx or 5xx code.\n");
+	Out << TEXT("# TYPE ue5_mcp_request_errors_total counter\n");
+	for (const auto& [Route, Stats] : RouteStats)
+	{
+		Out.Appendf(TEXT("ue5_mcp_request_errors_total{route=\"%s\"} %llu\n"), *Route, Stats.Errors);
+	}
+
+	auto AppendHistogram = [&Out](const TCHAR* Name, const FString& Labels, const FHistogram& Histogram)
+	{
+		uint64 Cumulative = 0;
+		for (int32 Bucket = 0; Bucket < FHistogram::NumBounds; ++Bucket)
+		{
+			Cumulative += Histogram.BucketCounts[Bucket];
+			Out.Appendf(TEXT("%s_bucket{%s,le=\"%g\"} %llu\n"), Name, *Labels, FHistogram::BucketBounds[Bucket], Cumulative);
+		}
+		Out.Appendf(TEXT("%s_bucket{%s,le=\"+Inf\"} %llu\n"), Name, *Labels, Histogram.Count);
+		Out.Appendf(TEXT("%s_sum{%s} %f\n"), Name, *Labels, Histogram.Sum);
+		Out.Appendf(TEXT("%s_count{%s} %llu\n"), Name, *Labels, Histogram.Count);
+	};
+
+	Out << TEXT("# HELP ue5_mcp_request_duration_seconds Time from routing a request to handing back its response.\n");
+	Out << TEXT("# TYPE ue5_mcp_request_duration_seconds histogram\n");
+	for (const auto& [Route, Stats] : RouteStats)
+	{
+		AppendHistogram(TEXT("ue5_mcp_request_duration_seconds"), FString::Printf(TEXT("route=\"%s\""), *Route), Stats.Latency);
+	}
+
+	Out << TEXT("# HELP ue5_mcp_request_duration_quantile_seconds Latency quantiles estimated from the duration histogram.\n");
+	Out << TEXT("# TYPE ue5_mcp_request_duration_quantile_seconds gauge\n");
+	for (const auto& [Route, Stats] : RouteStats)
+	{
+		for (const double Q : { 0.5, 0.95, 0.99 })
+		{
+			Out.Appendf(TEXT("ue5_mcp_request_duration_quantile_seconds{route=\"%s\",quantile=\"%g\"} %f\n"),
+				*Route, Q, Stats.Latency.Quantile(Q));
+		}
+	}
+
+	Out << TEXT("# HELP ue5_mcp_request_phase_seconds Time spent per request in each phase.\n");
+	Out << TEXT("# TYPE ue5_mcp_request_phase_seconds histogram\n");
+	for (const auto& [Route, Stats] : RouteStats)
+	{
+		for (int32 Phase = 0; Phase < static_cast<int32>(EMetricPhase::Num); ++Phase)
+		{
+			AppendHistogram(TEXT("ue5_mcp_request_phase_seconds"),
+				FString::Printf(TEXT("route=\"%s\",phase=\"%s\""), *Route, GetPhaseName(static_cast<EMetricPhase>(Phase))),
+				Stats.Phases[Phase]);
+		}
+	}
+
+	const JsonBuffer::FStats BufferStats = JsonBuffer::GetStats();
+	Out << TEXT("# HELP ue5_mcp_response_bytes_total UTF-8 JSON bytes moved into responses.\n");
+	Out << TEXT("# TYPE ue5_mcp_response_bytes_total counter\n");
+	Out.Appendf(TEXT("ue5_mcp_response_bytes_total %llu\n"), BufferStats.BytesProduced);
+	Out << TEXT("# HELP ue5_mcp_response_copies_avoided_total Response bodies moved into the response instead of re-encoded from an FString.\n");
+	Out << TEXT("# TYPE ue5_mcp_response_copies_avoided_total counter\n");
+	Out.Appendf(TEXT("ue5_mcp_response_copies_avoided_total %llu\n"), BufferStats.CopiesAvoided);
+	Out << TEXT("# HELP ue5_mcp_response_buffers_total Response buffers acquired, by whether they came from the pool.\n");
+	Out << TEXT("# TYPE ue5_mcp_response_buffers_total counter\n");
+	Out.Appendf(TEXT("ue5_mcp_response_buffers_total{source=\"pool\"} %llu\n"), BufferStats.BuffersReused);
+	Out.Appendf(TEXT("ue5_mcp_response_buffers_total{source=\"new\"} %llu\n"), BufferStats.BuffersAllocated);
+
+	const SnapshotCache::FStats SnapshotStats = SnapshotCache::GetStats();
+	Out << TEXT("# HELP ue5_mcp_snapshot_lookups_total Blueprint snapshot lookups, by whether a current snapshot was cached.\n");
+	Out << TEXT("# TYPE ue5_mcp_snapshot_lookups_total counter\n");
+	Out.Appendf(TEXT("ue5_mcp_snapshot_lookups_total{result=\"hit\"} %llu\n"), SnapshotStats.Hits);
+	Out.Appendf(TEXT("ue5_mcp_snapshot_lookups_total{result=\"miss\"} %llu\n"), SnapshotStats.Misses);
+	Out << TEXT("# HELP ue5_mcp_snapshot_captures_total Blueprint snapshots captured on the game thread.\n");
+	Out << TEXT("# TYPE ue5_mcp_snapshot_captures_total counter\n");
+	Out.Appendf(TEXT("ue5_mcp_snapshot_captures_total %llu\n"), SnapshotStats.Captures);
+	Out.Appendf(TEXT("# TYPE ue5_mcp_snapshot_entries gauge\nue5_mcp_snapshot_entries %d\n"), SnapshotStats.Entries);
+
+	Out.Appendf(TEXT("# TYPE ue5_mcp_uptime_seconds gauge\nue5_mcp_uptime_seconds %f\n"), FPlatformTime::Seconds() - StartupSeconds);
+	return FString(Out.ToView());
+}
+
+FString Metrics::ToJson(TFunctionRef<void(TJsonWriter<>& Writer)> WriteSections)
+{
+	FScopeLock Lock(&StatsLock);
+	const double UptimeSeconds = FPlatformTime::Seconds() - StartupSeconds;
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("UptimeSeconds"), UptimeSeconds);
+	Writer->WriteObjectStart(TEXT("Routes"));
+	for (const auto& [Route, Stats] : RouteStats)
+	{
+		Writer->WriteObjectStart(Route);
+		Writer->WriteValue(TEXT("Requests"), static_cast<int64>(Stats.Latency.Count));
+		Writer->WriteValue(TEXT("Errors"), static_cast<int64>(Stats.Errors));
+		Writer->WriteValue(TEXT("RequestsPerSecond"), UptimeSeconds > 0.0 ? Stats.Latency.Count / UptimeSeconds : 0.0);
+
+		Writer->WriteObjectStart(TEXT("Codes"));
+		for (const auto& [Code, Count] : Stats.ResponsesByCode)
+		{
+			Writer->WriteValue(FString::FromInt(Code), static_cast<int64>(Count));
+		}
+		Writer->WriteObjectEnd();
+
+		Writer->WriteObjectStart(TEXT("LatencyMs"));
+		Writer->WriteValue(TEXT("p50"), Stats.Latency.Quantile(0.5) * 1000.0);
+		Writer->WriteValue(TEXT("p95"), Stats.Latency.Quantile(0.95) * 1000.0);
+		Writer->WriteValue(TEXT("p99"), Stats.Latency.Quantile(0.99) * 1000.0);
+		Writer->WriteValue(TEXT("Mean"), Stats.Latency.Count > 0 ? Stats.Latency.Sum / Stats.Latency.Count * 1000.0 : 0.0);
+		Writer->WriteObjectEnd();
+
+		Writer->WriteObjectStart(TEXT("PhasesMs"));
+		for (int32 Phase = 0; Phase < static_cast<int32>(EMetricPhase::Num); ++Phase)
+		{
+			const FHistogram& Histogram = Stats.Phases[Phase];
+			Writer->WriteObjectStart(GetPhaseName(static_cast<EMetricPhase>(Phase)));
+			Writer->WriteValue(TEXT("p50"), Histogram.Quantile(0.5) * 1000.0);
+			Writer->WriteValue(TEXT("p95"), Histogram.Quantile(0.95) * 1000.0);
+			Writer->WriteValue(TEXT("p99"), Histogram.Quantile(0.99) * 1000.0);
+			Writer->WriteValue(TEXT("Total"), Histogram.Sum * 1000.0);
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteObjectEnd();
+
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteObjectEnd();
+
+	const JsonBuffer::FStats BufferStats = JsonBuffer::GetStats();
+	Writer->WriteObjectStart(TEXT("ResponseBuffers"));
+	Writer->WriteValue(TEXT("BytesProduced"), static_cast<int64>(BufferStats.BytesProduced));
+	Writer->WriteValue(TEXT("CopiesAvoided"), static_cast<int64>(BufferStats.CopiesAvoided));
+	Writer->WriteValue(TEXT("BuffersReused"), static_cast<int64>(BufferStats.BuffersReused));
+	Writer->WriteValue(TEXT("BuffersAllocated"), static_cast<int64>(BufferStats.BuffersAllocated));
+	Writer->WriteObjectEnd();
+
+	const SnapshotCache::FStats SnapshotStats = SnapshotCache::GetStats();
+	Writer->WriteObjectStart(TEXT("Snapshots"));
+	Writer->WriteValue(TEXT("Hits"), static_cast<int64>(SnapshotStats.Hits));
+	Writer->WriteValue(TEXT("Misses"), static_cast<int64>(SnapshotStats.Misses));
+	Writer->WriteValue(TEXT("Captures"), static_cast<int64>(SnapshotStats.Captures));
+	Writer->WriteValue(TEXT("Entries"), SnapshotStats.Entries);
+	Writer->WriteObjectEnd();
+
+	WriteSections(*Writer);
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	return Output;
+}
@@ -0,0 +1,110 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Serialization/JsonWriter.h"
+
+// Parts of a request the latency of a route is split into
+// Mutation is whatever handler time is not attributed to one of the other phases
+// Compress runs on a worker after the handler and is not part of the handler time
+enum class EMetricPhase : uint8
+{
+	Parse,
+	Load,
+	Mutation,
+	Compile,
+	Serialize,
+	Compress,
+	Queue, // waiting for admission by the request scheduler
+	Num
+};
+
+// Per-route request counters and latency histograms, exposed at /metrics
+class Metrics
+{
+public:
+	// Timing state of one request, from the moment it is routed until its response is handed back
+	struct FRequest : TSharedFromThis<FRequest>
+	{
+		FString Route;
+		FString Id; // correlates the request with its trace bookmark and X-Request-Id header
+		double StartSeconds = 0.0;
+		double ActiveSeconds = 0.0;
+		double ActiveSince = 0.0; // non zero while the request is current on some thread
+		double PhaseSeconds[static_cast<int32>(EMetricPhase::Num)] = {};
+		EMetricPhase ActivePhase = EMetricPhase::Num;
+		bool bCompleted = false;
+	};
+
+	// Makes a request current on this thread, so phase scopes opened by Core functions are attributed to it
+	class FScopedCurrentRequest
+	{
+	public:
+		explicit FScopedCurrentRequest(const TSharedRef<FRequest>& Request);
+		~FScopedCurrentRequest();
+
+	private:
+		TSharedRef<FRequest> Request;
+		FRequest* Previous;
+	};
+
+	// Attributes the time spent in the enclosing scope to a phase of the current request
+	// Nested phase scopes are ignored, the outermost phase gets the time
+	class FScopedPhase
+	{
+	public:
+		explicit FScopedPhase(EMetricPhase Phase);
+		~FScopedPhase();
+
+	private:
+		EMetricPhase Phase;
+		double StartSeconds;
+		bool bOwnsPhase;
+	};
+
+	// Adds time spent outside the request thread, like response compression on a worker
+	static void AddPhaseTime(const TSharedRef<FRequest>& Request, EMetricPhase Phase, double Seconds);
+
+	// The request current on this thread, for work that finishes it later on another thread
+	static TSharedPtr<FRequest> GetCurrentRequest();
+
+	// Id is generated when the client did not provide one
+	static TSharedRef<FRequest> BeginRequest(const FString& Route, const FString& Id = FString());
+
+	// Records the request in the route statistics. Only the first call per request is counted
+	static void EndRequest(const TSharedRef<FRequest>& Request, int32 ResponseCode);
+
+	static FString ToPrometheusText();
+	// WriteSections adds top level sections kept outside Core, such as the request scheduler lanes
+	static FString ToJson(TFunctionRef<void(TJsonWriter<>& Writer)> WriteSections = [](TJsonWriter<>&) {});
+
+private:
+	// Latency histogram with fixed bucket bounds in seconds
+	struct FHistogram
+	{
+		static constexpr int32 NumBounds = 13;
+		static const double BucketBounds[NumBounds];
+
+		uint64 BucketCounts[NumBounds + 1] = {}; // last bucket is +Inf
+		uint64 Count = 0;
+		double Sum = 0.0;
+
+		void Observe(double Seconds);
+
+		// Estimates a quantile by interpolating inside the bucket that contains it
+		double Quantile(double Q) const;
+	};
+
+	struct FRouteStats
+	{
+		TMap<int32, uint64> ResponsesByCode;
+		uint64 Errors = 0;
+		FHistogram Latency;
+		FHistogram Phases[static_cast<int32>(EMetricPhase::Num)];
+	};
+
+	static const TCHAR* GetPhaseName(EMetricPhase Phase);
+
+	static FCriticalSection StatsLock;
+	static TMap<FString, FRouteStats> RouteStats;
+	static double StartupSeconds;
+	static thread_local FRequest* CurrentRequest;
+};
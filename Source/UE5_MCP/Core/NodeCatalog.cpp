@@ -0,0 +1,270 @@
+﻿#include "NodeCatalog.h"
+#include "MCPTrace.h"
+
+#include "ChangeEvents.h"
+#include "ClassUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_BreakStruct.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_CastByteToEnum.h"
+#include "K2Node_ClassDynamicCast.h"
+#include "K2Node_DynamicCast.h"
+#include "K2Node_Event.h"
+#include "K2Node_MakeStruct.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphPin.h"
+#include "Engine/Blueprint.h"
+#include "GameFramework/Actor.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/EnumEditorUtils.h"
+#include "Kismet2/StructureEditorUtils.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/UObjectGlobals.h"
+
+TMap<FString, NodeCatalog::FEntry> NodeCatalog::Entries;
+UBlueprint* NodeCatalog::ScratchBlueprint = nullptr;
+FDelegateHandle NodeCatalog::ChangeHandle;
+FDelegateHandle NodeCatalog::ReloadCompleteHandle;
+
+class NodeCatalog::FTypeListener : public FStructureEditorUtils::INotifyOnStructChanged, public FEnumEditorUtils::INotifyOnEnumChanged
+{
+public:
+	virtual void PreChange(const UUserDefinedStruct* Changed, FStructureEditorUtils::EStructureEditorChangeInfo ChangedType) override {}
+	virtual void PostChange(const UUserDefinedStruct* Changed, FStructureEditorUtils::EStructureEditorChangeInfo ChangedType) override
+	{
+		DropSourcePackage(GetSourcePackage(Changed));
+	}
+
+	virtual void PreChange(const UUserDefinedEnum* Changed, FEnumEditorUtils::EEnumEditorChangeInfo ChangedType) override {}
+	virtual void PostChange(const UUserDefinedEnum* Changed, FEnumEditorUtils::EEnumEditorChangeInfo ChangedType) override
+	{
+		DropSourcePackage(GetSourcePackage(Changed));
+	}
+};
+
+TUniquePtr<NodeCatalog::FTypeListener> NodeCatalog::TypeListener;
+
+FString FNodeKey::ToString() const
+{
+	FString Type = NodeType;
+	Type.RemoveFromStart(TEXT("K2Node_"));
+	return FString::Printf(TEXT("%s|%s|%s|%s"), *Type, *ClassName, *MemberName, *TypeName);
+}
+
+void NodeCatalog::Initialize()
+{
+	ChangeHandle = ChangeEvents::OnChange().AddStatic(&NodeCatalog::HandleChange);
+	ReloadCompleteHandle = FCoreUObjectDelegates::ReloadCompleteDelegate.AddStatic(&NodeCatalog::HandleReloadComplete);
+	TypeListener = MakeUnique<FTypeListener>();
+}
+
+void NodeCatalog::Shutdown()
+{
+	ChangeEvents::OnChange().Remove(ChangeHandle);
+	FCoreUObjectDelegates::ReloadCompleteDelegate.Remove(ReloadCompleteHandle);
+	TypeListener.Reset();
+	Entries.Empty();
+	if (ScratchBlueprint)
+	{
+		ScratchBlueprint->RemoveFromRoot();
+		ScratchBlueprint = nullptr;
+	}
+}
+
+FNodeLayoutPtr NodeCatalog::Describe(const FNodeKey& Key)
+{
+	MCP_TRACE_SCOPE("NodeCatalog::Describe");
+	check(IsInGameThread());
+
+	const FString KeyString = Key.ToString();
+	if (const FEntry* Entry = Entries.Find(KeyString))
+		return Entry->Layout;
+
+	UClass* NodeClass = FindNodeClass(Key.NodeType);
+	if (!NodeClass)
+		throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Node type %s not found"), *Key.NodeType)));
+
+	FString SourcePackage;
+	UK2Node* Node = CreateNode(Key, NodeClass, SourcePackage);
+	Node->AllocateDefaultPins();
+
+	TSharedRef<FNodeLayout, ESPMode::ThreadSafe> Layout = MakeShared<FNodeLayout, ESPMode::ThreadSafe>();
+	Layout->NodeType = NodeClass->GetName();
+	if (const UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node))
+		Layout->bIsPure = CallNode->IsNodePure();
+	for (const UEdGraphPin* Pin : Node->Pins)
+	{
+		if (Pin->bHidden)
+			continue;
+		FPinSnapshot& PinLayout = Layout->Pins.AddDefaulted_GetRef();
+		PinLayout.Name = Pin->GetName();
+		PinLayout.Info = SnapshotUtils::DescribePinType(Pin);
+		PinLayout.DefaultValue = Pin->DefaultValue;
+		if (const UObject* TypeObject = Pin->PinType.PinSubCategoryObject.Get())
+			PinLayout.TypeObject = TypeObject->GetPathName();
+	}
+
+	// The node was never added to the graph, nothing else refers to it
+	Node->MarkAsGarbage();
+
+	Entries.Add(KeyString, { Layout, SourcePackage });
+	return Layout;
+}
+
+UEdGraph* NodeCatalog::GetScratchGraph()
+{
+	if (!ScratchBlueprint)
+	{
+		// Never compiled, saved or registered as an asset, it only gives the nodes a Blueprint to look up
+		ScratchBlueprint = NewObject<UBlueprint>(GetTransientPackage(),
+			MakeUniqueObjectName(GetTransientPackage(), UBlueprint::StaticClass(), TEXT("MCP_NodeCatalog")), RF_Transient);
+		ScratchBlueprint->ParentClass = AActor::StaticClass();
+		ScratchBlueprint->BlueprintType = BPTYPE_Normal;
+		ScratchBlueprint->AddToRoot();
+
+		UEdGraph* Graph = FBlueprintEditorUtils::CreateNewGraph(ScratchBlueprint, TEXT("EventGraph"),
+			UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+		ScratchBlueprint->UbergraphPages.Add(Graph);
+	}
+	return ScratchBlueprint->UbergraphPages[0];
+}
+
+UClass* NodeCatalog::FindNodeClass(const FString& NodeType)
+{
+	FString ClassName = NodeType;
+	if (!ClassName.StartsWith(TEXT("K2Node_")))
+		ClassName = TEXT("K2Node_") + ClassName;
+
+	UClass* Class = FindFirstObject<UClass>(*ClassName);
+	if (!Class || !Class->IsChildOf(UK2Node::StaticClass()) || Class->HasAnyClassFlags(CLASS_Abstract))
+		return nullptr;
+	return Class;
+}
+
+UK2Node* NodeCatalog::CreateNode(const FNodeKey& Key, UClass* NodeClass, FString& OutSourcePackage)
+{
+	UEdGraph* Graph = GetScratchGraph();
+	UK2Node* Node = NewObject<UK2Node>(Graph, NodeClass, NAME_None, RF_Transient);
+	Node->CreateNewGuid();
+
+	if (UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node))
+	{
+		UClass* Class = ClassUtils::FindClassByName(Key.ClassName);
+		if (!Class)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Class %s not found"), *Key.ClassName)));
+		UFunction* Function = Class->FindFunctionByName(*Key.MemberName);
+		if (!Function)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Function %s not found in class %s"),
+				*Key.MemberName, *Key.ClassName)));
+		CallNode->SetFromFunction(Function);
+		// The signature belongs to the Blueprint declaring the function, which may be a parent of the class
+		OutSourcePackage = GetSourcePackage(Function->GetOwnerClass());
+	}
+	else if (NodeClass == UK2Node_Event::StaticClass())
+	{
+		UK2Node_Event* EventNode = CastChecked<UK2Node_Event>(Node);
+		UClass* Class = ClassUtils::FindClassByName(Key.ClassName);
+		if (!Class)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Class %s not found"), *Key.ClassName)));
+		UFunction* Function = Class->FindFunctionByName(*Key.MemberName);
+		if (!Function)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Event %s not found in class %s"),
+				*Key.MemberName, *Key.ClassName)));
+		EventNode->EventReference.SetFromField<UFunction>(Function, false);
+		EventNode->bOverrideFunction = true;
+		OutSourcePackage = GetSourcePackage(Function->GetOwnerClass());
+	}
+	else if (NodeClass->IsChildOf(UK2Node_BreakStruct::StaticClass()) || NodeClass->IsChildOf(UK2Node_MakeStruct::StaticClass()))
+	{
+		UScriptStruct* Struct = FindFirstObject<UScriptStruct>(*Key.TypeName);
+		if (!Struct)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Struct %s not found"), *Key.TypeName)));
+		if (UK2Node_BreakStruct* BreakNode = Cast<UK2Node_BreakStruct>(Node))
+			BreakNode->StructType = Struct;
+		else
+			CastChecked<UK2Node_MakeStruct>(Node)->StructType = Struct;
+		OutSourcePackage = GetSourcePackage(Struct);
+	}
+	else if (UK2Node_DynamicCast* CastNode = Cast<UK2Node_DynamicCast>(Node))
+	{
+		// Also covers UK2Node_ClassDynamicCast
+		UClass* Class = ClassUtils::FindClassByName(Key.TypeName);
+		if (!Class)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Class %s not found"), *Key.TypeName)));
+		CastNode->TargetType = Class;
+		OutSourcePackage = GetSourcePackage(Class);
+	}
+	else if (UK2Node_CastByteToEnum* EnumNode = Cast<UK2Node_CastByteToEnum>(Node))
+	{
+		UEnum* Enum = FindFirstObject<UEnum>(*Key.TypeName);
+		if (!Enum)
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Enum %s not found"), *Key.TypeName)));
+		EnumNode->Enum = Enum;
+		OutSourcePackage = GetSourcePackage(Enum);
+	}
+	else
+	{
+		// Generic nodes are set up the way AddNodeByNameToGraph adds them
+		Node->PostPlacedNewNode();
+	}
+	return Node;
+}
+
+FString NodeCatalog::GetSourcePackage(const UObject* Object)
+{
+	const FString PackageName = Object->GetOutermost()->GetName();
+	return PackageName.StartsWith(TEXT("/Script/")) ? FString() : PackageName;
+}
+
+void NodeCatalog::DropSourcePackage(const FString& SourcePackage)
+{
+	if (SourcePackage.IsEmpty())
+		return;
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It.Value().SourcePackage == SourcePackage)
+			It.RemoveCurrent();
+	}
+}
+
+void NodeCatalog::HandleChange(const FChangeEvent& Event)
+{
+	// A compile can change the signature of any of the Blueprint's functions and events
+	if (Event.Type == EChangeEventType::BlueprintCompiled)
+		DropSourcePackage(Event.BlueprintPath);
+}
+
+void NodeCatalog::HandleReloadComplete(EReloadCompleteReason Reason)
+{
+	// Hot reload and live coding replace native functions, structs and node classes
+	Entries.Empty();
+}
+
+TArray<uint8> NodeCatalog::EncodeLayout(const FNodeLayout& Layout)
+{
+	MCP_TRACE_SCOPE("NodeCatalog::EncodeLayout");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Type"), Layout.NodeType);
+	if (Layout.bIsPure.IsSet())
+		Writer->WriteValue(TEXT("IsPure"), Layout.bIsPure.GetValue());
+	// Same pin fields as /get_graph, so the names can be used with connect_pins and set_pin_default_value
+	Writer->WriteArrayStart(TEXT("Pins"));
+	for (const FPinSnapshot& Pin : Layout.Pins)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Name"), Pin.Name);
+		Writer->WriteValue(TEXT("Inf"), Pin.Info);
+		Writer->WriteValue(TEXT("DefaultVal"), Pin.DefaultValue);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "SnapshotUtils.h"
+#include <stdexcept>
+
+class UBlueprint;
+class UEdGraph;
+struct FChangeEvent;
+enum class EReloadCompleteReason;
+
+// What a node is made from, the fields each node type doesn't use are ignored
+struct FNodeKey
+{
+	FString NodeType; // K2Node class, the K2Node_ prefix may be left out, e.g. CallFunction, Event, MakeStruct
+	FString ClassName; // CallFunction and Event: the class declaring the function or the event to override
+	FString MemberName; // CallFunction and Event: the function or event name
+	FString TypeName; // BreakStruct, MakeStruct: struct, DynamicCast, ClassDynamicCast: class, CastByteToEnum: enum
+
+	FString ToString() const;
+};
+
+struct FNodeLayout
+{
+	FString NodeType; // node class name
+	TOptional<bool> bIsPure;
+	TArray<FPinSnapshot> Pins; // name, type and default value, never linked
+};
+
+using FNodeLayoutPtr = TSharedPtr<const FNodeLayout, ESPMode::ThreadSafe>;
+
+// Pin layouts of node types, so a node's pins are known before it is added to a graph
+// A node is created once per key in a transient scratch Blueprint, its default pins read and the layout cached
+// Layouts of a Blueprint's functions are dropped when it compiles, those of a user defined struct or enum when it is
+// edited, every layout when native code is reloaded
+class NodeCatalog
+{
+public:
+	static void Initialize();
+	static void Shutdown();
+
+	// Game thread only
+	static FNodeLayoutPtr Describe(const FNodeKey& Key);
+
+	static TArray<uint8> EncodeLayout(const FNodeLayout& Layout);
+
+private:
+	// Listens to the struct and enum editors, which change user defined types in place
+	class FTypeListener;
+
+	struct FEntry
+	{
+		FNodeLayoutPtr Layout;
+		FString SourcePackage; // package of the Blueprint class, struct or enum the layout came from, empty for native types
+	};
+
+	static UEdGraph* GetScratchGraph();
+	static UClass* FindNodeClass(const FString& NodeType);
+	// Creates the node in the scratch graph and sets it up for the key
+	// OutSourcePackage is the package of the Blueprint class, struct or enum it was set up from
+	static class UK2Node* CreateNode(const FNodeKey& Key, UClass* NodeClass, FString& OutSourcePackage);
+
+	static FString GetSourcePackage(const UObject* Object);
+	static void DropSourcePackage(const FString& SourcePackage);
+	static void HandleChange(const FChangeEvent& Event);
+	static void HandleReloadComplete(EReloadCompleteReason Reason);
+
+	static TMap<FString, FEntry> Entries;
+	static UBlueprint* ScratchBlueprint; // rooted while the module is loaded
+	static FDelegateHandle ChangeHandle;
+	static FDelegateHandle ReloadCompleteHandle;
+	static TUniquePtr<FTypeListener> TypeListener;
+};
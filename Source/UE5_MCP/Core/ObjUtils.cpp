@@ -1,4 +1,7 @@
 ﻿#include "ObjUtils.h"
+#include "MCPTrace.h"
+
+#include "Metrics.h"
 
 TArray<UClass*> ObjUtils::DetailUObjectClassWhitelist = {
 	// TODO: Add whitelisted classes here
@@ -14,7 +17,7 @@ bool ObjUtils::IsInDetailUObjectWhitelist(UClass* Class)
 	return false;
 }
 
-void ObjUtils::SerializeProperty(UObject* obj, TSharedRef<TJsonWriter<>> Writer)
+void ObjUtils::SerializeProperty(UObject* obj, TSharedRef<FUtf8JsonWriter> Writer)
 {
 	if (!obj || !obj->GetClass())
 		return;
@@ -42,7 +45,7 @@ void ObjUtils::SerializeProperty(UObject* obj, TSharedRef<TJsonWriter<>> Writer)
 
 
 void ObjUtils::SerializeProperty(const FStructProperty* StructProp, const void* StructPtr,
-	TSharedRef<TJsonWriter<>> Writer)
+	TSharedRef<FUtf8JsonWriter> Writer)
 {
 	if (!StructProp || !StructPtr || !StructProp->Struct)
 		return;
@@ -71,7 +74,7 @@ void ObjUtils::SerializeProperty(const FStructProperty* StructProp, const void*
 
 
 void ObjUtils::SerializeProperty(const FArrayProperty* ArrayProp, const void* ArrayPtr,
-								 TSharedRef<TJsonWriter<>> Writer)
+								 TSharedRef<FUtf8JsonWriter> Writer)
 {
 	if (!ArrayProp || !ArrayPtr)
 		return;
@@ -97,7 +100,7 @@ void ObjUtils::SerializeProperty(const FArrayProperty* ArrayProp, const void* Ar
 	}
 }
 
-void ObjUtils::SerializeProperty(const FSetProperty* SetProp, const void* SetPtr, TSharedRef<TJsonWriter<>> Writer)
+void ObjUtils::SerializeProperty(const FSetProperty* SetProp, const void* SetPtr, TSharedRef<FUtf8JsonWriter> Writer)
 {
 	if (!SetProp || !SetPtr)
 		return;
@@ -123,18 +126,20 @@ void ObjUtils::SerializeProperty(const FSetProperty* SetProp, const void* SetPtr
 	}
 }
 
-FString ObjUtils::SerializeObjectToJson(UObject* obj)
+TArray<uint8> ObjUtils::SerializeObjectToJson(UObject* obj)
 {
-	if (!obj)
-		return FString(TEXT("{}"));
-	FString ResultString;
-	TSharedRef<TJsonWriter<>> Writer =
-		TJsonWriterFactory<>::Create(&ResultString);
+	MCP_TRACE_SCOPE("ObjUtils::SerializeObjectToJson");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Result = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Result);
+	TSharedRef<FUtf8JsonWriter> Writer =
+		FUtf8JsonWriterFactory::Create(&Archive);
 	Writer->WriteObjectStart();
-	SerializeProperty(obj, Writer);
+	if (obj)
+		SerializeProperty(obj, Writer);
 	Writer->WriteObjectEnd();
 	Writer->Close();
-	return ResultString;
+	return Result;
 }
 
 void ObjUtils::SetPropertyByPath(UObject* Obj,
@@ -242,6 +247,7 @@ void ObjUtils::SetPropertyByPath(FArrayProperty* ArrayProp, void* ArrayPtr, cons
 
 void ObjUtils::SetPropertyValueFromString(UObject* obj, const FString& PropertyPath, const FString& PropertyValue)
 {
+	MCP_TRACE_SCOPE("ObjUtils::SetPropertyValueFromString");
 	if (!obj || !obj->GetClass())
 		return;
 
@@ -1,8 +1,9 @@
 ﻿#pragma once
 #include <stdexcept>
+#include "JsonBuffer.h"
 
-using FJsonSerializerFunc = TFunction<void(FProperty* Prop, const void* Obj, TSharedRef<TJsonWriter<>> Writer, const FString& Name)>;
-using FJsonArraySerializerFunc = TFunction<void(FProperty* InnerProp, const void* ElementPtr, TSharedRef<TJsonWriter<>> Writer)>;
+using FJsonSerializerFunc = TFunction<void(FProperty* Prop, const void* Obj, TSharedRef<FUtf8JsonWriter> Writer, const FString& Name)>;
+using FJsonArraySerializerFunc = TFunction<void(FProperty* InnerProp, const void* ElementPtr, TSharedRef<FUtf8JsonWriter> Writer)>;
 using FObjPropertySetterFunc = TFunction<void(FProperty* Prop, void* Obj, const FString& Value, const TArray<FString> &Paths, int32 PathIndex)>;
 
 class ObjUtils
@@ -17,12 +18,12 @@ class ObjUtils
 	static TMap<FFieldClass*, FJsonArraySerializerFunc> JsonArraySerializers;
 	static TMap<FFieldClass*, FObjPropertySetterFunc> ObjPropertySetters;
 	
-	static void SerializeProperty(UObject* obj, TSharedRef<TJsonWriter<>> Writer);
+	static void SerializeProperty(UObject* obj, TSharedRef<FUtf8JsonWriter> Writer);
 	static void SerializeProperty(const FArrayProperty* ArrayProp, const void* ArrayPtr,
-	TSharedRef<TJsonWriter<>> Writer);
-	static void SerializeProperty(const FSetProperty* SetProp, const void* SetPtr, TSharedRef<TJsonWriter<>> Writer);
+	TSharedRef<FUtf8JsonWriter> Writer);
+	static void SerializeProperty(const FSetProperty* SetProp, const void* SetPtr, TSharedRef<FUtf8JsonWriter> Writer);
 	static void SerializeProperty(const FStructProperty* StructProp, const void* StructPtr,
-	TSharedRef<TJsonWriter<>> Writer);
+	TSharedRef<FUtf8JsonWriter> Writer);
 	
 	static void SetPropertyByPath(
 		UObject* Obj,
@@ -39,7 +40,7 @@ class ObjUtils
 		const TArray<FString>& PathParts,
 		FString Value, int32 Index = 0);
 public:
-	static FString SerializeObjectToJson(UObject* obj);
+	static TArray<uint8> SerializeObjectToJson(UObject* obj);
 	static void SetPropertyValueFromString(UObject* obj, const FString& PropertyPath, const FString& PropertyValue);
 };
 
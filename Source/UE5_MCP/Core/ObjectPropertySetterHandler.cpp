@@ -1,4 +1,5 @@
 ﻿#include "ObjUtils.h"
+#include "AssetLoadUtils.h"
 
 // Value property should have PathIndex == Paths.Num()
 // Container property should have PathIndex < Paths.Num() and next path should be index/key
@@ -189,7 +190,7 @@ TMap<FFieldClass*, FObjPropertySetterFunc> ObjUtils::ObjPropertySetters = {
 
 				if (PathIndex == Paths.Num())
 				{
-					UObject* Asset = StaticLoadObject(PropCasted->PropertyClass, nullptr, *Value);
+					UObject* Asset = AssetLoadUtils::LoadObject(PropCasted->PropertyClass, Value);
 					if (!Asset)
 						throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Failed to load asset at path: %s"), *Value)));
 					PropCasted->SetObjectPropertyValue_InContainer(Obj, Asset);
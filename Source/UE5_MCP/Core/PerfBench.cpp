@@ -0,0 +1,319 @@
+﻿#include "PerfBench.h"
+
+#include "BPUtils.h"
+#include "ClassUtils.h"
+#include "GraphUtils.h"
+#include "JsonBuffer.h"
+#include "SnapshotUtils.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_CallFunction.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SCS_Node.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "JsonObjectConverter.h"
+#include "Serialization/JsonWriter.h"
+#include "UE5_MCP/API/JsonStructReader.h"
+#include "UE5_MCP/API/DTO/BPComponentPropertySetReq.h"
+
+static FAutoConsoleCommand PerfBenchCommand(
+	TEXT("UE5_MCP.Perf"),
+	TEXT("Benchmarks the UE5_MCP Core operations over synthetic Blueprints. Args: node counts, default 10 100 1000 10000"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		TArray<int32> Sizes;
+		for (const FString& Arg : Args)
+		{
+			const int32 Size = FCString::Atoi(*Arg);
+			if (Size >= 2)
+				Sizes.Add(Size);
+		}
+		if (Sizes.IsEmpty())
+			Sizes = { 10, 100, 1000, 10000 };
+		PerfBench::Run(Sizes);
+	}));
+
+TArray<PerfBench::FResult> PerfBench::Run(const TArray<int32>& Sizes)
+{
+	TArray<FResult> Results;
+	for (const int32 Size : Sizes)
+	{
+		UE_LOG(LogTemp, Display, TEXT("UE5_MCP.Perf: building synthetic Blueprint with %d nodes"), Size);
+		FSyntheticBlueprint Synthetic = CreateSyntheticBlueprint(Size);
+		UBlueprint* Blueprint = Synthetic.Blueprint;
+		UEdGraph* Graph = Synthetic.Graph;
+
+		MeasureParse(Results, Size);
+
+		Measure(Results, TEXT("SerializeGraph"), Size, 5, [&](int32)
+		{
+			JsonBuffer::Recycle(BPUtils::GetBlueprintGraphJson(Graph));
+		});
+
+		Measure(Results, TEXT("Snapshot"), Size, 5, [&](int32)
+		{
+			JsonBuffer::Recycle(SnapshotUtils::EncodeBlueprint(SnapshotUtils::CaptureBlueprint(Blueprint)));
+		});
+
+		// Pins are wired from the end of the graph, the worst case for the linear node lookup
+		Measure(Results, TEXT("PinConnect"), Size, FMath::Min(20, Size - 1), [&](int32 Iteration)
+		{
+			const int32 OutputIndex = Synthetic.NodeIds.Num() - 2 - Iteration;
+			GraphUtils::ConnectPins(Blueprint, Graph,
+				Synthetic.NodeIds[OutputIndex], TEXT("ReturnValue"),
+				Synthetic.NodeIds[OutputIndex + 1], TEXT("B"));
+		});
+
+		// Wiring runs of up to 50 links, connected on even iterations and broken again on odd ones
+		// WiringLegacy adds the skeleton refresh every link used to trigger, WiringBatched is one request's worth of edits
+		const int32 WiringLinks = FMath::Min(50, Size - 1);
+		auto Wire = [&](int32 Iteration, bool bLegacy)
+		{
+			for (int32 Link = 0; Link < WiringLinks; ++Link)
+			{
+				const FGuid& OutputId = Synthetic.NodeIds[Link];
+				const FGuid& InputId = Synthetic.NodeIds[Link + 1];
+				if (Iteration % 2 == 0)
+					GraphUtils::ConnectPins(Blueprint, Graph, OutputId, TEXT("ReturnValue"), InputId, TEXT("B"));
+				else
+					GraphUtils::BreakPinConnection(Blueprint, Graph, OutputId, TEXT("ReturnValue"), InputId, TEXT("B"));
+				if (bLegacy)
+					FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+			}
+		};
+		Measure(Results, TEXT("WiringLegacy"), Size, 6, [&](int32 Iteration)
+		{
+			Wire(Iteration, true);
+		});
+		Measure(Results, TEXT("WiringBatched"), Size, 6, [&](int32 Iteration)
+		{
+			GraphUtils::FScopedBatchEdit Batch;
+			Wire(Iteration, false);
+		});
+
+		Measure(Results, TEXT("NodeAdd"), Size, 20, [&](int32)
+		{
+			GraphUtils::AddMathFunctionCallToGraph(Blueprint, Graph, TEXT("Add_IntInt"));
+		});
+
+		Measure(Results, TEXT("PropertySet"), Size, 5, [&](int32 Iteration)
+		{
+			BPUtils::SetComponentPropertyInBlueprint(Blueprint, Synthetic.ComponentName,
+				{ { TEXT("bHiddenInGame"), Iteration % 2 == 0 ? TEXT("true") : TEXT("false") } });
+		});
+
+		Measure(Results, TEXT("VariableDefaultSet"), Size, 5, [&](int32 Iteration)
+		{
+			BPUtils::SetVariableDefaultValueInBlueprint(Blueprint, TEXT("Var_0"), FString::FromInt(Iteration));
+		});
+
+		Measure(Results, TEXT("VariableAddCompile"), Size, 3, [&](int32 Iteration)
+		{
+			BPUtils::AddVariableToBlueprint(Blueprint, FString::Printf(TEXT("int PerfVar_%d"), Iteration), TEXT("0"));
+		});
+
+		static const TCHAR* ClassNames[] = {
+			TEXT("/Script/Engine.Actor"),
+			TEXT("Engine.StaticMeshComponent"),
+			TEXT("/Script/Engine.SceneComponent"),
+		};
+		Measure(Results, TEXT("FindClassByName"), Size, 100, [&](int32 Iteration)
+		{
+			ClassUtils::FindClassByName(ClassNames[Iteration % UE_ARRAY_COUNT(ClassNames)]);
+		});
+
+		DestroySyntheticBlueprint(Synthetic);
+	}
+
+	WriteResults(Results);
+	return Results;
+}
+
+PerfBench::FSyntheticBlueprint PerfBench::CreateSyntheticBlueprint(int32 NodeCount)
+{
+	FSyntheticBlueprint Synthetic;
+
+	UPackage* Package = CreatePackage(*FString::Printf(TEXT("/Temp/UE5_MCP/Perf/BP_Perf_%d"), NodeCount));
+	Package->SetFlags(RF_Transient);
+	const FName Name = MakeUniqueObjectName(Package, UBlueprint::StaticClass(), *FString::Printf(TEXT("BP_Perf_%d"), NodeCount));
+	UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(AActor::StaticClass(), Package, Name,
+		BPTYPE_Normal, UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+	Synthetic.Blueprint = Blueprint;
+	Synthetic.Graph = BPUtils::GetEventGraph(Blueprint);
+
+	UFunction* AddFunction = UKismetMathLibrary::StaticClass()->FindFunctionByName(
+		GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_IntInt));
+	UEdGraphPin* PreviousResult = nullptr;
+	Synthetic.NodeIds.Reserve(NodeCount);
+	for (int32 Index = 0; Index < NodeCount; ++Index)
+	{
+		FGraphNodeCreator<UK2Node_CallFunction> NodeCreator(*Synthetic.Graph);
+		UK2Node_CallFunction* Node = NodeCreator.CreateNode();
+		Node->SetFromFunction(AddFunction);
+		Node->NodePosX = (Index % 100) * 300;
+		Node->NodePosY = (Index / 100) * 200;
+		NodeCreator.Finalize();
+
+		if (PreviousResult)
+			PreviousResult->MakeLinkTo(Node->FindPinChecked(TEXT("A")));
+		PreviousResult = Node->FindPinChecked(TEXT("ReturnValue"));
+		Synthetic.NodeIds.Add(Node->NodeGuid);
+	}
+
+	const FEdGraphPinType IntType(UEdGraphSchema_K2::PC_Int, NAME_None, nullptr, EPinContainerType::None, false, FEdGraphTerminalType());
+	for (int32 Index = 0; Index < FMath::Max(1, NodeCount / 10); ++Index)
+	{
+		FBlueprintEditorUtils::AddMemberVariable(Blueprint, *FString::Printf(TEXT("Var_%d"), Index), IntType, TEXT("0"));
+	}
+
+	USimpleConstructionScript* SCS = Blueprint->SimpleConstructionScript;
+	for (int32 Index = 0; Index < FMath::Clamp(NodeCount / 100, 1, 100); ++Index)
+	{
+		USCS_Node* ComponentNode = SCS->CreateNode(USceneComponent::StaticClass(), *FString::Printf(TEXT("Component_%d"), Index));
+		if (SCS->GetRootNodes().Num() > 0)
+			SCS->GetRootNodes()[0]->AddChildNode(ComponentNode);
+		else
+			SCS->AddNode(ComponentNode);
+		Synthetic.ComponentName = ComponentNode->GetVariableName().ToString();
+	}
+
+	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	BPUtils::CompileBlueprint(Blueprint);
+	return Synthetic;
+}
+
+void PerfBench::DestroySyntheticBlueprint(FSyntheticBlueprint& Synthetic)
+{
+	if (Synthetic.Blueprint)
+	{
+		Synthetic.Blueprint->ClearFlags(RF_Standalone | RF_Public);
+		if (Synthetic.Blueprint->GeneratedClass)
+			Synthetic.Blueprint->GeneratedClass->ClearFlags(RF_Standalone | RF_Public);
+	}
+	Synthetic = FSyntheticBlueprint();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void PerfBench::MeasureParse(TArray<FResult>& OutResults, int32 Size)
+{
+	// A property set request with one entry per node, the largest body shape the API takes today
+	FBPComponentPropertySetReq Request;
+	Request.BpPath = TEXT("/Game/Perf/BP_Perf");
+	Request.ComponentName = TEXT("Component_0");
+	for (int32 Index = 0; Index < Size; ++Index)
+	{
+		Request.Properties.Add(FString::Printf(TEXT("RelativeLocation.X_%d"), Index), FString::Printf(TEXT("%d.5 \"quoted\""), Index));
+	}
+	FString JsonString;
+	FJsonObjectConverter::UStructToJsonObjectString(Request, JsonString);
+	FTCHARToUTF8 Converter(*JsonString);
+	const TArray<uint8> Body(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+
+	Measure(OutResults, TEXT("ParseJsonDom"), Size, 20, [&](int32)
+	{
+		FUTF8ToTCHAR BodyConverter(reinterpret_cast<const char*>(Body.GetData()), Body.Num());
+		FString BodyString(BodyConverter.Length(), BodyConverter.Get());
+		FBPComponentPropertySetReq Parsed;
+		if (!FJsonObjectConverter::JsonObjectStringToUStruct(BodyString, &Parsed, 0, 0))
+			throw std::runtime_error("JSON DOM failed to parse the request");
+	});
+
+	Measure(OutResults, TEXT("ParseStreaming"), Size, 20, [&](int32)
+	{
+		FBPComponentPropertySetReq Parsed;
+		if (!JsonStructReader::Read(Parsed, Body) || Parsed.Properties.Num() != Size)
+			throw std::runtime_error("Streaming reader failed to parse the request");
+	});
+}
+
+void PerfBench::Measure(TArray<FResult>& OutResults, const TCHAR* Case, int32 Size, int32 Iterations,
+	TFunctionRef<void(int32 Iteration)> Body)
+{
+	FResult& Result = OutResults.AddDefaulted_GetRef();
+	Result.Case = Case;
+	Result.Size = Size;
+
+	TArray<double> Samples;
+	Samples.Reserve(Iterations);
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const double StartSeconds = FPlatformTime::Seconds();
+		try
+		{
+			Body(Iteration);
+		} catch (std::runtime_error& e)
+		{
+			Result.Error = UTF8_TO_TCHAR(e.what());
+			break;
+		}
+		Samples.Add((FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+	}
+
+	Result.Iterations = Samples.Num();
+	if (Samples.Num() > 0)
+	{
+		Samples.Sort();
+		double TotalMs = 0.0;
+		for (const double Sample : Samples)
+			TotalMs += Sample;
+		Result.MeanMs = TotalMs / Samples.Num();
+		Result.MedianMs = Samples[Samples.Num() / 2];
+		Result.MinMs = Samples[0];
+		Result.MaxMs = Samples.Last();
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("UE5_MCP.Perf: %-18s nodes=%-6d n=%-4d mean=%10.3f ms median=%10.3f ms max=%10.3f ms %s"),
+		Case, Size, Result.Iterations, Result.MeanMs, Result.MedianMs, Result.MaxMs, *Result.Error);
+}
+
+void PerfBench::WriteResults(const TArray<FResult>& Results)
+{
+	const FString Directory = FPaths::ProjectSavedDir() / TEXT("UE5_MCP") / TEXT("Perf");
+	// Milliseconds too, the small automation tests finish within the same second
+	const FString BaseName = Directory / FString::Printf(TEXT("Perf-%s"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S-%s")));
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	FString Csv = TEXT("Case,Size,Iterations,MeanMs,MedianMs,MinMs,MaxMs,Error\n");
+	for (const FResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%s,%d,%d,%.4f,%.4f,%.4f,%.4f,\"%s\"\n"),
+			*Result.Case, Result.Size, Result.Iterations, Result.MeanMs, Result.MedianMs, Result.MinMs, Result.MaxMs,
+			*Result.Error.Replace(TEXT("\""), TEXT("\"\"")));
+	}
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Writer->WriteArrayStart(TEXT("Results"));
+	for (const FResult& Result : Results)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Case"), Result.Case);
+		Writer->WriteValue(TEXT("Size"), Result.Size);
+		Writer->WriteValue(TEXT("Iterations"), Result.Iterations);
+		Writer->WriteValue(TEXT("MeanMs"), Result.MeanMs);
+		Writer->WriteValue(TEXT("MedianMs"), Result.MedianMs);
+		Writer->WriteValue(TEXT("MinMs"), Result.MinMs);
+		Writer->WriteValue(TEXT("MaxMs"), Result.MaxMs);
+		if (!Result.Error.IsEmpty())
+			Writer->WriteValue(TEXT("Error"), Result.Error);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	FFileHelper::SaveStringToFile(Csv, *(BaseName + TEXT(".csv")));
+	FFileHelper::SaveStringToFile(Json, *(BaseName + TEXT(".json")));
+	UE_LOG(LogTemp, Display, TEXT("UE5_MCP.Perf: results written to %s.csv/.json"), *BaseName);
+}
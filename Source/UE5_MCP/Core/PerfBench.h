@@ -0,0 +1,51 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+class UBlueprint;
+class UEdGraph;
+
+// Benchmarks of the Core operations over synthetic Blueprints of increasing size
+// Run as the UE5_MCP.Perf automation tests of the UE5_MCPTests module, headless:
+// UnrealEditor-Cmd <Project>.uproject -nullrhi -unattended -ExecCmds="Automation RunTests UE5_MCP.Perf;Quit"
+// or from the editor console with "UE5_MCP.Perf [NodeCounts...]"
+// Results are written as CSV and JSON to Saved/UE5_MCP/Perf
+class UE5_MCP_API PerfBench
+{
+public:
+	struct FResult
+	{
+		FString Case;
+		int32 Size = 0;
+		int32 Iterations = 0;
+		double MeanMs = 0.0;
+		double MedianMs = 0.0;
+		double MinMs = 0.0;
+		double MaxMs = 0.0;
+		FString Error;
+	};
+
+	static TArray<FResult> Run(const TArray<int32>& Sizes);
+
+private:
+	struct FSyntheticBlueprint
+	{
+		UBlueprint* Blueprint = nullptr;
+		UEdGraph* Graph = nullptr;
+		TArray<FGuid> NodeIds; // chained Add_IntInt nodes, ReturnValue linked to A of the next one
+		FString ComponentName;
+	};
+
+	// Builds a transient Actor Blueprint with NodeCount nodes, NodeCount / 10 variables and a few components
+	// The graph is populated directly, only the measured operations go through Core
+	static FSyntheticBlueprint CreateSyntheticBlueprint(int32 NodeCount);
+	static void DestroySyntheticBlueprint(FSyntheticBlueprint& Synthetic);
+
+	// Compares the JSON DOM and streaming request parsing on a body with Size entries
+	static void MeasureParse(TArray<FResult>& OutResults, int32 Size);
+
+	// Times Body once per iteration, a thrown error stops the case and is recorded in the result
+	static void Measure(TArray<FResult>& OutResults, const TCHAR* Case, int32 Size, int32 Iterations,
+		TFunctionRef<void(int32 Iteration)> Body);
+
+	static void WriteResults(const TArray<FResult>& Results);
+};
@@ -1,4 +1,5 @@
 ﻿#include "PinUtils.h"
+#include "MCPTrace.h"
 
 #include "ClassUtils.h"
 #include "K2Node_FunctionEntry.h"
@@ -8,6 +9,7 @@
 
 bool PinUtils::ResolvePinTypeByName(const FString& TypeStr, FEdGraphPinType& OutPinType)
 {
+    MCP_TRACE_SCOPE("PinUtils::ResolvePinTypeByName");
     FString CleanType = TypeStr.TrimStartAndEnd();
 
     if (CleanType.IsEmpty())
@@ -162,6 +164,7 @@ bool PinUtils::ResolvePinTypeByName(const FString& TypeStr, FEdGraphPinType& Out
 void PinUtils::SetupFunctionPins(UK2Node_FunctionTerminator* Node,
                                 const FString& Signature, bool bIsInput)
 {
+    MCP_TRACE_SCOPE("PinUtils::SetupFunctionPins");
     if (Signature.IsEmpty())
         return;
 
@@ -200,6 +203,7 @@ void PinUtils::SetupFunctionPins(UK2Node_FunctionTerminator* Node,
 
 void PinUtils::CleanFunctionPins(UK2Node_FunctionEntry* EntryNode, UK2Node_FunctionResult* ReturnNode)
 {
+    MCP_TRACE_SCOPE("PinUtils::CleanFunctionPins");
     if (!EntryNode || !ReturnNode)
         return;
 
@@ -228,8 +232,35 @@ void PinUtils::CleanFunctionPins(UK2Node_FunctionEntry* EntryNode, UK2Node_Funct
     }
 }
 
+bool PinUtils::FunctionPinsMatch(const UK2Node_FunctionTerminator* Node, const FString& Signature)
+{
+    MCP_TRACE_SCOPE("PinUtils::FunctionPinsMatch");
+    if (!Node)
+        return false;
+
+    TArray<FString> Params;
+    Signature.ParseIntoArray(Params, TEXT(","), true);
+    int32 PinIndex = 0;
+    for (const FString& ParamStr : Params)
+    {
+        // Skips the parameters SetupFunctionPins skips
+        FString TypeName, VarName;
+        FEdGraphPinType PinType;
+        if (!SplitTypeVar(ParamStr, TypeName, VarName) || VarName.IsEmpty() || !ResolvePinTypeByName(TypeName, PinType))
+            continue;
+
+        if (!Node->UserDefinedPins.IsValidIndex(PinIndex))
+            return false;
+        const TSharedPtr<FUserPinInfo>& PinInfo = Node->UserDefinedPins[PinIndex++];
+        if (PinInfo->PinName != FName(*VarName) || PinInfo->PinType != PinType)
+            return false;
+    }
+    return PinIndex == Node->UserDefinedPins.Num();
+}
+
 bool PinUtils::SplitTypeVar(const FString& Signature, FString& OutType, FString& OutVar)
 {
+    MCP_TRACE_SCOPE("PinUtils::SplitTypeVar");
     auto Trimmed = Signature.TrimStartAndEnd();
     
     FRegexPattern Pattern(TEXT(R"(^(.+)\s+(\w+)$)"));
@@ -13,5 +13,8 @@ public:
 
 	static void CleanFunctionPins(UK2Node_FunctionEntry* EntryNode, UK2Node_FunctionResult* ReturnNode);
 
+	// Whether the node's user defined pins are the ones SetupFunctionPins would create from Signature
+	static bool FunctionPinsMatch(const UK2Node_FunctionTerminator* Node, const FString& Signature);
+
 	static bool SplitTypeVar(const FString& Signature, FString& OutType, FString& OutVar);
 };
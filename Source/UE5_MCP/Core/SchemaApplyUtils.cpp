@@ -0,0 +1,294 @@
+﻿#include "SchemaApplyUtils.h"
+#include "MCPTrace.h"
+
+#include "BPUtils.h"
+#include "ClassUtils.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "PinUtils.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_FunctionEntry.h"
+#include "K2Node_FunctionResult.h"
+#include "EdGraph/EdGraph.h"
+#include "Engine/Blueprint.h"
+#include "Engine/SCS_Node.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Serialization/MemoryWriter.h"
+
+FSchemaApplyResult SchemaApplyUtils::ApplyBlueprintSchema(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema)
+{
+	MCP_TRACE_SCOPE("SchemaApplyUtils::ApplyBlueprintSchema");
+	if (!Blueprint)
+		throw std::runtime_error("Blueprint is null");
+
+	FSchemaApplyResult Result;
+	{
+		// Edits that need a compile all run as one when the scope ends, defaults are applied in place
+		BPUtils::FScopedDeferCompile DeferCompile(&Result.bCompiled);
+		ApplyVariables(Blueprint, Schema, Result);
+		ApplyFunctions(Blueprint, Schema, Result);
+		ApplyComponents(Blueprint, Schema, Result);
+	}
+
+	Result.Status = BPUtils::GetCompileStatusName(Blueprint);
+	return Result;
+}
+
+void SchemaApplyUtils::ApplyItem(FSchemaApplyResult& Result, const TCHAR* Kind, const FString& Name,
+	TFunctionRef<FString()> Apply)
+{
+	try
+	{
+		FString Action = Apply();
+		Result.Items.Add({ Kind, Name, MoveTemp(Action), FString() });
+	}
+	catch (std::runtime_error& e)
+	{
+		Result.Items.Add({ Kind, Name, TEXT("Failed"), UTF8_TO_TCHAR(e.what()) });
+	}
+}
+
+void SchemaApplyUtils::ApplyVariables(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema, FSchemaApplyResult& Result)
+{
+	MCP_TRACE_SCOPE("SchemaApplyUtils::ApplyVariables");
+	auto FindVariable = [Blueprint](const FString& VarName)
+	{
+		return Blueprint->NewVariables.FindByPredicate(
+			[&VarName](const FBPVariableDescription& V) { return V.VarName.ToString() == VarName; });
+	};
+
+	TSet<FString> Desired;
+	for (const FSchemaVariableDesc& Desc : Schema.Variables)
+	{
+		Desired.Add(Desc.Name);
+		ApplyItem(Result, TEXT("Variable"), Desc.Name, [&]() -> FString
+		{
+			FEdGraphPinType PinType;
+			if (!PinUtils::ResolvePinTypeByName(Desc.Type, PinType))
+				throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(TEXT("Unknown variable type: %s"), *Desc.Type)));
+
+			if (!FindVariable(Desc.Name))
+			{
+				BPUtils::AddVariableToBlueprint(Blueprint, Desc.Type + TEXT(" ") + Desc.Name, Desc.DefaultValue);
+				return TEXT("Created");
+			}
+
+			bool bUpdated = false;
+			if (FindVariable(Desc.Name)->VarType != PinType)
+			{
+				FBlueprintEditorUtils::ChangeMemberVariableType(Blueprint, *Desc.Name, PinType);
+				BPUtils::CompileBlueprint(Blueprint);
+				bUpdated = true;
+			}
+			if (!Desc.DefaultValue.IsEmpty() && FindVariable(Desc.Name)->DefaultValue != Desc.DefaultValue)
+			{
+				BPUtils::SetVariableDefaultValueInBlueprint(Blueprint, Desc.Name, Desc.DefaultValue);
+				bUpdated = true;
+			}
+			return bUpdated ? TEXT("Updated") : TEXT("Unchanged");
+		});
+	}
+
+	if (!Schema.bPrune)
+		return;
+
+	TArray<FString> Removed;
+	for (const FBPVariableDescription& Variable : Blueprint->NewVariables)
+	{
+		if (!Desired.Contains(Variable.VarName.ToString()))
+			Removed.Add(Variable.VarName.ToString());
+	}
+	for (const FString& VarName : Removed)
+	{
+		ApplyItem(Result, TEXT("Variable"), VarName, [&]() -> FString
+		{
+			BPUtils::DeleteVariableFromBlueprint(Blueprint, VarName);
+			return TEXT("Removed");
+		});
+	}
+}
+
+void SchemaApplyUtils::ApplyFunctions(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema, FSchemaApplyResult& Result)
+{
+	MCP_TRACE_SCOPE("SchemaApplyUtils::ApplyFunctions");
+	TSet<FString> Desired;
+	for (const FSchemaFunctionDesc& Desc : Schema.Functions)
+	{
+		Desired.Add(Desc.FunctionName);
+		ApplyItem(Result, TEXT("Function"), Desc.FunctionName, [&]() -> FString
+		{
+			UEdGraph* Graph = BPUtils::GetFunctionGraph(Blueprint, Desc.FunctionName);
+			if (!Graph)
+			{
+				BPUtils::AddFunctionGraph(Blueprint, Desc.FunctionName, Desc.FunctionInputSignature, Desc.FunctionOutputSignature);
+				return TEXT("Created");
+			}
+
+			TArray<UK2Node_FunctionEntry*> EntryNodes;
+			TArray<UK2Node_FunctionResult*> ReturnNodes;
+			Graph->GetNodesOfClass(EntryNodes);
+			Graph->GetNodesOfClass(ReturnNodes);
+			const bool bInputsMatch = EntryNodes.Num() > 0
+				&& PinUtils::FunctionPinsMatch(EntryNodes[0], Desc.FunctionInputSignature);
+			const bool bOutputsMatch = ReturnNodes.Num() > 0
+				? PinUtils::FunctionPinsMatch(ReturnNodes[0], Desc.FunctionOutputSignature)
+				: Desc.FunctionOutputSignature.TrimStartAndEnd().IsEmpty();
+			if (bInputsMatch && bOutputsMatch)
+				return TEXT("Unchanged");
+
+			BPUtils::EditFunctionGraph(Blueprint, Desc.FunctionName, Desc.FunctionInputSignature, Desc.FunctionOutputSignature);
+			return TEXT("Updated");
+		});
+	}
+
+	if (!Schema.bPrune)
+		return;
+
+	TArray<FString> Removed;
+	for (UEdGraph* Graph : Blueprint->FunctionGraphs)
+	{
+		if (!Graph || Desired.Contains(Graph->GetName()) || Graph->GetFName() == UEdGraphSchema_K2::FN_UserConstructionScript)
+			continue;
+		if (Blueprint->ParentClass && Blueprint->ParentClass->FindFunctionByName(Graph->GetFName()))
+			continue;
+		Removed.Add(Graph->GetName());
+	}
+	for (const FString& FunctionName : Removed)
+	{
+		ApplyItem(Result, TEXT("Function"), FunctionName, [&]() -> FString
+		{
+			BPUtils::RemoveFunctionGraph(Blueprint, FunctionName);
+			return TEXT("Removed");
+		});
+	}
+}
+
+void SchemaApplyUtils::ApplyComponents(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema, FSchemaApplyResult& Result)
+{
+	MCP_TRACE_SCOPE("SchemaApplyUtils::ApplyComponents");
+	auto IsNativeComponent = [Blueprint](const FString& ComponentName)
+	{
+		return Blueprint->GeneratedClass && Blueprint->GeneratedClass->FindPropertyByName(*ComponentName);
+	};
+
+	// Components are created first and attached after, so a component may attach to one listed below it
+	const int32 FirstItem = Result.Items.Num();
+	TSet<FString> Desired;
+	for (const FSchemaComponentDesc& Desc : Schema.Components)
+	{
+		Desired.Add(Desc.ComponentName);
+		ApplyItem(Result, TEXT("Component"), Desc.ComponentName, [&]() -> FString
+		{
+			USCS_Node* Node = FindComponentNode(Blueprint, Desc.ComponentName);
+			if (!Node)
+			{
+				if (IsNativeComponent(Desc.ComponentName))
+					return TEXT("Unchanged");
+				BPUtils::AddComponentToBlueprintByName(Blueprint, Desc.ComponentClass, Desc.ComponentName, Desc.AttachTo);
+				return TEXT("Created");
+			}
+
+			if (Desc.ComponentClass.IsEmpty() || Node->ComponentClass == ClassUtils::FindClassByName(Desc.ComponentClass))
+				return TEXT("Unchanged");
+
+			BPUtils::RemoveComponentFromBlueprint(Blueprint, Desc.ComponentName);
+			BPUtils::AddComponentToBlueprintByName(Blueprint, Desc.ComponentClass, Desc.ComponentName, Desc.AttachTo);
+			return TEXT("Replaced");
+		});
+	}
+
+	for (int32 Index = 0; Index < Schema.Components.Num(); ++Index)
+	{
+		const FSchemaComponentDesc& Desc = Schema.Components[Index];
+		FSchemaApplyResult::FItem& Item = Result.Items[FirstItem + Index];
+		if (Item.Action == TEXT("Failed"))
+			continue;
+
+		try
+		{
+			bool bUpdated = false;
+			USCS_Node* Node = FindComponentNode(Blueprint, Desc.ComponentName);
+			if (Node && !Desc.AttachTo.IsEmpty())
+			{
+				const USCS_Node* Parent = Blueprint->SimpleConstructionScript->FindParentNode(Node);
+				if (!Parent || Parent->GetVariableName().ToString() != Desc.AttachTo)
+				{
+					BPUtils::ChangeAttachToOfComponentInBlueprint(Blueprint, Desc.ComponentName, Desc.AttachTo);
+					bUpdated = true;
+				}
+			}
+			// Properties are always written, there is no cheap way to read them back as text to compare
+			if (Desc.Properties.Num() > 0)
+			{
+				BPUtils::SetComponentPropertyInBlueprint(Blueprint, Desc.ComponentName, Desc.Properties);
+				bUpdated = true;
+			}
+			if (bUpdated && Item.Action == TEXT("Unchanged"))
+				Item.Action = TEXT("Updated");
+		}
+		catch (std::runtime_error& e)
+		{
+			Item.Action = TEXT("Failed");
+			Item.Error = UTF8_TO_TCHAR(e.what());
+		}
+	}
+
+	if (!Schema.bPrune || !Blueprint->SimpleConstructionScript)
+		return;
+
+	TArray<FString> Removed;
+	const USCS_Node* DefaultRoot = Blueprint->SimpleConstructionScript->GetDefaultSceneRootNode();
+	for (USCS_Node* Node : Blueprint->SimpleConstructionScript->GetAllNodes())
+	{
+		if (Node && Node != DefaultRoot && !Desired.Contains(Node->GetVariableName().ToString()))
+			Removed.Add(Node->GetVariableName().ToString());
+	}
+	for (const FString& ComponentName : Removed)
+	{
+		ApplyItem(Result, TEXT("Component"), ComponentName, [&]() -> FString
+		{
+			BPUtils::RemoveComponentFromBlueprint(Blueprint, ComponentName);
+			return TEXT("Removed");
+		});
+	}
+}
+
+USCS_Node* SchemaApplyUtils::FindComponentNode(UBlueprint* Blueprint, const FString& ComponentName)
+{
+	if (!Blueprint->SimpleConstructionScript)
+		return nullptr;
+	for (USCS_Node* Node : Blueprint->SimpleConstructionScript->GetAllNodes())
+	{
+		if (Node && Node->GetVariableName().ToString() == ComponentName)
+			return Node;
+	}
+	return nullptr;
+}
+
+TArray<uint8> SchemaApplyUtils::EncodeResult(const FSchemaApplyResult& Result)
+{
+	MCP_TRACE_SCOPE("SchemaApplyUtils::EncodeResult");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Compiled"), Result.bCompiled);
+	Writer->WriteValue(TEXT("Status"), Result.Status);
+	Writer->WriteArrayStart(TEXT("Items"));
+	for (const FSchemaApplyResult::FItem& Item : Result.Items)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Kind"), Item.Kind);
+		Writer->WriteValue(TEXT("Name"), Item.Name);
+		Writer->WriteValue(TEXT("Action"), Item.Action);
+		if (!Item.Error.IsEmpty())
+			Writer->WriteValue(TEXT("Error"), Item.Error);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
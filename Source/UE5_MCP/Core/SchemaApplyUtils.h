@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "UE5_MCP/API/DTO/ApplyBlueprintSchemaReq.h"
+#include <stdexcept>
+
+class UBlueprint;
+class USCS_Node;
+
+struct FSchemaApplyResult
+{
+	struct FItem
+	{
+		FString Kind; // Variable, Function or Component
+		FString Name;
+		FString Action; // Created, Updated, Replaced, Removed, Unchanged or Failed
+		FString Error;
+	};
+
+	TArray<FItem> Items;
+	FString Status; // UpToDate, UpToDateWithWarnings or Error, after the compile
+	bool bCompiled = false;
+};
+
+// Reconciles a Blueprint's variables, functions and components with a declarative description
+class SchemaApplyUtils
+{
+public:
+	// Diffs the description against the Blueprint, applies every change and compiles once at the end
+	// An item that fails is reported and the others still apply. Nothing is compiled when nothing changed
+	static FSchemaApplyResult ApplyBlueprintSchema(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema);
+
+	static TArray<uint8> EncodeResult(const FSchemaApplyResult& Result);
+
+private:
+	// Runs one item's edit, recording its outcome and catching its error
+	static void ApplyItem(FSchemaApplyResult& Result, const TCHAR* Kind, const FString& Name, TFunctionRef<FString()> Apply);
+
+	static void ApplyVariables(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema, FSchemaApplyResult& Result);
+	static void ApplyFunctions(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema, FSchemaApplyResult& Result);
+	static void ApplyComponents(UBlueprint* Blueprint, const FApplyBlueprintSchemaReq& Schema, FSchemaApplyResult& Result);
+
+	static USCS_Node* FindComponentNode(UBlueprint* Blueprint, const FString& ComponentName);
+};
@@ -0,0 +1,187 @@
+﻿#include "SnapshotCache.h"
+#include "MCPTrace.h"
+
+#include "BPUtils.h"
+#include "ChangeEvents.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Blueprint.h"
+#include "Misc/PackageName.h"
+
+FRWLock SnapshotCache::Lock;
+TMap<FString, SnapshotCache::FEntry> SnapshotCache::Entries;
+std::atomic<uint64> SnapshotCache::NextRevision{1};
+std::atomic<uint64> SnapshotCache::Hits{0};
+std::atomic<uint64> SnapshotCache::Misses{0};
+std::atomic<uint64> SnapshotCache::Captures{0};
+FDelegateHandle SnapshotCache::ChangeQueuedHandle;
+FDelegateHandle SnapshotCache::ChangeHandle;
+FDelegateHandle SnapshotCache::AssetRemovedHandle;
+FDelegateHandle SnapshotCache::AssetRenamedHandle;
+
+void SnapshotCache::Initialize()
+{
+	ChangeQueuedHandle = ChangeEvents::OnChangeQueued().AddStatic(&SnapshotCache::HandleChangeQueued);
+	ChangeHandle = ChangeEvents::OnChange().AddStatic(&SnapshotCache::HandleChange);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddStatic(&SnapshotCache::HandleAssetRemoved);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddStatic(&SnapshotCache::HandleAssetRenamed);
+}
+
+void SnapshotCache::Shutdown()
+{
+	ChangeEvents::OnChangeQueued().Remove(ChangeQueuedHandle);
+	ChangeEvents::OnChange().Remove(ChangeHandle);
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(TEXT("AssetRegistry")))
+	{
+		AssetRegistryModule->Get().OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistryModule->Get().OnAssetRenamed().Remove(AssetRenamedHandle);
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	Entries.Empty();
+}
+
+FString SnapshotCache::ToPackagePath(const FString& Path)
+{
+	// bp_path may be given as '/Game/BP' or as the object path '/Game/BP.BP'
+	return FPackageName::ObjectPathToPackageName(Path);
+}
+
+FBlueprintSnapshotPtr SnapshotCache::Find(const FString& Path)
+{
+	const FString PackagePath = ToPackagePath(Path);
+	{
+		FReadScopeLock ReadLock(Lock);
+		const FEntry* Entry = Entries.Find(PackagePath);
+		if (Entry && !Entry->bStale)
+		{
+			++Hits;
+			return Entry->Snapshot;
+		}
+	}
+	++Misses;
+	return nullptr;
+}
+
+FBlueprintSnapshotPtr SnapshotCache::Acquire(const FString& Path)
+{
+	MCP_TRACE_SCOPE("SnapshotCache::Acquire");
+	check(IsInGameThread());
+
+	if (FBlueprintSnapshotPtr Snapshot = Find(Path))
+	{
+		FWriteScopeLock WriteLock(Lock);
+		if (FEntry* Entry = Entries.Find(ToPackagePath(Path)))
+			Entry->LastAccessSeconds = FPlatformTime::Seconds();
+		return Snapshot;
+	}
+
+	UBlueprint* Blueprint = BPUtils::LoadBlueprint(Path);
+	if (!Blueprint)
+		throw std::runtime_error("Failed to load Blueprint from path");
+
+	FBlueprintSnapshotPtr Snapshot = Capture(Blueprint);
+	Store(Snapshot->Path, Snapshot);
+	return Snapshot;
+}
+
+void SnapshotCache::Invalidate(const FString& Path)
+{
+	FWriteScopeLock WriteLock(Lock);
+	if (FEntry* Entry = Entries.Find(ToPackagePath(Path)))
+		Entry->bStale = true;
+}
+
+SnapshotCache::FStats SnapshotCache::GetStats()
+{
+	FStats Stats;
+	Stats.Hits = Hits.load();
+	Stats.Misses = Misses.load();
+	Stats.Captures = Captures.load();
+	FReadScopeLock ReadLock(Lock);
+	Stats.Entries = Entries.Num();
+	return Stats;
+}
+
+FBlueprintSnapshotPtr SnapshotCache::Capture(UBlueprint* Blueprint)
+{
+	++Captures;
+	TSharedRef<FBlueprintSnapshot, ESPMode::ThreadSafe> Snapshot =
+		MakeShared<FBlueprintSnapshot, ESPMode::ThreadSafe>(SnapshotUtils::CaptureBlueprint(Blueprint));
+	Snapshot->Revision = NextRevision++;
+	return Snapshot;
+}
+
+void SnapshotCache::Store(const FString& PackagePath, FBlueprintSnapshotPtr Snapshot)
+{
+	FWriteScopeLock WriteLock(Lock);
+	FEntry& Entry = Entries.FindOrAdd(PackagePath);
+	Entry.Snapshot = MoveTemp(Snapshot);
+	Entry.bStale = false;
+	Entry.LastAccessSeconds = FPlatformTime::Seconds();
+
+	if (Entries.Num() <= MaxEntries)
+		return;
+
+	// Drop the least recently read Blueprint
+	const FString* Oldest = nullptr;
+	double OldestSeconds = TNumericLimits<double>::Max();
+	for (const TPair<FString, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.LastAccessSeconds < OldestSeconds)
+		{
+			OldestSeconds = Pair.Value.LastAccessSeconds;
+			Oldest = &Pair.Key;
+		}
+	}
+	if (Oldest)
+		Entries.Remove(FString(*Oldest));
+}
+
+void SnapshotCache::HandleChangeQueued(const FChangeEvent& Event)
+{
+	Invalidate(Event.BlueprintPath);
+}
+
+void SnapshotCache::HandleChange(const FChangeEvent& Event)
+{
+	{
+		FReadScopeLock ReadLock(Lock);
+		const FEntry* Entry = Entries.Find(Event.BlueprintPath);
+		if (!Entry || !Entry->bStale)
+			return;
+	}
+
+	// Rebuilt ahead of the next read, unless the Blueprint is no longer loaded
+	const FString ObjectPath = FString::Printf(TEXT("%s.%s"), *Event.BlueprintPath,
+		*FPackageName::GetShortName(Event.BlueprintPath));
+	if (UBlueprint* Blueprint = FindObject<UBlueprint>(nullptr, *ObjectPath))
+	{
+		try
+		{
+			Store(Event.BlueprintPath, Capture(Blueprint));
+			return;
+		} catch (std::runtime_error& e)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Failed to capture %s: %s"), *Event.BlueprintPath, UTF8_TO_TCHAR(e.what()));
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	Entries.Remove(Event.BlueprintPath);
+}
+
+void SnapshotCache::HandleAssetRemoved(const FAssetData& AssetData)
+{
+	FWriteScopeLock WriteLock(Lock);
+	Entries.Remove(AssetData.PackageName.ToString());
+}
+
+void SnapshotCache::HandleAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	FWriteScopeLock WriteLock(Lock);
+	Entries.Remove(ToPackagePath(OldObjectPath));
+	Entries.Remove(AssetData.PackageName.ToString());
+}
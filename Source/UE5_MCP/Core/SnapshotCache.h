@@ -0,0 +1,68 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "SnapshotUtils.h"
+
+#include <atomic>
+
+struct FAssetData;
+struct FChangeEvent;
+
+using FBlueprintSnapshotPtr = TSharedPtr<const FBlueprintSnapshot, ESPMode::ThreadSafe>;
+
+// Immutable snapshots of recently read Blueprints, keyed by package path
+// A change marks the snapshot stale at once and it is captured again when ChangeEvents flushes, so readers
+// on any thread either get the last complete snapshot or none, never one that is half updated
+class SnapshotCache
+{
+public:
+	static void Initialize();
+	static void Shutdown();
+
+	// Returns the current snapshot, or null when the Blueprint isn't cached or has changed since. Safe on any thread
+	static FBlueprintSnapshotPtr Find(const FString& Path);
+
+	// Returns the current snapshot, loading and capturing the Blueprint when needed. Game thread only
+	static FBlueprintSnapshotPtr Acquire(const FString& Path);
+
+	static void Invalidate(const FString& Path);
+
+	struct FStats
+	{
+		uint64 Hits = 0;
+		uint64 Misses = 0;
+		uint64 Captures = 0;
+		int32 Entries = 0;
+	};
+	static FStats GetStats();
+
+private:
+	struct FEntry
+	{
+		FBlueprintSnapshotPtr Snapshot;
+		bool bStale = false;
+		double LastAccessSeconds = 0.0;
+	};
+
+	static FString ToPackagePath(const FString& Path);
+	static FBlueprintSnapshotPtr Capture(UBlueprint* Blueprint);
+	static void Store(const FString& PackagePath, FBlueprintSnapshotPtr Snapshot);
+
+	static void HandleChangeQueued(const FChangeEvent& Event);
+	static void HandleChange(const FChangeEvent& Event);
+	static void HandleAssetRemoved(const FAssetData& AssetData);
+	static void HandleAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+
+	static constexpr int32 MaxEntries = 128;
+
+	static FRWLock Lock;
+	static TMap<FString, FEntry> Entries;
+	static std::atomic<uint64> NextRevision;
+	static std::atomic<uint64> Hits;
+	static std::atomic<uint64> Misses;
+	static std::atomic<uint64> Captures;
+
+	static FDelegateHandle ChangeQueuedHandle;
+	static FDelegateHandle ChangeHandle;
+	static FDelegateHandle AssetRemovedHandle;
+	static FDelegateHandle AssetRenamedHandle;
+};
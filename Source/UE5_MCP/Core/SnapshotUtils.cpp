@@ -0,0 +1,524 @@
+﻿#include "SnapshotUtils.h"
+#include "MCPTrace.h"
+
+#include "BPUtils.h"
+#include "Metrics.h"
+#include "Async/ParallelFor.h"
+#include "Components/SceneComponent.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SCS_Node.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "GameFramework/Actor.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_CustomEvent.h"
+#include "K2Node_Event.h"
+#include "K2Node_VariableGet.h"
+#include "K2Node_VariableSet.h"
+
+ESnapshotFields SnapshotUtils::ParseFields(const FString& FieldList)
+{
+	MCP_TRACE_SCOPE("SnapshotUtils::ParseFields");
+	TArray<FString> Names;
+	FieldList.ParseIntoArray(Names, TEXT(","));
+	if (Names.Num() == 0)
+		return ESnapshotFields::All;
+
+	ESnapshotFields Fields = ESnapshotFields::None;
+	for (FString Name : Names)
+	{
+		Name.TrimStartAndEndInline();
+		if (Name.Equals(TEXT("variables"), ESearchCase::IgnoreCase))
+			Fields |= ESnapshotFields::Variables;
+		else if (Name.Equals(TEXT("functions"), ESearchCase::IgnoreCase))
+			Fields |= ESnapshotFields::Functions;
+		else if (Name.Equals(TEXT("components"), ESearchCase::IgnoreCase))
+			Fields |= ESnapshotFields::Components;
+		else if (Name.Equals(TEXT("graphs"), ESearchCase::IgnoreCase))
+			Fields |= ESnapshotFields::Graphs;
+		else
+			throw std::runtime_error(TCHAR_TO_UTF8(*FString::Printf(
+				TEXT("Unknown snapshot field %s, expected variables, functions, components or graphs"), *Name)));
+	}
+	return Fields;
+}
+
+FBlueprintSnapshot SnapshotUtils::CaptureBlueprint(UBlueprint* Blueprint, ESnapshotFields Fields)
+{
+	MCP_TRACE_SCOPE("SnapshotUtils::CaptureBlueprint");
+	if (!Blueprint)
+		throw std::runtime_error("Blueprint is null");
+
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	FBlueprintSnapshot Snapshot;
+	Snapshot.Path = Blueprint->GetPackage()->GetName();
+	Snapshot.ParentClass = Blueprint->ParentClass ? Blueprint->ParentClass->GetPathName() : FString();
+	Snapshot.Fields = Fields;
+	Snapshot.bCompiled = Cast<UBlueprintGeneratedClass>(Blueprint->GeneratedClass) != nullptr;
+
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Variables))
+		Snapshot.Variables = BPUtils::GetBlueprintVariables(Blueprint);
+
+	// Functions and native components come from the generated class, an uncompiled Blueprint has none yet
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Functions) && Snapshot.bCompiled)
+		Snapshot.Functions = BPUtils::GetBlueprintFunctions(Blueprint);
+
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Components))
+		CaptureComponents(Blueprint, Snapshot.Components);
+
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Graphs))
+	{
+		for (UEdGraph* Graph : Blueprint->UbergraphPages)
+		{
+			if (Graph)
+				Snapshot.Graphs.Add(CaptureGraph(Graph, TEXT("Event")));
+		}
+		for (UEdGraph* Graph : Blueprint->FunctionGraphs)
+		{
+			if (!Graph)
+				continue;
+			FGraphSnapshot& GraphSnapshot = Snapshot.Graphs.Add_GetRef(CaptureGraph(Graph, TEXT("Function")));
+			GraphSnapshot.bOverride = Blueprint->ParentClass
+				&& Blueprint->ParentClass->FindFunctionByName(Graph->GetFName()) != nullptr;
+		}
+		for (UEdGraph* Graph : Blueprint->MacroGraphs)
+		{
+			if (Graph)
+				Snapshot.Graphs.Add(CaptureGraph(Graph, TEXT("Macro")));
+		}
+	}
+
+	return Snapshot;
+}
+
+FString SnapshotUtils::DescribePinType(const UEdGraphPin* Pin)
+{
+	const FString Dir = Pin->Direction == EGPD_Input ? FString(TEXT("In")) : FString(TEXT("Out"));
+
+	FString Container;
+	switch (Pin->PinType.ContainerType)
+	{
+	case EPinContainerType::Array:
+		Container = TEXT("TArray");
+		break;
+	case EPinContainerType::Set:
+		Container = TEXT("TSet");
+		break;
+	case EPinContainerType::Map:
+		Container = TEXT("TMap");
+		break;
+	default:
+		break;
+	}
+
+	if (Container.IsEmpty())
+	{
+		if (Pin->PinType.PinSubCategory.IsNone())
+			return FString::Printf(TEXT("%s-%s"), *Pin->PinType.PinCategory.ToString(), *Dir);
+		return FString::Printf(TEXT("%s(%s)-%s"), *Pin->PinType.PinCategory.ToString(),
+			*Pin->PinType.PinSubCategory.ToString(), *Dir);
+	}
+
+	if (Pin->PinType.PinSubCategory.IsNone())
+		return FString::Printf(TEXT("%s<%s>-%s"), *Container, *Pin->PinType.PinCategory.ToString(), *Dir);
+	return FString::Printf(TEXT("%s<%s(%s)>-%s"), *Container, *Pin->PinType.PinCategory.ToString(),
+		*Pin->PinType.PinSubCategory.ToString(), *Dir);
+}
+
+FGraphSnapshot SnapshotUtils::CaptureGraph(UEdGraph* Graph, const FString& Kind)
+{
+	MCP_TRACE_SCOPE("SnapshotUtils::CaptureGraph");
+	if (!Graph)
+		throw std::runtime_error("Graph is null");
+
+	FGraphSnapshot Snapshot;
+	Snapshot.Name = Graph->GetName();
+	Snapshot.Kind = Kind;
+	Snapshot.Nodes.Reserve(Graph->Nodes.Num());
+
+	for (UEdGraphNode* Node : Graph->Nodes)
+	{
+		if (!Node)
+			continue;
+
+		FNodeSnapshot& NodeSnapshot = Snapshot.Nodes.AddDefaulted_GetRef();
+		NodeSnapshot.Id = Node->NodeGuid.ToString();
+		NodeSnapshot.Type = Node->GetClass()->GetName();
+		NodeSnapshot.bEnabled = Node->IsNodeEnabled();
+
+		NodeSnapshot.Pins.Reserve(Node->Pins.Num());
+		for (UEdGraphPin* Pin : Node->Pins)
+		{
+			FPinSnapshot& PinSnapshot = NodeSnapshot.Pins.AddDefaulted_GetRef();
+			PinSnapshot.Name = Pin->GetName();
+			PinSnapshot.Info = DescribePinType(Pin);
+			PinSnapshot.DefaultValue = Pin->DefaultValue;
+			if (const UObject* TypeObject = Pin->PinType.PinSubCategoryObject.Get())
+				PinSnapshot.TypeObject = TypeObject->GetPathName();
+			PinSnapshot.bOrphaned = Pin->bOrphanedPin;
+			for (UEdGraphPin* Linked : Pin->LinkedTo)
+			{
+				PinSnapshot.Links.Add({ Linked->GetOwningNode()->NodeGuid.ToString(), Linked->GetName() });
+			}
+		}
+
+		auto ClassName = [](UClass* Class) { return Class ? Class->GetName() : FString(); };
+		if (auto FuncNode = Cast<UK2Node_CallFunction>(Node))
+		{
+			NodeSnapshot.bIsPure = FuncNode->IsNodePure();
+			NodeSnapshot.Meta.Emplace(TEXT("FuncName"), FuncNode->FunctionReference.GetMemberName().ToString());
+			NodeSnapshot.Meta.Emplace(TEXT("FuncClass"), ClassName(FuncNode->FunctionReference.GetMemberParentClass()));
+		}
+		else if (auto EventNode = Cast<UK2Node_Event>(Node))
+		{
+			NodeSnapshot.Meta.Emplace(TEXT("EventName"), EventNode->EventReference.GetMemberName().ToString());
+			NodeSnapshot.Meta.Emplace(TEXT("EventClass"), ClassName(EventNode->EventReference.GetMemberParentClass()));
+		}
+		else if (auto CustomEventNode = Cast<UK2Node_CustomEvent>(Node))
+		{
+			NodeSnapshot.Meta.Emplace(TEXT("EventName"), CustomEventNode->CustomFunctionName.ToString());
+		}
+		else if (auto VarGetNode = Cast<UK2Node_VariableGet>(Node))
+		{
+			NodeSnapshot.Meta.Emplace(TEXT("VarName"), VarGetNode->VariableReference.GetMemberName().ToString());
+			NodeSnapshot.Meta.Emplace(TEXT("VarClass"), ClassName(VarGetNode->VariableReference.GetMemberParentClass()));
+		}
+		else if (auto VarSetNode = Cast<UK2Node_VariableSet>(Node))
+		{
+			NodeSnapshot.Meta.Emplace(TEXT("VarName"), VarSetNode->VariableReference.GetMemberName().ToString());
+			NodeSnapshot.Meta.Emplace(TEXT("VarClass"), ClassName(VarSetNode->VariableReference.GetMemberParentClass()));
+		}
+	}
+
+	return Snapshot;
+}
+
+void SnapshotUtils::CaptureComponents(UBlueprint* Blueprint, TArray<FComponentSnapshot>& OutComponents)
+{
+	auto CaptureSceneComponent = [](const USceneComponent* SceneComp, FComponentSnapshot& Snapshot)
+	{
+		for (const FName& SocketName : SceneComp->GetAllSocketNames())
+		{
+			Snapshot.Sockets.Add(SocketName.ToString());
+		}
+		if (!SceneComp->GetAttachSocketName().IsNone())
+			Snapshot.AttachToSocket = SceneComp->GetAttachSocketName().ToString();
+		if (SceneComp->GetAttachParent())
+			Snapshot.AttachToParent = SceneComp->GetAttachParent()->GetName();
+		for (const USceneComponent* Child : SceneComp->GetAttachChildren())
+		{
+			if (Child)
+				Snapshot.AttachChildren.Add(Child->GetName());
+		}
+	};
+
+	if (UBlueprintGeneratedClass* BPClass = Cast<UBlueprintGeneratedClass>(Blueprint->GeneratedClass))
+	{
+		if (AActor* CDO = Cast<AActor>(BPClass->GetDefaultObject()))
+		{
+			for (UActorComponent* Comp : CDO->GetComponents())
+			{
+				if (!Comp)
+					continue;
+				FComponentSnapshot& Snapshot = OutComponents.AddDefaulted_GetRef();
+				Snapshot.Name = Comp->GetName();
+				Snapshot.Class = Comp->GetClass()->GetName();
+				Snapshot.bNative = true;
+				Snapshot.bAttachable = Comp->IsA<USceneComponent>();
+				if (const USceneComponent* SceneComp = Cast<USceneComponent>(Comp))
+					CaptureSceneComponent(SceneComp, Snapshot);
+				CaptureChangedProperties(Comp, Snapshot.Properties);
+			}
+		}
+	}
+
+	USimpleConstructionScript* SCS = Blueprint->SimpleConstructionScript;
+	if (!SCS)
+		return;
+
+	for (USCS_Node* Node : SCS->GetAllNodes())
+	{
+		if (!Node)
+			continue;
+		FComponentSnapshot& Snapshot = OutComponents.AddDefaulted_GetRef();
+		Snapshot.Name = Node->GetVariableName().ToString();
+		Snapshot.Class = Node->ComponentClass ? Node->ComponentClass->GetName() : TEXT("None");
+		Snapshot.bAttachable = Node->ComponentTemplate && Node->ComponentTemplate->IsA<USceneComponent>();
+		Snapshot.bIsRoot = SCS->GetRootNodes().Contains(Node);
+		for (USCS_Node* Child : Node->GetChildNodes())
+		{
+			if (Child)
+				Snapshot.Children.Add(Child->GetVariableName().ToString());
+		}
+		if (const USceneComponent* SceneComp = Cast<USceneComponent>(Node->ComponentTemplate))
+			CaptureSceneComponent(SceneComp, Snapshot);
+		if (Node->ComponentTemplate)
+			CaptureChangedProperties(Node->ComponentTemplate, Snapshot.Properties);
+	}
+}
+
+void SnapshotUtils::CaptureChangedProperties(const UObject* Object, TArray<TPair<FString, FString>>& OutProperties)
+{
+	UObject* Archetype = Object->GetArchetype();
+	if (!Archetype || Archetype->GetClass() != Object->GetClass())
+		Archetype = Object->GetClass()->GetDefaultObject();
+
+	for (TFieldIterator<FProperty> It(Object->GetClass()); It; ++It)
+	{
+		const FProperty* Property = *It;
+		if (Property->HasAnyPropertyFlags(CPF_Transient | CPF_DuplicateTransient))
+			continue;
+		if (Property->Identical_InContainer(Object, Archetype))
+			continue;
+
+		FString Value;
+		Property->ExportText_InContainer(0, Value, Object, Archetype, const_cast<UObject*>(Object), PPF_None);
+		OutProperties.Emplace(Property->GetName(), MoveTemp(Value));
+	}
+}
+
+TArray<uint8> SnapshotUtils::EncodeBlueprint(const FBlueprintSnapshot& Snapshot, ESnapshotFields Fields)
+{
+	MCP_TRACE_SCOPE("SnapshotUtils::EncodeBlueprint");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	Fields &= Snapshot.Fields;
+
+	// Each part is encoded into its own buffer, the buffers are joined in order afterwards
+	struct FPart
+	{
+		TFunction<void(TSharedRef<FUtf8JsonWriter>)> Write;
+		TArray<uint8> Bytes;
+	};
+	TArray<FPart> Parts;
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Variables))
+		Parts.Add({ [&Snapshot](TSharedRef<FUtf8JsonWriter> Writer) { WriteStringArray(Snapshot.Variables, Writer); } });
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Functions))
+		Parts.Add({ [&Snapshot](TSharedRef<FUtf8JsonWriter> Writer) { WriteStringArray(Snapshot.Functions, Writer); } });
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Components))
+		Parts.Add({ [&Snapshot](TSharedRef<FUtf8JsonWriter> Writer) { WriteComponents(Snapshot.Components, Writer); } });
+	const int32 FirstGraphPart = Parts.Num();
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Graphs))
+	{
+		for (const FGraphSnapshot& Graph : Snapshot.Graphs)
+			Parts.Add({ [&Graph](TSharedRef<FUtf8JsonWriter> Writer) { WriteGraph(Graph, Writer); } });
+	}
+
+	ParallelFor(Parts.Num(), [&Parts](int32 Index)
+	{
+		MCP_TRACE_SCOPE("SnapshotUtils::EncodePart");
+		FPart& Part = Parts[Index];
+		Part.Bytes = JsonBuffer::Acquire();
+		FMemoryWriter Archive(Part.Bytes);
+		TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+		Part.Write(Writer);
+		Writer->Close();
+	}, Parts.Num() < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	JsonBuffer::AppendRaw(Output, "{\"Path\":");
+	JsonBuffer::AppendString(Output, Snapshot.Path);
+	JsonBuffer::AppendRaw(Output, ",\"ParentClass\":");
+	JsonBuffer::AppendString(Output, Snapshot.ParentClass);
+
+	int32 PartIndex = 0;
+	auto AppendPart = [&Output, &Parts, &PartIndex](const ANSICHAR* Key)
+	{
+		JsonBuffer::AppendRaw(Output, Key);
+		Output.Append(Parts[PartIndex].Bytes);
+		JsonBuffer::Recycle(MoveTemp(Parts[PartIndex].Bytes));
+		++PartIndex;
+	};
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Variables))
+		AppendPart(",\"Variables\":");
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Functions))
+		AppendPart(",\"Functions\":");
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Components))
+		AppendPart(",\"Components\":");
+	if (EnumHasAnyFlags(Fields, ESnapshotFields::Graphs))
+	{
+		JsonBuffer::AppendRaw(Output, ",\"Graphs\":[");
+		while (PartIndex < Parts.Num())
+			AppendPart(PartIndex == FirstGraphPart ? "" : ",");
+		JsonBuffer::AppendRaw(Output, "]");
+	}
+	JsonBuffer::AppendRaw(Output, "}");
+
+	return Output;
+}
+
+TArray<uint8> SnapshotUtils::EncodeGraph(const FGraphSnapshot& Graph)
+{
+	MCP_TRACE_SCOPE("SnapshotUtils::EncodeGraph");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	WriteGraphNodes(Graph, Writer);
+	Writer->Close();
+	return Output;
+}
+
+TArray<uint8> SnapshotUtils::EncodeComponentList(const FBlueprintSnapshot& Snapshot)
+{
+	MCP_TRACE_SCOPE("SnapshotUtils::EncodeComponentList");
+	if (!Snapshot.bCompiled)
+		throw std::runtime_error("Blueprint's GeneratedClass is null, please compile the Blueprint first");
+
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+
+	auto WriteComponent = [&Writer](const FComponentSnapshot& Component)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Name"), Component.Name);
+		Writer->WriteValue(TEXT("Class"), Component.Class);
+		Writer->WriteValue(TEXT("Attachable"), Component.bAttachable);
+		if (!Component.bNative)
+		{
+			Writer->WriteValue(TEXT("IsRoot"), Component.bIsRoot);
+			Writer->WriteValue(TEXT("Children"), Component.Children);
+		}
+		for (const FString& Socket : Component.Sockets)
+		{
+			Writer->WriteValue(TEXT("Socket"), Socket);
+		}
+		if (!Component.AttachToSocket.IsEmpty())
+			Writer->WriteValue(TEXT("AttachToSocket"), Component.AttachToSocket);
+		if (!Component.AttachToParent.IsEmpty())
+			Writer->WriteValue(TEXT("AttachToParent"), Component.AttachToParent);
+		if (Component.AttachChildren.Num() > 0)
+			Writer->WriteValue(TEXT("AttachChildren"), Component.AttachChildren);
+		Writer->WriteObjectEnd();
+	};
+
+	Writer->WriteObjectStart();
+	Writer->WriteArrayStart(TEXT("NativeComponents"));
+	for (const FComponentSnapshot& Component : Snapshot.Components)
+	{
+		if (Component.bNative)
+			WriteComponent(Component);
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteArrayStart(TEXT("BpComponents"));
+	for (const FComponentSnapshot& Component : Snapshot.Components)
+	{
+		if (!Component.bNative)
+			WriteComponent(Component);
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
+
+const FGraphSnapshot* SnapshotUtils::FindGraph(const FBlueprintSnapshot& Snapshot, const FString& Name, const FString& Kind)
+{
+	return Snapshot.Graphs.FindByPredicate([&Name, &Kind](const FGraphSnapshot& Graph)
+	{
+		return Graph.Kind == Kind && Graph.Name == Name;
+	});
+}
+
+void SnapshotUtils::WriteStringArray(const TArray<FString>& Values, TSharedRef<FUtf8JsonWriter> Writer)
+{
+	Writer->WriteArrayStart();
+	for (const FString& Value : Values)
+	{
+		Writer->WriteValue(Value);
+	}
+	Writer->WriteArrayEnd();
+}
+
+void SnapshotUtils::WriteComponents(const TArray<FComponentSnapshot>& Components, TSharedRef<FUtf8JsonWriter> Writer)
+{
+	Writer->WriteArrayStart();
+	for (const FComponentSnapshot& Component : Components)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Name"), Component.Name);
+		Writer->WriteValue(TEXT("Class"), Component.Class);
+		Writer->WriteValue(TEXT("Native"), Component.bNative);
+		Writer->WriteValue(TEXT("Attachable"), Component.bAttachable);
+		if (!Component.bNative)
+		{
+			Writer->WriteValue(TEXT("IsRoot"), Component.bIsRoot);
+			Writer->WriteValue(TEXT("Children"), Component.Children);
+		}
+		if (Component.Sockets.Num() > 0)
+			Writer->WriteValue(TEXT("Sockets"), Component.Sockets);
+		if (!Component.AttachToSocket.IsEmpty())
+			Writer->WriteValue(TEXT("AttachToSocket"), Component.AttachToSocket);
+		if (!Component.AttachToParent.IsEmpty())
+			Writer->WriteValue(TEXT("AttachToParent"), Component.AttachToParent);
+		if (Component.AttachChildren.Num() > 0)
+			Writer->WriteValue(TEXT("AttachChildren"), Component.AttachChildren);
+
+		Writer->WriteObjectStart(TEXT("Properties"));
+		for (const TPair<FString, FString>& Property : Component.Properties)
+		{
+			Writer->WriteValue(Property.Key, Property.Value);
+		}
+		Writer->WriteObjectEnd();
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+}
+
+void SnapshotUtils::WriteGraph(const FGraphSnapshot& Graph, TSharedRef<FUtf8JsonWriter> Writer)
+{
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Name"), Graph.Name);
+	Writer->WriteValue(TEXT("Kind"), Graph.Kind);
+	Writer->WriteIdentifierPrefix(TEXT("Nodes"));
+	WriteGraphNodes(Graph, Writer);
+	Writer->WriteObjectEnd();
+}
+
+void SnapshotUtils::WriteGraphNodes(const FGraphSnapshot& Graph, TSharedRef<FUtf8JsonWriter> Writer)
+{
+	MCP_TRACE_SCOPE("SnapshotUtils::WriteGraphNodes");
+	Writer->WriteArrayStart();
+	for (const FNodeSnapshot& Node : Graph.Nodes)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Id"), Node.Id);
+		Writer->WriteValue(TEXT("Type"), Node.Type);
+
+		Writer->WriteArrayStart(TEXT("Pins"));
+		for (const FPinSnapshot& Pin : Node.Pins)
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("Name"), Pin.Name);
+			Writer->WriteValue(TEXT("Inf"), Pin.Info);
+			Writer->WriteValue(TEXT("DefaultVal"), Pin.DefaultValue);
+			Writer->WriteArrayStart(TEXT("Link"));
+			for (const FPinLinkSnapshot& Link : Pin.Links)
+			{
+				Writer->WriteObjectStart();
+				Writer->WriteValue(TEXT("Id"), Link.NodeId);
+				Writer->WriteValue(TEXT("PinName"), Link.PinName);
+				Writer->WriteObjectEnd();
+			}
+			Writer->WriteArrayEnd();
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+
+		Writer->WriteObjectStart(TEXT("Meta"));
+		if (Node.bIsPure.IsSet())
+			Writer->WriteValue(TEXT("IsPure"), Node.bIsPure.GetValue());
+		for (const TPair<FString, FString>& Meta : Node.Meta)
+		{
+			Writer->WriteValue(Meta.Key, Meta.Value);
+		}
+		Writer->WriteObjectEnd();
+
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+}
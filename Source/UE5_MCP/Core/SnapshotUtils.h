@@ -0,0 +1,126 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "JsonBuffer.h"
+#include <stdexcept>
+
+class UBlueprint;
+class UEdGraph;
+
+// Plain copies of a Blueprint's state, captured on the game thread
+// They hold no UObject pointers, so they can be encoded on worker threads and kept after the Blueprint changes
+
+struct FPinLinkSnapshot
+{
+	FString NodeId;
+	FString PinName;
+};
+
+struct FPinSnapshot
+{
+	FString Name;
+	FString Info; // type and direction, e.g. 'int-In', 'TArray<object(Actor)>-Out'
+	FString DefaultValue;
+	TArray<FPinLinkSnapshot> Links;
+	// Path of the class, struct or enum of the pin type, e.g. /Script/Engine.Actor. Not written to JSON
+	FString TypeObject;
+	bool bOrphaned = false; // kept after the node lost the pin so its links and value aren't dropped
+
+	bool IsExec() const { return Info.StartsWith(TEXT("exec-")); }
+	bool IsInput() const { return Info.EndsWith(TEXT("-In")); }
+};
+
+struct FNodeSnapshot
+{
+	FString Id;
+	FString Type;
+	TArray<FPinSnapshot> Pins;
+	TOptional<bool> bIsPure;
+	bool bEnabled = true; // false for disabled nodes, e.g. the ghost events of a new Blueprint. Not written to JSON
+	// Node specific fields in write order, e.g. FuncName, EventName, VarName
+	TArray<TPair<FString, FString>> Meta;
+};
+
+struct FGraphSnapshot
+{
+	FString Name;
+	FString Kind; // Event, Function or Macro
+	bool bOverride = false; // function graph overriding a function of the parent class
+	TArray<FNodeSnapshot> Nodes;
+};
+
+struct FComponentSnapshot
+{
+	FString Name;
+	FString Class;
+	bool bNative = false;
+	bool bAttachable = false;
+	bool bIsRoot = false;
+	TArray<FString> Children; // construction script child nodes
+	TArray<FString> AttachChildren; // components attached to this one in the template
+	TArray<FString> Sockets;
+	FString AttachToSocket;
+	FString AttachToParent;
+	// Exported text of every property that differs from the component's archetype
+	TArray<TPair<FString, FString>> Properties;
+};
+
+enum class ESnapshotFields : uint8
+{
+	None = 0,
+	Variables = 1 << 0,
+	Functions = 1 << 1,
+	Components = 1 << 2,
+	Graphs = 1 << 3,
+	All = Variables | Functions | Components | Graphs
+};
+ENUM_CLASS_FLAGS(ESnapshotFields);
+
+struct FBlueprintSnapshot
+{
+	FString Path;
+	FString ParentClass;
+	ESnapshotFields Fields = ESnapshotFields::None;
+	bool bCompiled = false; // has a generated class, so functions and native components were captured
+	uint64 Revision = 0; // set by SnapshotCache, increases every time a Blueprint is captured again
+	TArray<FString> Variables;
+	TArray<FString> Functions;
+	TArray<FComponentSnapshot> Components;
+	TArray<FGraphSnapshot> Graphs;
+};
+
+class SnapshotUtils
+{
+public:
+	// Parses a comma separated field list ('variables,graphs'), empty means all fields
+	static ESnapshotFields ParseFields(const FString& FieldList);
+
+	// Copies the requested parts of the Blueprint in one pass, must run on the game thread
+	static FBlueprintSnapshot CaptureBlueprint(UBlueprint* Blueprint, ESnapshotFields Fields = ESnapshotFields::All);
+
+	static FGraphSnapshot CaptureGraph(UEdGraph* Graph, const FString& Kind = TEXT("Event"));
+
+	// Encodes every captured part on the task graph and joins them into one JSON object
+	// Fields narrows the output further, parts that were not captured are never written
+	static TArray<uint8> EncodeBlueprint(const FBlueprintSnapshot& Snapshot, ESnapshotFields Fields = ESnapshotFields::All);
+
+	// The node array in the /get_graph format
+	static TArray<uint8> EncodeGraph(const FGraphSnapshot& Graph);
+
+	// The NativeComponents / BpComponents object in the /get_components_of_bp format
+	static TArray<uint8> EncodeComponentList(const FBlueprintSnapshot& Snapshot);
+
+	static const FGraphSnapshot* FindGraph(const FBlueprintSnapshot& Snapshot, const FString& Name, const FString& Kind);
+
+	static void WriteGraphNodes(const FGraphSnapshot& Graph, TSharedRef<FUtf8JsonWriter> Writer);
+
+	// Type and direction of a pin in the snapshot Info format
+	static FString DescribePinType(const class UEdGraphPin* Pin);
+
+private:
+	static void CaptureComponents(UBlueprint* Blueprint, TArray<FComponentSnapshot>& OutComponents);
+	static void CaptureChangedProperties(const UObject* Object, TArray<TPair<FString, FString>>& OutProperties);
+
+	static void WriteStringArray(const TArray<FString>& Values, TSharedRef<FUtf8JsonWriter> Writer);
+	static void WriteComponents(const TArray<FComponentSnapshot>& Components, TSharedRef<FUtf8JsonWriter> Writer);
+	static void WriteGraph(const FGraphSnapshot& Graph, TSharedRef<FUtf8JsonWriter> Writer);
+};
@@ -0,0 +1,487 @@
+﻿#include "UsageIndex.h"
+#include "MCPTrace.h"
+
+#include "AssetLoadUtils.h"
+#include "ChangeEvents.h"
+#include "JsonBuffer.h"
+#include "Metrics.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "Engine/Blueprint.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_Event.h"
+#include "K2Node_Variable.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/ObjectSaveContext.h"
+#include "UObject/Package.h"
+
+static TAutoConsoleVariable<float> CVarUsageIndexFrameBudgetMs(
+	TEXT("UE5_MCP.UsageIndex.FrameBudgetMs"), 4.f,
+	TEXT("Game thread time per frame spent indexing Blueprint usages. At least one Blueprint is indexed every frame, 0 pauses indexing."));
+
+TMap<FString, UsageIndex::FBlueprintEntry> UsageIndex::Blueprints;
+TMap<FName, TSet<FString>> UsageIndex::Postings;
+TArray<FString> UsageIndex::PriorityQueue;
+TArray<FString> UsageIndex::Backlog;
+TSet<FString> UsageIndex::Queued;
+TArray<FString> UsageIndex::Loading;
+int32 UsageIndex::IndexedSinceSave = 0;
+double UsageIndex::LastSaveSeconds = 0.0;
+bool UsageIndex::bDirty = false;
+bool UsageIndex::bSeeded = false;
+FTSTicker::FDelegateHandle UsageIndex::TickerHandle;
+FDelegateHandle UsageIndex::ChangeHandle;
+FDelegateHandle UsageIndex::PackageSavedHandle;
+FDelegateHandle UsageIndex::FilesLoadedHandle;
+FDelegateHandle UsageIndex::AssetAddedHandle;
+FDelegateHandle UsageIndex::AssetRemovedHandle;
+FDelegateHandle UsageIndex::AssetRenamedHandle;
+
+void UsageIndex::Initialize()
+{
+	Load();
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&UsageIndex::Tick));
+	ChangeHandle = ChangeEvents::OnChange().AddStatic(&UsageIndex::HandleChange);
+	PackageSavedHandle = UPackage::PackageSavedWithContextEvent.AddStatic(&UsageIndex::HandlePackageSaved);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddStatic(&UsageIndex::HandleAssetAdded);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddStatic(&UsageIndex::HandleAssetRemoved);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddStatic(&UsageIndex::HandleAssetRenamed);
+	// Not seeded from StartupModule when the scan is already done, the first search does it
+	if (AssetRegistry.IsLoadingAssets())
+		FilesLoadedHandle = AssetRegistry.OnFilesLoaded().AddStatic(&UsageIndex::Seed);
+}
+
+void UsageIndex::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	ChangeEvents::OnChange().Remove(ChangeHandle);
+	UPackage::PackageSavedWithContextEvent.Remove(PackageSavedHandle);
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(TEXT("AssetRegistry")))
+	{
+		AssetRegistryModule->Get().OnFilesLoaded().Remove(FilesLoadedHandle);
+		AssetRegistryModule->Get().OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistryModule->Get().OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistryModule->Get().OnAssetRenamed().Remove(AssetRenamedHandle);
+	}
+
+	if (bDirty)
+		Save();
+	Blueprints.Empty();
+	Postings.Empty();
+	PriorityQueue.Empty();
+	Backlog.Empty();
+	Queued.Empty();
+	Loading.Empty();
+	bSeeded = false;
+}
+
+const TCHAR* UsageIndex::GetKindName(EUsageKind Kind)
+{
+	switch (Kind)
+	{
+	case EUsageKind::Function:
+		return TEXT("Function");
+	case EUsageKind::Variable:
+		return TEXT("Variable");
+	case EUsageKind::Event:
+		return TEXT("Event");
+	default:
+		return TEXT("Node");
+	}
+}
+
+void UsageIndex::Seed()
+{
+	MCP_TRACE_SCOPE("UsageIndex::Seed");
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.PackagePaths.Add(TEXT("/Game"));
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	// Blueprints deleted while the editor was closed
+	TSet<FString> Existing;
+	for (const FAssetData& Asset : Assets)
+	{
+		Existing.Add(Asset.PackageName.ToString());
+	}
+	TArray<FString> Stale;
+	for (const TPair<FString, FBlueprintEntry>& Pair : Blueprints)
+	{
+		if (!Existing.Contains(Pair.Key))
+			Stale.Add(Pair.Key);
+	}
+	for (const FString& PackagePath : Stale)
+	{
+		Remove(PackagePath);
+	}
+
+	for (const FString& PackagePath : Existing)
+	{
+		Enqueue(PackagePath, false);
+	}
+	bSeeded = true;
+}
+
+void UsageIndex::Enqueue(const FString& PackagePath, bool bPriority)
+{
+	if (bPriority)
+	{
+		// Move it ahead of the backlog
+		if (Queued.Contains(PackagePath))
+			Backlog.RemoveSingleSwap(PackagePath);
+		PriorityQueue.AddUnique(PackagePath);
+		Queued.Add(PackagePath);
+		return;
+	}
+	if (!Queued.Contains(PackagePath))
+	{
+		Backlog.Add(PackagePath);
+		Queued.Add(PackagePath);
+	}
+}
+
+void UsageIndex::Remove(const FString& PackagePath)
+{
+	FBlueprintEntry Entry;
+	if (!Blueprints.RemoveAndCopyValue(PackagePath, Entry))
+		return;
+	for (const FUsage& Usage : Entry.Usages)
+	{
+		if (TSet<FString>* Paths = Postings.Find(Usage.Name))
+		{
+			Paths->Remove(PackagePath);
+			if (Paths->IsEmpty())
+				Postings.Remove(Usage.Name);
+		}
+	}
+	bDirty = true;
+}
+
+void UsageIndex::Store(const FString& PackagePath, FBlueprintEntry&& Entry)
+{
+	Remove(PackagePath);
+	for (const FUsage& Usage : Entry.Usages)
+	{
+		Postings.FindOrAdd(Usage.Name).Add(PackagePath);
+	}
+	Blueprints.Add(PackagePath, MoveTemp(Entry));
+	bDirty = true;
+}
+
+int64 UsageIndex::GetPackageRevision(const FString& PackagePath)
+{
+	FString Filename;
+	if (!FPackageName::TryConvertLongPackageNameToFilename(PackagePath, Filename, FPackageName::GetAssetPackageExtension()))
+		return 0;
+	const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*Filename);
+	return TimeStamp == FDateTime::MinValue() ? 0 : TimeStamp.GetTicks();
+}
+
+void UsageIndex::IndexBlueprint(UBlueprint* Blueprint)
+{
+	MCP_TRACE_SCOPE("UsageIndex::IndexBlueprint");
+	if (!Blueprint)
+		throw std::runtime_error("Blueprint is null");
+
+	const FString PackagePath = Blueprint->GetPackage()->GetName();
+	FBlueprintEntry Entry;
+	// Unsaved edits are indexed now, but the package is indexed again next session
+	Entry.Revision = Blueprint->GetPackage()->IsDirty() ? 0 : GetPackageRevision(PackagePath);
+
+	TArray<UEdGraph*> Graphs;
+	Blueprint->GetAllGraphs(Graphs);
+	for (const UEdGraph* Graph : Graphs)
+	{
+		const FString GraphName = Graph->GetName();
+		for (const UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (!Node)
+				continue;
+
+			auto Add = [&](EUsageKind Kind, FName Name)
+			{
+				if (!Name.IsNone())
+					Entry.Usages.Add({ Kind, Name, GraphName, Node->NodeGuid });
+			};
+			Add(EUsageKind::Node, Node->GetClass()->GetFName());
+			if (const UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node))
+				Add(EUsageKind::Function, CallNode->FunctionReference.GetMemberName());
+			else if (const UK2Node_Variable* VariableNode = Cast<UK2Node_Variable>(Node))
+				Add(EUsageKind::Variable, VariableNode->GetVarName());
+			else if (const UK2Node_Event* EventNode = Cast<UK2Node_Event>(Node))
+				Add(EUsageKind::Event, EventNode->GetFunctionName());
+		}
+	}
+	Store(PackagePath, MoveTemp(Entry));
+	++IndexedSinceSave;
+}
+
+bool UsageIndex::Tick(float DeltaTime)
+{
+	const double BudgetSeconds = CVarUsageIndexFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+	if (BudgetSeconds <= 0.0 || IsGarbageCollecting() || GIsSavingPackage)
+		return true;
+
+	MCP_TRACE_SCOPE("UsageIndex::Tick");
+	const double StartSeconds = FPlatformTime::Seconds();
+	bool bWorked = false;
+
+	// Loads started on earlier frames, polled without waiting on them
+	for (int32 Index = Loading.Num() - 1; Index >= 0 && (!bWorked || FPlatformTime::Seconds() - StartSeconds < BudgetSeconds); --Index)
+	{
+		const FString PackagePath = Loading[Index];
+		const FString Status = AssetLoadUtils::Prefetch({ PackagePath })[0].Status;
+		if (Status == TEXT("Loading"))
+			continue;
+		Loading.RemoveAtSwap(Index);
+		UBlueprint* Blueprint = Status == TEXT("Loaded")
+			? Cast<UBlueprint>(AssetLoadUtils::FindLoadedObject(UBlueprint::StaticClass(), PackagePath)) : nullptr;
+		if (!Blueprint)
+		{
+			Remove(PackagePath);
+			continue;
+		}
+		bWorked = true;
+		IndexBlueprint(Blueprint);
+	}
+
+	// Blueprints already in memory are indexed now, the others join the next async load slice
+	TArray<FString> ToLoad;
+	while ((PriorityQueue.Num() > 0 || Backlog.Num() > 0) && Loading.Num() + ToLoad.Num() < LoadSlice
+		&& (!bWorked || FPlatformTime::Seconds() - StartSeconds < BudgetSeconds))
+	{
+		const bool bPriority = PriorityQueue.Num() > 0;
+		const FString PackagePath = bPriority ? PriorityQueue.Pop() : Backlog.Pop();
+		Queued.Remove(PackagePath);
+
+		// Unchanged since the last session, nothing to load. Edits queue with priority and are always indexed
+		const FBlueprintEntry* Entry = Blueprints.Find(PackagePath);
+		if (!bPriority && Entry && Entry->Revision != 0 && Entry->Revision == GetPackageRevision(PackagePath))
+			continue;
+
+		if (UBlueprint* Blueprint = Cast<UBlueprint>(AssetLoadUtils::FindLoadedObject(UBlueprint::StaticClass(), PackagePath)))
+		{
+			bWorked = true;
+			IndexBlueprint(Blueprint);
+			continue;
+		}
+		if (!Loading.Contains(PackagePath) && !ToLoad.Contains(PackagePath))
+			ToLoad.Add(PackagePath);
+	}
+	if (ToLoad.Num() > 0)
+	{
+		AssetLoadUtils::Prefetch(ToLoad);
+		Loading.Append(ToLoad);
+	}
+
+	if (bDirty && (IndexedSinceSave >= SaveInterval || (PriorityQueue.IsEmpty() && Backlog.IsEmpty() && Loading.IsEmpty()
+		&& FPlatformTime::Seconds() - LastSaveSeconds >= SaveIntervalSeconds)))
+		Save();
+	return true;
+}
+
+FString UsageIndex::GetIndexFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("UE5_MCP") / TEXT("UsageIndex.bin");
+}
+
+void UsageIndex::Load()
+{
+	MCP_TRACE_SCOPE("UsageIndex::Load");
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetIndexFilename(), FILEREAD_Silent))
+		return;
+
+	FMemoryReader Archive(Data);
+	int32 Version = 0;
+	int32 BlueprintCount = 0;
+	Archive << Version;
+	if (Version != FormatVersion)
+		return;
+	Archive << BlueprintCount;
+	for (int32 BlueprintIndex = 0; BlueprintIndex < BlueprintCount && !Archive.IsError(); ++BlueprintIndex)
+	{
+		FString PackagePath;
+		FBlueprintEntry Entry;
+		int32 UsageCount = 0;
+		Archive << PackagePath << Entry.Revision << UsageCount;
+		if (UsageCount < 0)
+			break;
+		Entry.Usages.Reserve(UsageCount);
+		for (int32 Index = 0; Index < UsageCount && !Archive.IsError(); ++Index)
+		{
+			FUsage& Usage = Entry.Usages.AddDefaulted_GetRef();
+			uint8 Kind = 0;
+			FString Name;
+			Archive << Kind << Name << Usage.Graph << Usage.NodeId;
+			Usage.Kind = static_cast<EUsageKind>(Kind);
+			Usage.Name = FName(*Name);
+		}
+		if (!Archive.IsError())
+			Store(PackagePath, MoveTemp(Entry));
+	}
+	bDirty = false;
+	UE_LOG(LogTemp, Log, TEXT("UE5_MCP: loaded the usage index of %d Blueprints"), Blueprints.Num());
+}
+
+void UsageIndex::Save()
+{
+	MCP_TRACE_SCOPE("UsageIndex::Save");
+	TArray<uint8> Data;
+	FMemoryWriter Archive(Data);
+	int32 Version = FormatVersion;
+	int32 BlueprintCount = Blueprints.Num();
+	Archive << Version << BlueprintCount;
+	for (TPair<FString, FBlueprintEntry>& Pair : Blueprints)
+	{
+		int32 UsageCount = Pair.Value.Usages.Num();
+		Archive << Pair.Key << Pair.Value.Revision << UsageCount;
+		for (FUsage& Usage : Pair.Value.Usages)
+		{
+			uint8 Kind = static_cast<uint8>(Usage.Kind);
+			FString Name = Usage.Name.ToString();
+			Archive << Kind << Name << Usage.Graph << Usage.NodeId;
+		}
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Data, *GetIndexFilename()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UE5_MCP: failed to write the usage index to %s"), *GetIndexFilename());
+		return;
+	}
+	bDirty = false;
+	IndexedSinceSave = 0;
+	LastSaveSeconds = FPlatformTime::Seconds();
+}
+
+FUsageQueryResult UsageIndex::Search(const FString& Name, const FString& Kind, const FString& PathPrefix, int32 Limit)
+{
+	MCP_TRACE_SCOPE("UsageIndex::Search");
+	if (Name.IsEmpty())
+		throw std::runtime_error("Name is empty");
+	// While the registry is still scanning, OnFilesLoaded seeds instead
+	if (!bSeeded && !FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get().IsLoadingAssets())
+		Seed();
+
+	TOptional<EUsageKind> KindFilter;
+	for (EUsageKind Candidate : { EUsageKind::Function, EUsageKind::Variable, EUsageKind::Event, EUsageKind::Node })
+	{
+		if (Kind.Equals(GetKindName(Candidate), ESearchCase::IgnoreCase))
+			KindFilter = Candidate;
+	}
+	if (!Kind.IsEmpty() && !KindFilter)
+		throw std::runtime_error("Kind must be Function, Variable, Event or Node");
+
+	const FName ExactName(*Name);
+	// Node classes may be named without their prefix, e.g. DynamicCast
+	const FName NodeClassName = Name.StartsWith(TEXT("K2Node_")) ? ExactName : FName(*(TEXT("K2Node_") + Name));
+
+	TSet<FString> Paths;
+	for (const FName& Candidate : { ExactName, NodeClassName })
+	{
+		if (const TSet<FString>* Found = Postings.Find(Candidate))
+			Paths.Append(*Found);
+	}
+	TArray<FString> SortedPaths = Paths.Array();
+	SortedPaths.Sort();
+
+	FUsageQueryResult Result;
+	Result.Indexed = Blueprints.Num();
+	Result.Pending = Queued.Num() + Loading.Num();
+	for (const FString& PackagePath : SortedPaths)
+	{
+		if (!PathPrefix.IsEmpty() && !PackagePath.StartsWith(PathPrefix))
+			continue;
+		for (const FUsage& Usage : Blueprints[PackagePath].Usages)
+		{
+			if (KindFilter && Usage.Kind != *KindFilter)
+				continue;
+			if (Usage.Name != ExactName && (Usage.Kind != EUsageKind::Node || Usage.Name != NodeClassName))
+				continue;
+
+			++Result.Total;
+			if (Limit > 0 && Result.Usages.Num() >= Limit)
+				continue;
+			Result.Usages.Add({ PackagePath, Usage.Graph, Usage.NodeId.ToString(), Usage.Kind, Usage.Name.ToString() });
+		}
+	}
+	return Result;
+}
+
+TArray<uint8> UsageIndex::EncodeResult(const FUsageQueryResult& Result)
+{
+	MCP_TRACE_SCOPE("UsageIndex::EncodeResult");
+	Metrics::FScopedPhase Phase(EMetricPhase::Serialize);
+	TArray<uint8> Output = JsonBuffer::Acquire();
+	FMemoryWriter Archive(Output);
+	TSharedRef<FUtf8JsonWriter> Writer = FUtf8JsonWriterFactory::Create(&Archive);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Total"), Result.Total);
+	Writer->WriteValue(TEXT("Indexed"), Result.Indexed);
+	Writer->WriteValue(TEXT("Pending"), Result.Pending);
+	Writer->WriteValue(TEXT("Complete"), bSeeded && Result.Pending == 0);
+	Writer->WriteArrayStart(TEXT("Usages"));
+	for (const FUsageMatch& Usage : Result.Usages)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Blueprint"), Usage.BlueprintPath);
+		Writer->WriteValue(TEXT("Graph"), Usage.Graph);
+		Writer->WriteValue(TEXT("NodeId"), Usage.NodeId);
+		Writer->WriteValue(TEXT("Kind"), GetKindName(Usage.Kind));
+		Writer->WriteValue(TEXT("Name"), Usage.Name);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Output;
+}
+
+void UsageIndex::HandleChange(const FChangeEvent& Event)
+{
+	if (Event.Type == EChangeEventType::GraphChanged || Event.Type == EChangeEventType::BlueprintCompiled)
+		Enqueue(Event.BlueprintPath, true);
+}
+
+void UsageIndex::HandlePackageSaved(const FString& Filename, UPackage* Package, FObjectPostSaveContext Context)
+{
+	// The saved package has a new timestamp, index it again so its revision matches the file
+	if (Package && Blueprints.Contains(Package->GetName()))
+		Enqueue(Package->GetName(), true);
+}
+
+void UsageIndex::HandleAssetAdded(const FAssetData& AssetData)
+{
+	// Assets found by the startup scan are queued by Seed
+	if (!bSeeded || !AssetData.IsInstanceOf(UBlueprint::StaticClass()))
+		return;
+	Enqueue(AssetData.PackageName.ToString(), false);
+}
+
+void UsageIndex::HandleAssetRemoved(const FAssetData& AssetData)
+{
+	Remove(AssetData.PackageName.ToString());
+}
+
+void UsageIndex::HandleAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	Remove(FPackageName::ObjectPathToPackageName(OldObjectPath));
+	if (AssetData.IsInstanceOf(UBlueprint::StaticClass()))
+		Enqueue(AssetData.PackageName.ToString(), true);
+}
@@ -0,0 +1,122 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include <stdexcept>
+
+class UBlueprint;
+class UPackage;
+class FObjectPostSaveContext;
+struct FAssetData;
+struct FChangeEvent;
+
+enum class EUsageKind : uint8
+{
+	Function, // function call
+	Variable, // variable get or set
+	Event, // event or custom event
+	Node // node class, e.g. K2Node_DynamicCast
+};
+
+struct FUsageMatch
+{
+	FString BlueprintPath;
+	FString Graph;
+	FString NodeId;
+	EUsageKind Kind = EUsageKind::Node;
+	FString Name;
+};
+
+struct FUsageQueryResult
+{
+	TArray<FUsageMatch> Usages;
+	int32 Total = 0; // matches before the limit
+	int32 Indexed = 0; // Blueprints in the index
+	int32 Pending = 0; // Blueprints still waiting to be indexed
+};
+
+// Inverted index from function, variable, event and node class names to the nodes using them, over every
+// Blueprint of the project. Once the asset registry has finished its scan, or at the first search, a ticker
+// walks the Blueprints a few milliseconds per frame. Blueprints not in memory are loaded asynchronously a slice
+// at a time and indexed when their load completes, so the game thread never waits on the disk. Edits made through
+// the API or saved in the editor are indexed again, and the index is kept in Saved/UE5_MCP so a new session
+// only indexes the Blueprints whose package changed
+class UsageIndex
+{
+public:
+	static void Initialize();
+	static void Shutdown();
+
+	// Kind is Function, Variable, Event or Node, empty for all. Names compare case-insensitively
+	// The first search seeds the index if the asset registry scan was already done at startup
+	// Node names may leave out the K2Node_ prefix. Results are ordered by Blueprint path
+	static FUsageQueryResult Search(const FString& Name, const FString& Kind, const FString& PathPrefix, int32 Limit);
+
+	static TArray<uint8> EncodeResult(const FUsageQueryResult& Result);
+
+	static const TCHAR* GetKindName(EUsageKind Kind);
+
+	// Replaces the Blueprint's entries with the usages of its current, loaded state
+	static void IndexBlueprint(UBlueprint* Blueprint);
+
+private:
+	struct FUsage
+	{
+		EUsageKind Kind = EUsageKind::Node;
+		FName Name;
+		FString Graph;
+		FGuid NodeId;
+	};
+
+	struct FBlueprintEntry
+	{
+		int64 Revision = 0; // package file timestamp when indexed, 0 when it had unsaved changes
+		TArray<FUsage> Usages;
+	};
+
+	static bool Tick(float DeltaTime);
+
+	// Queues every Blueprint asset once the asset registry has finished its scan
+	static void Seed();
+	static void Enqueue(const FString& PackagePath, bool bPriority);
+	static void Remove(const FString& PackagePath);
+	static void Store(const FString& PackagePath, FBlueprintEntry&& Entry);
+
+	static int64 GetPackageRevision(const FString& PackagePath);
+
+	static FString GetIndexFilename();
+	static void Load();
+	static void Save();
+
+	static void HandleChange(const FChangeEvent& Event);
+	static void HandlePackageSaved(const FString& Filename, UPackage* Package, FObjectPostSaveContext Context);
+	static void HandleAssetAdded(const FAssetData& AssetData);
+	static void HandleAssetRemoved(const FAssetData& AssetData);
+	static void HandleAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+
+	static constexpr int32 FormatVersion = 1;
+	// Save after this many Blueprints were indexed, so a crash loses little work
+	static constexpr int32 SaveInterval = 200;
+	// Otherwise save at most this often once the queues are drained, Shutdown saves the rest
+	static constexpr double SaveIntervalSeconds = 60.0;
+	// Async loads in flight at once
+	static constexpr int32 LoadSlice = 16;
+
+	static TMap<FString, FBlueprintEntry> Blueprints;
+	static TMap<FName, TSet<FString>> Postings; // name to the Blueprints using it, FName compares case-insensitively
+	static TArray<FString> PriorityQueue; // changed through the API or saved, indexed first
+	static TArray<FString> Backlog;
+	static TSet<FString> Queued;
+	static TArray<FString> Loading; // taken off the queues, indexed once their async load completes
+	static int32 IndexedSinceSave;
+	static double LastSaveSeconds;
+	static bool bDirty;
+	static bool bSeeded;
+
+	static FTSTicker::FDelegateHandle TickerHandle;
+	static FDelegateHandle ChangeHandle;
+	static FDelegateHandle PackageSavedHandle;
+	static FDelegateHandle FilesLoadedHandle;
+	static FDelegateHandle AssetAddedHandle;
+	static FDelegateHandle AssetRemovedHandle;
+	static FDelegateHandle AssetRenamedHandle;
+};
@@ -9,7 +9,14 @@
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Text/STextBlock.h"
 #include "ToolMenus.h"
+#include "UE5_MCP/API/RequestScheduler.h"
 #include "UE5_MCP/API/Route.h"
+#include "UE5_MCP/API/WebSocketChannel.h"
+#include "UE5_MCP/Core/ActionIndex.h"
+#include "UE5_MCP/Core/ChangeEvents.h"
+#include "UE5_MCP/Core/NodeCatalog.h"
+#include "UE5_MCP/Core/SnapshotCache.h"
+#include "UE5_MCP/Core/UsageIndex.h"
 #include "Widgets/Input/SSpinBox.h"
 
 class IHttpRouter;
@@ -25,6 +32,12 @@ void FUE5_MCPModule::StartupModule()
 	FUE5_MCPStyle::ReloadTextures();
 
 	FUE5_MCPCommands::Register();
+	ChangeEvents::Initialize();
+	SnapshotCache::Initialize();
+	UsageIndex::Initialize();
+	NodeCatalog::Initialize();
+	ActionIndex::Initialize();
+	RequestScheduler::Initialize();
 	
 	PluginCommands = MakeShareable(new FUICommandList);
 
@@ -45,6 +58,14 @@ void FUE5_MCPModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	WebSocketChannel::Stop();
+	RequestScheduler::Shutdown();
+	ActionIndex::Shutdown();
+	NodeCatalog::Shutdown();
+	UsageIndex::Shutdown();
+	SnapshotCache::Shutdown();
+	ChangeEvents::Shutdown();
+
 	UToolMenus::UnRegisterStartupCallback(this);
 
 	UToolMenus::UnregisterOwner(this);
@@ -59,6 +80,7 @@ void FUE5_MCPModule::ShutdownModule()
 TSharedRef<SDockTab> FUE5_MCPModule::OnSpawnPluginTab(const FSpawnTabArgs& SpawnTabArgs)
 {
 	TSharedPtr<SSpinBox<int32>> PortSpinBox;
+	TSharedPtr<SSpinBox<int32>> WebSocketPortSpinBox;
 	
 	return SNew(SDockTab)
 		.TabRole(ETabRole::NomadTab)
@@ -85,6 +107,22 @@ TSharedRef<SDockTab> FUE5_MCPModule::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 					.MaxValue(65535)
 					.Value(8080)          // default value
 				]
+
+				+ SVerticalBox::Slot()
+				.Padding(5)
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString("WebSocket Port:"))
+				]
+
+				+ SVerticalBox::Slot()
+				.Padding(5)
+				[
+					SAssignNew(WebSocketPortSpinBox, SSpinBox<int32>)
+					.MinValue(1)
+					.MaxValue(65535)
+					.Value(8081)
+				]
 	
 				// Button
 				+ SVerticalBox::Slot()
@@ -92,7 +130,7 @@ TSharedRef<SDockTab> FUE5_MCPModule::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 				[
 					SNew(SButton)
 					.Text(FText::FromString("Run Server"))
-					.OnClicked_Lambda([PortSpinBox]() -> FReply
+					.OnClicked_Lambda([PortSpinBox, WebSocketPortSpinBox]() -> FReply
 					{
 						if (PortSpinBox.IsValid())
 						{
@@ -109,6 +147,10 @@ TSharedRef<SDockTab> FUE5_MCPModule::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 								FHttpServerModule::Get().StartAllListeners();
 							}
 						}
+						if (WebSocketPortSpinBox.IsValid())
+						{
+							WebSocketChannel::Start(WebSocketPortSpinBox->GetValue());
+						}
 						return FReply::Handled();
 					})
 				]
@@ -121,6 +163,7 @@ TSharedRef<SDockTab> FUE5_MCPModule::OnSpawnPluginTab(const FSpawnTabArgs& Spawn
 					.OnClicked_Lambda([PortSpinBox]() -> FReply
 					{
 						FHttpServerModule::Get().StopAllListeners();
+						WebSocketChannel::Stop();
 						return FReply::Handled();
 					})
 				]
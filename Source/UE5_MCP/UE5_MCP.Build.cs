@@ -58,6 +58,7 @@ public class UE5_MCP : ModuleRules
 				"Kismet",       
 				"KismetCompiler",
 				"HttpServer",
+				"WebSocketNetworking",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
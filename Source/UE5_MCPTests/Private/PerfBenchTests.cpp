@@ -0,0 +1,55 @@
+﻿#include "Misc/AutomationTest.h"
+#include "UE5_MCP/Core/PerfBench.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// One benchmark size per test, so a size can be run or filtered on its own
+	bool RunPerfBench(FAutomationTestBase& Test, int32 NodeCount)
+	{
+		for (const PerfBench::FResult& Result : PerfBench::Run({ NodeCount }))
+		{
+			if (!Result.Error.IsEmpty())
+				Test.AddError(FString::Printf(TEXT("%s at %d nodes: %s"), *Result.Case, Result.Size, *Result.Error));
+			else
+				Test.AddInfo(FString::Printf(TEXT("%s at %d nodes: mean %.3f ms, median %.3f ms over %d runs"),
+					*Result.Case, Result.Size, Result.MeanMs, Result.MedianMs, Result.Iterations));
+		}
+		return !Test.HasAnyErrors();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPerfBenchNodes10Test, "UE5_MCP.Perf.Nodes10",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPerfBenchNodes10Test::RunTest(const FString& Parameters)
+{
+	return RunPerfBench(*this, 10);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPerfBenchNodes100Test, "UE5_MCP.Perf.Nodes100",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPerfBenchNodes100Test::RunTest(const FString& Parameters)
+{
+	return RunPerfBench(*this, 100);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPerfBenchNodes1000Test, "UE5_MCP.Perf.Nodes1000",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPerfBenchNodes1000Test::RunTest(const FString& Parameters)
+{
+	return RunPerfBench(*this, 1000);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPerfBenchNodes10000Test, "UE5_MCP.Perf.Nodes10000",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPerfBenchNodes10000Test::RunTest(const FString& Parameters)
+{
+	return RunPerfBench(*this, 10000);
+}
+
+#endif
@@ -0,0 +1,4 @@
+﻿#include "Modules/ModuleManager.h"
+
+// Automation tests only, run them with "Automation RunTests UE5_MCP"
+IMPLEMENT_MODULE(FDefaultModuleImpl, UE5_MCPTests)
@@ -0,0 +1,23 @@
+﻿using System.IO;
+using UnrealBuildTool;
+
+public class UE5_MCPTests : ModuleRules
+{
+	public UE5_MCPTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// UE5_MCP headers are included from the plugin's Source directory, e.g. "UE5_MCP/Core/PerfBench.h"
+		PrivateIncludePaths.Add(Path.Combine(PluginDirectory, "Source"));
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"UE5_MCP"
+			}
+			);
+	}
+}